@@ -202,6 +202,8 @@ CP_C_API cp_context_t * cp_create_context(cp_status_t *error) {
 			(int (*)(const void *, const void *)) strcmp, NULL);
 		env->run_funcs = list_create(LISTCOUNT_T_MAX);
 		env->run_wait = NULL;
+		env->descriptor_loader = NULL;
+		env->descriptor_loader_data = NULL;
 		if (env->plugin_listeners == NULL
 			|| env->loggers == NULL
 #ifdef CP_THREADS
@@ -403,6 +405,15 @@ CP_C_API void cp_unregister_pcollections(cp_context_t *context) {
 	cpi_unlock_context(context);
 }
 
+CP_C_API void cp_set_descriptor_loader(cp_context_t *context, cp_descriptor_loader_func_t loader, void *user_data) {
+	CHECK_NOT_NULL(context);
+	cpi_lock_context(context);
+	cpi_check_invocation(context, CPI_CF_ANY, __func__);
+	context->env->descriptor_loader = loader;
+	context->env->descriptor_loader_data = user_data;
+	cpi_unlock_context(context);
+}
+
 
 // Startup arguments
 
@@ -384,6 +384,22 @@ typedef void (*cp_fatal_error_func_t)(const char *msg);
  */
 typedef int (*cp_run_func_t)(void *plugin_data);
 
+/**
+ * A plug-in descriptor loader called by ::cp_scan_plugins for each possible
+ * plug-in location instead of ::cp_load_plugin_descriptor, e.g. to load the
+ * descriptors of unchanged plug-ins from a cache. The loader may call
+ * ::cp_load_plugin_descriptor and ::cp_load_plugin_descriptor_from_serialized
+ * with the given context. Descriptor loaders are set using
+ * ::cp_set_descriptor_loader.
+ *
+ * @param ctx the plug-in context
+ * @param path the installation path of the plug-in
+ * @param status a pointer to the location where status code is to be stored
+ * @param user_data the user data pointer given when the loader was set
+ * @return pointer to the information structure or NULL if error occurs
+ */
+typedef cp_plugin_info_t *(*cp_descriptor_loader_func_t)(cp_context_t *ctx, const char *path, cp_status_t *status, void *user_data);
+
 /*@}*/
 
 
@@ -993,6 +1009,17 @@ CP_C_API void cp_unregister_pcollection(cp_context_t *ctx, const char *dir) CP_G
  */
 CP_C_API void cp_unregister_pcollections(cp_context_t *ctx) CP_GCC_NONNULL(1);
 
+/**
+ * Sets the function used by ::cp_scan_plugins to load the plug-in
+ * descriptors of the plug-in collections. Setting NULL restores the
+ * default of calling ::cp_load_plugin_descriptor.
+ *
+ * @param ctx the plug-in context
+ * @param loader the descriptor loader or NULL
+ * @param user_data user data pointer supplied to the loader
+ */
+CP_C_API void cp_set_descriptor_loader(cp_context_t *ctx, cp_descriptor_loader_func_t loader, void *user_data) CP_GCC_NONNULL(1);
+
 /*@}*/
 
 
@@ -1098,6 +1125,37 @@ CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor(cp_context_t *ctx, const c
  */
 CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor_from_memory(cp_context_t *context, const char *buffer, unsigned int buffer_len, cp_status_t *error) CP_GCC_NONNULL(1, 2);
 
+/**
+ * Serializes plug-in information into a compact binary form which can be
+ * loaded using ::cp_load_plugin_descriptor_from_serialized without parsing
+ * the plug-in descriptor again. The plug-in path is not included. The
+ * serialized form is only meant to be loaded by the same version of the
+ * library. Nothing is written if the buffer is too small.
+ *
+ * @param plugin the plug-in information
+ * @param buffer the buffer to write to, or NULL to query the required length
+ * @param buffer_len the length of the buffer
+ * @return the length of the serialized plug-in information
+ */
+CP_C_API unsigned int cp_serialize_plugin_descriptor(const cp_plugin_info_t *plugin, char *buffer, unsigned int buffer_len) CP_GCC_NONNULL(1);
+
+/**
+ * Loads plug-in information serialized using ::cp_serialize_plugin_descriptor.
+ * The plug-in is not installed to the context. If the operation fails or the
+ * serialized information is invalid then NULL is returned. The caller must
+ * release the returned information by calling ::cp_release_plugin_info when
+ * it does not need the information anymore.
+ * The returned plug-in information must not be modified.
+ *
+ * @param ctx the plug-in context
+ * @param path the installation path of the plug-in
+ * @param buffer the buffer containing the serialized plug-in information
+ * @param buffer_len the length of the buffer
+ * @param status a pointer to the location where status code is to be stored, or NULL
+ * @return pointer to the information structure or NULL if error occurs
+ */
+CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor_from_serialized(cp_context_t *ctx, const char *path, const char *buffer, unsigned int buffer_len, cp_status_t *status) CP_GCC_NONNULL(1, 2, 3);
+
 /**
  * Installs the plug-in described by the specified plug-in information
  * structure to the specified plug-in context. The plug-in information
@@ -207,6 +207,12 @@ struct cp_plugin_env_t {
 	// Whether currently in destroy function invocation
 	int in_destroy_func_invocation;
 	
+	/// Plug-in descriptor loader used when scanning, or NULL for the default
+	cp_descriptor_loader_func_t descriptor_loader;
+	
+	/// User data of the plug-in descriptor loader
+	void *descriptor_loader_data;
+	
 };
 
 // Plug-in instance
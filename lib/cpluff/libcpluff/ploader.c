@@ -1363,3 +1363,378 @@ CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor_from_memory(cp_context_t *
 
 	return plugin;
 }
+
+
+/* ------------------------------------------------------------------------
+ * Serialized plug-in descriptors
+ * ----------------------------------------------------------------------*/
+
+/// Identifies the format of serialized plug-in information
+#define CP_SERIALIZED_MAGIC 0x31535043
+
+/// Serialization state
+typedef struct serializer_t {
+
+	/// The buffer being written, or NULL if only measuring
+	char *buffer;
+	
+	/// Size of the buffer
+	unsigned int buffer_len;
+	
+	/// Current length of the serialized data
+	unsigned int pos;
+	
+} serializer_t;
+
+/// Deserialization state
+typedef struct deserializer_t {
+
+	/// The buffer being read
+	const char *buffer;
+	
+	/// Size of the buffer
+	unsigned int buffer_len;
+	
+	/// Current read position
+	unsigned int pos;
+	
+	/// Status of the deserialization
+	cp_status_t status;
+	
+} deserializer_t;
+
+static void serialize_data(serializer_t *s, const void *data, unsigned int len) {
+	if (s->buffer != NULL && s->pos + len <= s->buffer_len) {
+		memcpy(s->buffer + s->pos, data, len);
+	}
+	s->pos += len;
+}
+
+static void serialize_uint(serializer_t *s, unsigned int value) {
+	serialize_data(s, &value, sizeof(value));
+}
+
+static void serialize_str(serializer_t *s, const char *str) {
+	unsigned int len;
+
+	// the length includes the terminator so NULL can be told apart from ""
+	len = (str != NULL ? strlen(str) + 1 : 0);
+	serialize_uint(s, len);
+	if (len > 1) {
+		serialize_data(s, str, len - 1);
+	}
+}
+
+static void serialize_cfg_element(serializer_t *s, const cp_cfg_element_t *ce) {
+	unsigned int i;
+
+	serialize_str(s, ce->name);
+	serialize_uint(s, ce->num_atts);
+	for (i = 0; i < ce->num_atts * 2; i++) {
+		serialize_str(s, ce->atts[i]);
+	}
+	serialize_str(s, ce->value);
+	serialize_uint(s, ce->num_children);
+	for (i = 0; i < ce->num_children; i++) {
+		serialize_cfg_element(s, ce->children + i);
+	}
+}
+
+static void serialize_plugin(serializer_t *s, const cp_plugin_info_t *plugin) {
+	unsigned int i;
+
+	serialize_uint(s, CP_SERIALIZED_MAGIC);
+	serialize_str(s, plugin->identifier);
+	serialize_str(s, plugin->name);
+	serialize_str(s, plugin->version);
+	serialize_str(s, plugin->provider_name);
+	serialize_str(s, plugin->abi_bw_compatibility);
+	serialize_str(s, plugin->api_bw_compatibility);
+	serialize_str(s, plugin->req_cpluff_version);
+	serialize_uint(s, plugin->num_imports);
+	for (i = 0; i < plugin->num_imports; i++) {
+		serialize_str(s, plugin->imports[i].plugin_id);
+		serialize_str(s, plugin->imports[i].version);
+		serialize_uint(s, plugin->imports[i].optional);
+	}
+	serialize_str(s, plugin->runtime_lib_name);
+	serialize_str(s, plugin->runtime_funcs_symbol);
+	serialize_uint(s, plugin->num_ext_points);
+	for (i = 0; i < plugin->num_ext_points; i++) {
+		serialize_str(s, plugin->ext_points[i].local_id);
+		serialize_str(s, plugin->ext_points[i].identifier);
+		serialize_str(s, plugin->ext_points[i].name);
+		serialize_str(s, plugin->ext_points[i].schema_path);
+	}
+	serialize_uint(s, plugin->num_extensions);
+	for (i = 0; i < plugin->num_extensions; i++) {
+		serialize_str(s, plugin->extensions[i].ext_point_id);
+		serialize_str(s, plugin->extensions[i].local_id);
+		serialize_str(s, plugin->extensions[i].identifier);
+		serialize_str(s, plugin->extensions[i].name);
+		serialize_uint(s, plugin->extensions[i].configuration != NULL);
+		if (plugin->extensions[i].configuration != NULL) {
+			serialize_cfg_element(s, plugin->extensions[i].configuration);
+		}
+	}
+}
+
+CP_C_API unsigned int cp_serialize_plugin_descriptor(const cp_plugin_info_t *plugin, char *buffer, unsigned int buffer_len) {
+	serializer_t s;
+
+	CHECK_NOT_NULL(plugin);
+
+	// Measure first, so nothing is written to a buffer that is too small
+	s.buffer = NULL;
+	s.buffer_len = 0;
+	s.pos = 0;
+	serialize_plugin(&s, plugin);
+
+	if (buffer != NULL && s.pos <= buffer_len) {
+		s.buffer = buffer;
+		s.buffer_len = buffer_len;
+		s.pos = 0;
+		serialize_plugin(&s, plugin);
+	}
+
+	return s.pos;
+}
+
+static unsigned int deserialize_uint(deserializer_t *d) {
+	unsigned int value = 0;
+
+	if (d->status != CP_OK) {
+		return 0;
+	}
+	if (d->buffer_len - d->pos < sizeof(value)) {
+		d->status = CP_ERR_MALFORMED;
+		return 0;
+	}
+	memcpy(&value, d->buffer + d->pos, sizeof(value));
+	d->pos += sizeof(value);
+	return value;
+}
+
+/**
+ * Reads the number of the following items, making sure the buffer can hold
+ * them so corrupted data doesn't lead to huge allocations.
+ */
+static unsigned int deserialize_count(deserializer_t *d) {
+	unsigned int count = deserialize_uint(d);
+
+	if (count > (d->buffer_len - d->pos) / sizeof(unsigned int)) {
+		d->status = CP_ERR_MALFORMED;
+		return 0;
+	}
+	return count;
+}
+
+static char *deserialize_str(deserializer_t *d) {
+	unsigned int len;
+	char *str;
+
+	len = deserialize_uint(d);
+	if (d->status != CP_OK || len == 0) {
+		return NULL;
+	}
+	if (d->buffer_len - d->pos < len - 1) {
+		d->status = CP_ERR_MALFORMED;
+		return NULL;
+	}
+	if ((str = malloc(len * sizeof(char))) == NULL) {
+		d->status = CP_ERR_RESOURCE;
+		return NULL;
+	}
+	memcpy(str, d->buffer + d->pos, len - 1);
+	str[len - 1] = '\0';
+	d->pos += len - 1;
+	return str;
+}
+
+static void deserialize_cfg_element(deserializer_t *d, cp_cfg_element_t *ce, cp_cfg_element_t *parent, unsigned int index) {
+	unsigned int i;
+	unsigned int num_atts;
+
+	memset(ce, 0, sizeof(cp_cfg_element_t));
+	ce->parent = parent;
+	ce->index = index;
+	ce->name = deserialize_str(d);
+
+	// The attributes share a single block of memory, as set up by the parser
+	num_atts = deserialize_count(d);
+	if (num_atts > 0 && d->status == CP_OK) {
+		char **atts;
+		char *attr_data = NULL;
+		size_t attr_size = 0;
+		size_t offset = 0;
+
+		if ((atts = calloc(num_atts * 2, sizeof(char *))) == NULL) {
+			d->status = CP_ERR_RESOURCE;
+			return;
+		}
+		for (i = 0; i < num_atts * 2; i++) {
+			atts[i] = deserialize_str(d);
+			attr_size += (atts[i] != NULL ? strlen(atts[i]) : 0) + 1;
+		}
+		if (d->status == CP_OK && (attr_data = malloc(attr_size * sizeof(char))) == NULL) {
+			d->status = CP_ERR_RESOURCE;
+		}
+		for (i = 0; i < num_atts * 2; i++) {
+			if (d->status == CP_OK) {
+				strcpy(attr_data + offset, atts[i] != NULL ? atts[i] : "");
+			}
+			free(atts[i]);
+			atts[i] = NULL;
+			if (d->status == CP_OK) {
+				atts[i] = attr_data + offset;
+				offset += strlen(atts[i]) + 1;
+			}
+		}
+		if (d->status != CP_OK) {
+			free(atts);
+			return;
+		}
+		ce->atts = atts;
+		ce->num_atts = num_atts;
+	}
+
+	ce->value = deserialize_str(d);
+	ce->num_children = deserialize_count(d);
+	if (ce->num_children > 0 && d->status == CP_OK) {
+		if ((ce->children = calloc(ce->num_children, sizeof(cp_cfg_element_t))) == NULL) {
+			ce->num_children = 0;
+			d->status = CP_ERR_RESOURCE;
+			return;
+		}
+		for (i = 0; i < ce->num_children && d->status == CP_OK; i++) {
+			deserialize_cfg_element(d, ce->children + i, ce, i);
+		}
+	}
+}
+
+CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor_from_serialized(cp_context_t *context, const char *path, const char *buffer, unsigned int buffer_len, cp_status_t *error) {
+	deserializer_t d;
+	cp_plugin_info_t *plugin = NULL;
+	unsigned int i;
+
+	CHECK_NOT_NULL(context);
+	CHECK_NOT_NULL(path);
+	CHECK_NOT_NULL(buffer);
+	cpi_lock_context(context);
+	cpi_check_invocation(context, CPI_CF_ANY, __func__);
+
+	d.buffer = buffer;
+	d.buffer_len = buffer_len;
+	d.pos = 0;
+	d.status = CP_OK;
+	do {
+		if (deserialize_uint(&d) != CP_SERIALIZED_MAGIC) {
+			d.status = CP_ERR_MALFORMED;
+			break;
+		}
+		if ((plugin = calloc(1, sizeof(cp_plugin_info_t))) == NULL) {
+			d.status = CP_ERR_RESOURCE;
+			break;
+		}
+		plugin->identifier = deserialize_str(&d);
+		plugin->name = deserialize_str(&d);
+		plugin->version = deserialize_str(&d);
+		plugin->provider_name = deserialize_str(&d);
+		plugin->abi_bw_compatibility = deserialize_str(&d);
+		plugin->api_bw_compatibility = deserialize_str(&d);
+		plugin->req_cpluff_version = deserialize_str(&d);
+
+		plugin->num_imports = deserialize_count(&d);
+		if (plugin->num_imports > 0 && d.status == CP_OK) {
+			if ((plugin->imports = calloc(plugin->num_imports, sizeof(cp_plugin_import_t))) == NULL) {
+				plugin->num_imports = 0;
+				d.status = CP_ERR_RESOURCE;
+				break;
+			}
+			for (i = 0; i < plugin->num_imports; i++) {
+				plugin->imports[i].plugin_id = deserialize_str(&d);
+				plugin->imports[i].version = deserialize_str(&d);
+				plugin->imports[i].optional = deserialize_uint(&d);
+			}
+		}
+
+		plugin->runtime_lib_name = deserialize_str(&d);
+		plugin->runtime_funcs_symbol = deserialize_str(&d);
+
+		plugin->num_ext_points = deserialize_count(&d);
+		if (plugin->num_ext_points > 0 && d.status == CP_OK) {
+			if ((plugin->ext_points = calloc(plugin->num_ext_points, sizeof(cp_ext_point_t))) == NULL) {
+				plugin->num_ext_points = 0;
+				d.status = CP_ERR_RESOURCE;
+				break;
+			}
+			for (i = 0; i < plugin->num_ext_points; i++) {
+				plugin->ext_points[i].plugin = plugin;
+				plugin->ext_points[i].local_id = deserialize_str(&d);
+				plugin->ext_points[i].identifier = deserialize_str(&d);
+				plugin->ext_points[i].name = deserialize_str(&d);
+				plugin->ext_points[i].schema_path = deserialize_str(&d);
+			}
+		}
+
+		plugin->num_extensions = deserialize_count(&d);
+		if (plugin->num_extensions > 0 && d.status == CP_OK) {
+			if ((plugin->extensions = calloc(plugin->num_extensions, sizeof(cp_extension_t))) == NULL) {
+				plugin->num_extensions = 0;
+				d.status = CP_ERR_RESOURCE;
+				break;
+			}
+			for (i = 0; i < plugin->num_extensions && d.status == CP_OK; i++) {
+				cp_extension_t *extension = plugin->extensions + i;
+
+				extension->plugin = plugin;
+				extension->ext_point_id = deserialize_str(&d);
+				extension->local_id = deserialize_str(&d);
+				extension->identifier = deserialize_str(&d);
+				extension->name = deserialize_str(&d);
+				if (deserialize_uint(&d) && d.status == CP_OK) {
+					if ((extension->configuration = malloc(sizeof(cp_cfg_element_t))) == NULL) {
+						d.status = CP_ERR_RESOURCE;
+						break;
+					}
+					deserialize_cfg_element(&d, extension->configuration, NULL, 0);
+				}
+			}
+		}
+		if (d.status != CP_OK) {
+			break;
+		}
+		if (plugin->identifier == NULL || d.pos != d.buffer_len) {
+			d.status = CP_ERR_MALFORMED;
+			break;
+		}
+
+		// Initialize the plug-in path
+		if ((plugin->plugin_path = malloc((strlen(path) + 1) * sizeof(char))) == NULL) {
+			d.status = CP_ERR_RESOURCE;
+			break;
+		}
+		strcpy(plugin->plugin_path, path);
+
+		// Increase plug-in usage count
+		d.status = cpi_register_info(context, plugin, (void (*)(cp_context_t *, void *)) dealloc_plugin_info);
+
+	} while (0);
+
+	if (d.status != CP_OK) {
+		cpi_debugf(context,
+			N_("Serialized plug-in descriptor of %s could not be loaded."), path);
+		if (plugin != NULL) {
+			cpi_free_plugin(plugin);
+			plugin = NULL;
+		}
+	}
+	cpi_unlock_context(context);
+
+	// Return error code
+	if (error != NULL) {
+		*error = d.status;
+	}
+
+	return plugin;
+}
@@ -119,7 +119,11 @@ CP_C_API cp_status_t cp_scan_plugins(cp_context_t *context, int flags) {
 						strcpy(pdir_path + dir_path_len + 1, de->d_name);
 							
 						// Try to load a plug-in 
-						plugin = cp_load_plugin_descriptor(context, pdir_path, &s);
+						if (context->env->descriptor_loader != NULL) {
+							plugin = context->env->descriptor_loader(context, pdir_path, &s, context->env->descriptor_loader_data);
+						} else {
+							plugin = cp_load_plugin_descriptor(context, pdir_path, &s);
+						}
 						if (plugin == NULL) {
 							status = s;
 							// continue loading plug-ins from other directories 
@@ -2664,6 +2664,11 @@ void CFileItemList::RemoveDiscCache(int windowID) const
   }
 }
 
+bool CFileItemList::HasDiscCache(int windowID) const
+{
+  return CFile::Exists(GetDiscFileCache(windowID));
+}
+
 std::string CFileItemList::GetDiscFileCache(int windowID) const
 {
   std::string strPath(GetPath());
@@ -675,6 +675,7 @@ public:
    \sa Save,Load
    */
   void RemoveDiscCache(int windowID = 0) const;
+  bool HasDiscCache(int windowID = 0) const;
   bool AlwaysCache() const;
 
   void Swap(unsigned int item1, unsigned int item2);
@@ -20,7 +20,7 @@
 
 #include "PartyModeManager.h"
 
-#include <algorithm>
+#include <cstring>
 
 #include "Application.h"
 #include "dialogs/GUIDialogOK.h"
@@ -28,12 +28,14 @@
 #include "guilib/GUIWindowManager.h"
 #include "GUIUserMessages.h"
 #include "interfaces/AnnouncementManager.h"
+#include "media/MediaType.h"
 #include "music/MusicDatabase.h"
 #include "music/windows/GUIWindowMusicPlaylist.h"
 #include "PlayListPlayer.h"
 #include "playlists/PlayList.h"
 #include "playlists/SmartPlayList.h"
 #include "profiles/ProfilesManager.h"
+#include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
@@ -44,6 +46,44 @@ using namespace PLAYLIST;
 
 #define QUEUE_DEPTH       10
 
+namespace
+{
+  std::vector<int> GetIDs(const std::vector< std::pair<int,int> > &songIDs)
+  {
+    std::vector<int> ids;
+    ids.reserve(songIDs.size());
+    for (std::vector< std::pair<int,int> >::const_iterator it = songIDs.begin(); it != songIDs.end(); ++it)
+      ids.push_back(it->second);
+    return ids;
+  }
+
+  std::string JoinIDs(const std::set<int> &ids)
+  {
+    std::string joined;
+    for (std::set<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+    {
+      if (!joined.empty())
+        joined += ",";
+      joined += StringUtils::Format("%i", *it);
+    }
+    return joined;
+  }
+
+  void UpdateSampler(CRandomSampler &sampler, const std::set<int> &ids, const std::vector< std::pair<int,int> > &matching)
+  {
+    // ids that were updated or removed and don't match the filter (any longer) are dropped,
+    // matching ids that were picked before stay picked
+    std::set<int> dropped(ids);
+    for (std::vector< std::pair<int,int> >::const_iterator it = matching.begin(); it != matching.end(); ++it)
+    {
+      dropped.erase(it->second);
+      sampler.Add(it->second);
+    }
+    for (std::set<int>::const_iterator it = dropped.begin(); it != dropped.end(); ++it)
+      sampler.Remove(*it);
+  }
+}
+
 CPartyModeManager::CPartyModeManager(void)
 {
   m_bIsVideo = false;
@@ -131,6 +171,7 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
         OnError(16031, (std::string)"Party mode found no matching songs. Aborting.");
         return false;
       }
+      m_songSampler.Assign(GetIDs(songIDs));
     }
     else
     {
@@ -144,7 +185,7 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
   if (StringUtils::EqualsNoCase(m_type, "musicvideos") ||
       StringUtils::EqualsNoCase(m_type, "mixed"))
   {
-    std::vector< std::pair<int,int> > songIDs2;
+    songIDs.clear();
     CVideoDatabase db;
     if (db.Open())
     {
@@ -153,7 +194,7 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
         m_strCurrentFilterVideo = playlist.GetWhereClause(db, playlists);
 
       CLog::Log(LOGINFO, "PARTY MODE MANAGER: Registering filter:[%s]", m_strCurrentFilterVideo.c_str());
-      m_iMatchingSongs += (int)db.GetMusicVideoIDs(m_strCurrentFilterVideo, songIDs2);
+      m_iMatchingSongs += (int)db.GetMusicVideoIDs(m_strCurrentFilterVideo, songIDs);
       if (m_iMatchingSongs < 1)
       {
         pDialog->Close();
@@ -161,6 +202,7 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
         OnError(16031, (std::string)"Party mode found no matching songs. Aborting.");
         return false;
       }
+      m_videoSampler.Assign(GetIDs(songIDs));
     }
     else
     {
@@ -169,7 +211,6 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
       return false;
     }
     db.Close();
-    songIDs.insert(songIDs.end(),songIDs2.begin(),songIDs2.end());
   }
 
   // calculate history size
@@ -192,7 +233,7 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
   pDialog->SetLine(0, CVariant{m_bIsVideo ? 20252 : 20124});
   pDialog->Progress();
   // add initial songs
-  if (!AddInitialSongs(songIDs))
+  if (!AddInitialSongs())
   {
     pDialog->Close();
     return false;
@@ -214,6 +255,7 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
 
   // done
   m_bEnabled = true;
+  ANNOUNCEMENT::CAnnouncementManager::GetInstance().AddAnnouncer(this);
   Announce();
   return true;
 }
@@ -223,6 +265,9 @@ void CPartyModeManager::Disable()
   if (!IsEnabled())
     return;
   m_bEnabled = false;
+  ANNOUNCEMENT::CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
+  m_songSampler.Clear();
+  m_videoSampler.Clear();
   Announce();
   CLog::Log(LOGINFO,"PARTY MODE MANAGER: Party mode disabled.");
 }
@@ -335,102 +380,32 @@ bool CPartyModeManager::AddRandomSongs(int iSongs /* = 0 */)
     }
   }
 
-  // add songs to fill queue
+  // pick the songs to fill the queue from the ids matching the filters
+  UpdateCandidates();
+  std::vector< std::pair<int,int> > songIDs;
   if (StringUtils::EqualsNoCase(m_type, "songs") ||
       StringUtils::EqualsNoCase(m_type, "mixed"))
   {
-    CMusicDatabase database;
-    if (database.Open())
-    {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
-      bool error(false);
-      for (int i = 0; i < iSongsToAdd; i++)
-      {
-        std::pair<std::string,std::string> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        int songID;
-        if (database.GetRandomSong(item.get(), songID, whereClause.first))
-        { // success
-          Add(item);
-          AddToHistory(1,songID);
-        }
-        else
-        {
-          error = true;
-          break;
-        }
-      }
-
-      if (error)
-      {
-        database.Close();
-        OnError(16034, (std::string)"Cannot get songs from database. Aborting.");
-        return false;
-      }
-    }
-    else
+    if (!PickSongs(1, iSongsToAdd, songIDs))
     {
-      OnError(16033, (std::string)"Party mode could not open database. Aborting.");
+      OnError(16034, (std::string)"Cannot get songs from database. Aborting.");
       return false;
     }
-    database.Close();
   }
   if (StringUtils::EqualsNoCase(m_type, "musicvideos") ||
       StringUtils::EqualsNoCase(m_type, "mixed"))
   {
-    CVideoDatabase database;
-    if (database.Open())
+    if (!PickSongs(2, iVidsToAdd, songIDs))
     {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
-      bool error(false);
-      for (int i = 0; i < iVidsToAdd; i++)
-      {
-        std::pair<std::string,std::string> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        int songID;
-        if (database.GetRandomMusicVideo(item.get(), songID, whereClause.second))
-        { // success
-          Add(item);
-          AddToHistory(2,songID);
-        }
-        else
-        {
-          error = true;
-          break;
-        }
-      }
-
-      if (error)
-      {
-        database.Close();
-        OnError(16034, (std::string)"Cannot get songs from database. Aborting.");
-        return false;
-      }
-    }
-    else
-    {
-      OnError(16033, (std::string)"Party mode could not open database. Aborting.");
+      OnError(16034, (std::string)"Cannot get songs from database. Aborting.");
       return false;
     }
-    database.Close();
+  }
+
+  if (!AddSongs(songIDs))
+  {
+    OnError(16033, (std::string)"Party mode could not open database. Aborting.");
+    return false;
   }
   return true;
 }
@@ -518,6 +493,7 @@ void CPartyModeManager::OnError(int iError, const std::string&  strLogMessage)
   CGUIDialogOK::ShowAndGetInput(CVariant{257}, CVariant{16030}, CVariant{iError}, CVariant{0});
   CLog::Log(LOGERROR, "PARTY MODE MANAGER: %s", strLogMessage.c_str());
   m_bEnabled = false;
+  ANNOUNCEMENT::CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
   SendUpdateMessage();
 }
 
@@ -586,6 +562,16 @@ void CPartyModeManager::ClearState()
 
   m_songsInHistory = 0;
   m_history.clear();
+
+  m_songSampler.Clear();
+  m_videoSampler.Clear();
+  m_songsChanged = false;
+  m_videosChanged = false;
+  {
+    CSingleLock lock(m_pendingSection);
+    m_songsPending.clear();
+    m_videosPending.clear();
+  }
 }
 
 void CPartyModeManager::UpdateStats()
@@ -595,7 +581,7 @@ void CPartyModeManager::UpdateStats()
   m_iRelaxedSongs = 0;  // unsupported at this stage
 }
 
-bool CPartyModeManager::AddInitialSongs(std::vector< std::pair<int,int > > &songIDs)
+bool CPartyModeManager::AddInitialSongs()
 {
   int iPlaylist = m_bIsVideo ? PLAYLIST_VIDEO : PLAYLIST_MUSIC;
 
@@ -603,98 +589,170 @@ bool CPartyModeManager::AddInitialSongs(std::vector< std::pair<int,int > > &song
   int iMissingSongs = QUEUE_DEPTH - playlist.size();
   if (iMissingSongs > 0)
   {
-    // generate iMissingSongs random ids from songIDs
-    if (iMissingSongs > (int)songIDs.size())
+    unsigned int available = m_songSampler.Available() + m_videoSampler.Available();
+    if (iMissingSongs > (int)available)
       return false; // can't do it if we have less songs than we need
 
-    std::vector<std::pair<int,int> > chosenSongIDs;
-    GetRandomSelection(songIDs, iMissingSongs, chosenSongIDs);
-    std::string sqlWhereMusic = "songview.idSong IN (";
-    std::string sqlWhereVideo = "idMVideo IN (";
-
-    for (std::vector< std::pair<int,int> >::iterator it = chosenSongIDs.begin(); it != chosenSongIDs.end(); ++it)
+    std::vector< std::pair<int,int> > songIDs;
+    for (int i = 0; i < iMissingSongs; i++)
     {
-      std::string song = StringUtils::Format("%i,", it->second);
-      if (it->first == 1)
-        sqlWhereMusic += song;
-      if (it->first == 2)
-        sqlWhereVideo += song;
+      // pick songs and music videos in proportion to their number
+      unsigned int songs = m_songSampler.Available();
+      int type = (unsigned int)rand() % (songs + m_videoSampler.Available()) < songs ? 1 : 2;
+      PickSongs(type, 1, songIDs);
     }
-    // add songs to fill queue
-    CFileItemList items;
 
-    if (sqlWhereMusic.size() > 26)
-    {
-      sqlWhereMusic[sqlWhereMusic.size() - 1] = ')'; // replace the last comma with closing bracket
-      CMusicDatabase database;
-      database.Open();
-      database.GetSongsByWhere("musicdb://songs/", sqlWhereMusic, items);
-    }
-    if (sqlWhereVideo.size() > 19)
-    {
-      sqlWhereVideo[sqlWhereVideo.size() - 1] = ')'; // replace the last comma with closing bracket
-      CVideoDatabase database;
-      database.Open();
-      database.GetMusicVideosByWhere("videodb://musicvideos/titles/", sqlWhereVideo, items);
-    }
+    return AddSongs(songIDs);
+  }
+  return true;
+}
 
-    m_history = chosenSongIDs;
-    items.Randomize(); //randomizing the initial list or they will be in database order
-    for (int i = 0; i < items.Size(); i++)
+bool CPartyModeManager::AddSongs(const std::vector< std::pair<int,int> > &songIDs)
+{
+  std::string sqlWhereMusic = "songview.idSong IN (";
+  std::string sqlWhereVideo = "idMVideo IN (";
+
+  for (std::vector< std::pair<int,int> >::const_iterator it = songIDs.begin(); it != songIDs.end(); ++it)
+  {
+    std::string song = StringUtils::Format("%i,", it->second);
+    if (it->first == 1)
+      sqlWhereMusic += song;
+    if (it->first == 2)
+      sqlWhereVideo += song;
+  }
+
+  CFileItemList items;
+  if (sqlWhereMusic.size() > 26)
+  {
+    sqlWhereMusic[sqlWhereMusic.size() - 1] = ')'; // replace the last comma with closing bracket
+    CMusicDatabase database;
+    if (!database.Open())
+      return false;
+    database.GetSongsByWhere("musicdb://songs/", sqlWhereMusic, items);
+  }
+  if (sqlWhereVideo.size() > 19)
+  {
+    sqlWhereVideo[sqlWhereVideo.size() - 1] = ')'; // replace the last comma with closing bracket
+    CVideoDatabase database;
+    if (!database.Open())
+      return false;
+    database.GetMusicVideosByWhere("videodb://musicvideos/titles/", sqlWhereVideo, items);
+  }
+
+  items.Randomize(); //randomizing the list or they will be in database order
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CFileItemPtr item(items[i]);
+    Add(item);
+    // TODO: Allow "relaxed restrictions" later?
+  }
+  return true;
+}
+
+bool CPartyModeManager::PickSongs(int type, int count, std::vector< std::pair<int,int> > &songIDs)
+{
+  CRandomSampler &sampler = GetSampler(type);
+  for (int i = 0; i < count; i++)
+  {
+    int songID;
+    if (!sampler.Pick(songID))
     {
-      CFileItemPtr item(items[i]);
-      Add(item);
-      // TODO: Allow "relaxed restrictions" later?
+      // every matching song is in the history, start over
+      ClearHistory(type);
+      if (!sampler.Pick(songID))
+        return false;
     }
+    songIDs.push_back(std::make_pair(type, songID));
+    AddToHistory(type, songID);
   }
   return true;
 }
 
-std::pair<std::string,std::string> CPartyModeManager::GetWhereClauseWithHistory() const
+void CPartyModeManager::UpdateCandidates()
 {
-  // now add this on to the normal where clause
-  std::vector<std::string> historyItemsMusic;
-  std::vector<std::string> historyItemsVideo;
-  for (unsigned int i = 0; i < m_history.size(); i++)
+  bool reloadSongs = m_songsChanged.exchange(false);
+  bool reloadVideos = m_videosChanged.exchange(false);
+  std::set<int> songsPending;
+  std::set<int> videosPending;
   {
-    std::string number = StringUtils::Format("%i", m_history[i].second);
-    if (m_history[i].first == 1)
-      historyItemsMusic.push_back(number);
-    if (m_history[i].first == 2)
-      historyItemsVideo.push_back(number);
+    CSingleLock lock(m_pendingSection);
+    songsPending.swap(m_songsPending);
+    videosPending.swap(m_videosPending);
   }
 
-  std::string historyWhereMusic;
-  if (!historyItemsMusic.empty())
+  // the songs stay picked while they are in the history, even if the library changed
+  if ((reloadSongs || !songsPending.empty()) &&
+      (StringUtils::EqualsNoCase(m_type, "songs") || StringUtils::EqualsNoCase(m_type, "mixed")))
   {
-    if (!m_strCurrentFilterMusic.empty())
-      historyWhereMusic = m_strCurrentFilterMusic + " and ";
-    historyWhereMusic += "songview.idSong not in (" + StringUtils::Join(historyItemsMusic, ", ") + ")";
+    std::vector< std::pair<int,int> > songIDs;
+    CMusicDatabase db;
+    if (db.Open())
+    {
+      if (reloadSongs)
+      {
+        db.GetSongIDs(m_strCurrentFilterMusic, songIDs);
+        m_songSampler.Update(GetIDs(songIDs));
+      }
+      else
+      {
+        // only check the songs that changed against the filter
+        CDatabase::Filter filter(m_strCurrentFilterMusic);
+        filter.AppendWhere("songview.idSong IN (" + JoinIDs(songsPending) + ")");
+        db.GetSongIDs(filter, songIDs);
+        UpdateSampler(m_songSampler, songsPending, songIDs);
+      }
+      db.Close();
+    }
   }
 
-  std::string historyWhereVideo;
-  if (!historyItemsVideo.empty())
+  if ((reloadVideos || !videosPending.empty()) &&
+      (StringUtils::EqualsNoCase(m_type, "musicvideos") || StringUtils::EqualsNoCase(m_type, "mixed")))
   {
-    if (!m_strCurrentFilterVideo.empty())
-      historyWhereVideo = m_strCurrentFilterVideo + " and ";
-    historyWhereVideo += "idMVideo not in (" + StringUtils::Join(historyItemsVideo, ", ") + ")";
+    std::vector< std::pair<int,int> > songIDs;
+    CVideoDatabase db;
+    if (db.Open())
+    {
+      if (reloadVideos)
+      {
+        db.GetMusicVideoIDs(m_strCurrentFilterVideo, songIDs);
+        m_videoSampler.Update(GetIDs(songIDs));
+      }
+      else
+      {
+        std::string where = "idMVideo IN (" + JoinIDs(videosPending) + ")";
+        if (!m_strCurrentFilterVideo.empty())
+          where = "(" + m_strCurrentFilterVideo + ") AND " + where;
+        db.GetMusicVideoIDs(where, songIDs);
+        UpdateSampler(m_videoSampler, videosPending, songIDs);
+      }
+      db.Close();
+    }
   }
 
-  return std::make_pair(historyWhereMusic, historyWhereVideo);
+  m_iMatchingSongs = m_songSampler.Size() + m_videoSampler.Size();
 }
 
 void CPartyModeManager::AddToHistory(int type, int songID)
 {
   while (m_history.size() >= m_songsInHistory && m_songsInHistory)
+  {
+    // the song may be picked again once it dropped out of the history
+    GetSampler(m_history.front().first).Release(m_history.front().second);
     m_history.erase(m_history.begin());
+  }
   m_history.push_back(std::make_pair(type,songID));
 }
 
-void CPartyModeManager::GetRandomSelection(std::vector< std::pair<int,int> >& in, unsigned int number, std::vector< std::pair<int,int> >& out)
+void CPartyModeManager::ClearHistory(int type)
 {
-  number = std::min(number, (unsigned int)in.size());
-  std::random_shuffle(in.begin(), in.end());
-  out.assign(in.begin(), in.begin() + number);
+  for (std::vector< std::pair<int,int> >::iterator it = m_history.begin(); it != m_history.end(); )
+  {
+    if (it->first == type)
+      it = m_history.erase(it);
+    else
+      ++it;
+  }
+  GetSampler(type).Reset();
 }
 
 bool CPartyModeManager::IsEnabled(PartyModeContext context /* = PARTYMODECONTEXT_UNKNOWN */) const
@@ -718,3 +776,39 @@ void CPartyModeManager::Announce()
     ANNOUNCEMENT::CAnnouncementManager::GetInstance().Announce(ANNOUNCEMENT::Player, "xbmc", "OnPropertyChanged", data);
   }
 }
+
+void CPartyModeManager::Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if (strcmp(sender, "xbmc") != 0)
+    return;
+
+  // all ids matching the filters are fetched again before the next song is picked
+  if (strcmp(message, "OnScanFinished") == 0 || strcmp(message, "OnCleanFinished") == 0)
+  {
+    if (flag == ANNOUNCEMENT::AudioLibrary)
+      m_songsChanged = true;
+    else if (flag == ANNOUNCEMENT::VideoLibrary)
+      m_videosChanged = true;
+    return;
+  }
+
+  // an updated song may (no longer) match the filter, e.g. after its playcount changed,
+  // so only that song is checked against the filter again
+  if (strcmp(message, "OnUpdate") != 0 && strcmp(message, "OnRemove") != 0)
+    return;
+
+  // changes made while scanning are covered by the reload once the scan finished
+  if (data["transaction"].asBoolean())
+    return;
+
+  const CVariant &item = data.isMember("item") ? data["item"] : data;
+  if (!item["id"].isInteger())
+    return;
+  int id = static_cast<int>(item["id"].asInteger());
+
+  CSingleLock lock(m_pendingSection);
+  if (flag == ANNOUNCEMENT::AudioLibrary && item["type"].asString() == MediaTypeSong)
+    m_songsPending.insert(id);
+  else if (flag == ANNOUNCEMENT::VideoLibrary && item["type"].asString() == MediaTypeMusicVideo)
+    m_videosPending.insert(id);
+}
@@ -19,11 +19,17 @@
  *
  */
 
+#include <atomic>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "interfaces/IAnnouncer.h"
+#include "threads/CriticalSection.h"
+#include "utils/RandomSampler.h"
+
 class CFileItem; typedef std::shared_ptr<CFileItem> CFileItemPtr;
 class CFileItemList;
 namespace PLAYLIST
@@ -38,7 +44,7 @@ typedef enum
   PARTYMODECONTEXT_VIDEO
 } PartyModeContext;
 
-class CPartyModeManager
+class CPartyModeManager : public ANNOUNCEMENT::IAnnouncer
 {
 public:
   CPartyModeManager(void);
@@ -59,10 +65,14 @@ public:
   int GetRandomSongs();
   PartyModeContext GetType() const;
 
+  virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+  virtual int GetAnnouncementFlags() { return ANNOUNCEMENT::AudioLibrary | ANNOUNCEMENT::VideoLibrary; }
+
 private:
   void Process();
   bool AddRandomSongs(int iSongs = 0);
-  bool AddInitialSongs(std::vector< std::pair<int,int> > &songIDs);
+  bool AddInitialSongs();
+  bool AddSongs(const std::vector< std::pair<int,int> > &songIDs);
   void Add(CFileItemPtr &pItem);
   bool ReapSongs();
   bool MovePlaying();
@@ -70,9 +80,11 @@ private:
   void OnError(int iError, const std::string& strLogMessage);
   void ClearState();
   void UpdateStats();
-  std::pair<std::string,std::string> GetWhereClauseWithHistory() const;
   void AddToHistory(int type, int songID);
-  void GetRandomSelection(std::vector< std::pair<int,int> > &in, unsigned int number, std::vector< std::pair<int, int> > &out);
+  void ClearHistory(int type);
+  bool PickSongs(int type, int count, std::vector< std::pair<int,int> > &songIDs);
+  void UpdateCandidates();
+  CRandomSampler& GetSampler(int type) { return type == 1 ? m_songSampler : m_videoSampler; }
   void Announce();
 
   // state
@@ -94,6 +106,15 @@ private:
   // history
   unsigned int m_songsInHistory;
   std::vector< std::pair<int,int> > m_history;
+
+  // ids of the songs and music videos matching the filters, songs in the history are picked
+  CRandomSampler m_songSampler;
+  CRandomSampler m_videoSampler;
+  std::atomic<bool> m_songsChanged;   ///< all songs are checked against the filter again
+  std::atomic<bool> m_videosChanged;
+  CCriticalSection m_pendingSection;
+  std::set<int> m_songsPending;       ///< updated or removed songs to check against the filter again
+  std::set<int> m_videosPending;
 };
 
 extern CPartyModeManager g_partyModeManager;
@@ -42,11 +42,14 @@
 #endif
 #include <stdlib.h>
 #include <algorithm>
+#include <map>
+#include <memory>
 
 #include "Application.h"
 #include "Util.h"
 #include "filesystem/PVRDirectory.h"
 #include "filesystem/Directory.h"
+#include "filesystem/DirectoryWalker.h"
 #include "filesystem/StackDirectory.h"
 #include "filesystem/MultiPathDirectory.h"
 #include "filesystem/SpecialProtocol.h"
@@ -1258,31 +1261,80 @@ void CUtil::DeleteDirectoryCache(const std::string &prefix)
 }
 
 
-void CUtil::GetRecursiveListing(const std::string& strPath, CFileItemList& items, const std::string& strMask, unsigned int flags /* = DIR_FLAG_DEFAULTS */)
+namespace
 {
-  CFileItemList myItems;
-  CDirectory::GetDirectory(strPath,myItems,strMask,flags);
-  for (int i=0;i<myItems.Size();++i)
+  typedef std::map<std::string, std::shared_ptr<CFileItemList> > LISTINGS;
+
+  void ListDirectory(const std::string& strPath, const std::string& strMask, unsigned int flags, LISTINGS& listings)
   {
-    if (myItems[i]->m_bIsFolder)
-      CUtil::GetRecursiveListing(myItems[i]->GetPath(),items,strMask,flags);
-    else
-      items.Add(myItems[i]);
+    std::shared_ptr<CFileItemList> items(new CFileItemList);
+    CDirectory::GetDirectory(strPath, *items, strMask, flags);
+    listings[strPath] = items;
+
+    for (int i = 0; i < items->Size(); ++i)
+    {
+      const CFileItemPtr item = items->Get(i);
+      if (item->m_bIsFolder && !item->IsPath("..") && listings.find(item->GetPath()) == listings.end())
+        ListDirectory(item->GetPath(), strMask, flags, listings);
+    }
   }
-}
 
-void CUtil::GetRecursiveDirsListing(const std::string& strPath, CFileItemList& item, unsigned int flags /* = DIR_FLAG_DEFAULTS */)
-{
-  CFileItemList myItems;
-  CDirectory::GetDirectory(strPath,myItems,"",flags);
-  for (int i=0;i<myItems.Size();++i)
+  // list the whole tree up front, with sibling directories on network shares listed concurrently
+  void WalkDirectory(const std::string& strPath, const std::string& strMask, unsigned int flags, LISTINGS& listings)
   {
-    if (myItems[i]->m_bIsFolder && !myItems[i]->IsPath(".."))
+    // local disks gain nothing from concurrent listings
+    if (!URIUtils::IsRemote(strPath))
+    {
+      ListDirectory(strPath, strMask, flags, listings);
+      return;
+    }
+
+    CDirectoryWalker walker(strMask, flags);
+    walker.Start(strPath);
+
+    std::string directory;
+    std::shared_ptr<CFileItemList> items(new CFileItemList);
+    while (walker.GetNext(directory, *items))
     {
-      item.Add(myItems[i]);
-      CUtil::GetRecursiveDirsListing(myItems[i]->GetPath(),item,flags);
+      listings[directory] = items;
+      items.reset(new CFileItemList);
     }
   }
+
+  // assemble the listings in the same order as a depth first walk
+  void AddRecursiveListing(const std::string& strPath, const LISTINGS& listings, CFileItemList& items, bool dirsOnly)
+  {
+    LISTINGS::const_iterator it = listings.find(strPath);
+    if (it == listings.end())
+      return;
+
+    const CFileItemList& myItems = *it->second;
+    for (int i=0;i<myItems.Size();++i)
+    {
+      if (myItems[i]->m_bIsFolder && !myItems[i]->IsPath(".."))
+      {
+        if (dirsOnly)
+          items.Add(myItems[i]);
+        AddRecursiveListing(myItems[i]->GetPath(),listings,items,dirsOnly);
+      }
+      else if (!dirsOnly && !myItems[i]->m_bIsFolder)
+        items.Add(myItems[i]);
+    }
+  }
+}
+
+void CUtil::GetRecursiveListing(const std::string& strPath, CFileItemList& items, const std::string& strMask, unsigned int flags /* = DIR_FLAG_DEFAULTS */)
+{
+  LISTINGS listings;
+  WalkDirectory(strPath, strMask, flags, listings);
+  AddRecursiveListing(strPath, listings, items, false);
+}
+
+void CUtil::GetRecursiveDirsListing(const std::string& strPath, CFileItemList& item, unsigned int flags /* = DIR_FLAG_DEFAULTS */)
+{
+  LISTINGS listings;
+  WalkDirectory(strPath, "", flags, listings);
+  AddRecursiveListing(strPath, listings, item, true);
 }
 
 void CUtil::ForceForwardSlashes(std::string& strPath)
@@ -21,19 +21,66 @@
 #include "AddonDatabase.h"
 
 #include <algorithm>
+#include <map>
+#include <set>
 #include <utility>
 
 #include "addons/AddonManager.h"
 #include "dbwrappers/dataset.h"
 #include "utils/log.h"
+#include "utils/md5.h"
 #include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include "XBDateTime.h"
 
 
 using namespace ADDON;
 
+namespace
+{
+  /*! Digest of everything that is stored of an add-on, used to tell whether
+   a repository changed it. */
+  std::string GetDigest(const AddonPtr& addon)
+  {
+    XBMC::XBMC_MD5 md5;
+    auto append = [&md5](const std::string& value)
+    {
+      // include the terminating null to keep adjacent fields apart
+      md5.append(value.c_str(), value.size() + 1);
+    };
+
+    append(TranslateType(addon->Type(), false));
+    append(addon->Name());
+    append(addon->Summary());
+    append(addon->Description());
+    append(StringUtils::Format("%i", addon->Stars()));
+    append(addon->Path());
+    append(addon->Props().icon);
+    append(addon->ChangeLog());
+    append(addon->FanArt());
+    append(addon->ID());
+    append(addon->Version().asString());
+    append(addon->Author());
+    append(addon->Disclaimer());
+    append(addon->MinVersion().asString());
+    for (const auto& it : addon->ExtraInfo())
+    {
+      append(it.first);
+      append(it.second);
+    }
+    for (const auto& it : addon->GetDeps())
+    {
+      append(it.first);
+      append(it.second.first.asString());
+      append(it.second.second ? "1" : "0");
+    }
+    return md5.getDigest();
+  }
+}
+
 CAddonDatabase::CAddonDatabase()
+  : m_hasSearchIndex(false)
 {
 }
 
@@ -43,7 +90,11 @@ CAddonDatabase::~CAddonDatabase()
 
 bool CAddonDatabase::Open()
 {
-  return CDatabase::Open();
+  if (!CDatabase::Open())
+    return false;
+
+  m_hasSearchIndex = HasSearchIndex();
+  return true;
 }
 
 void CAddonDatabase::CreateTables()
@@ -53,7 +104,7 @@ void CAddonDatabase::CreateTables()
               "name text, summary text, description text, stars integer,"
               "path text, addonID text, icon text, version text, "
               "changelog text, fanart text, author text, disclaimer text,"
-              "minversion text)\n");
+              "minversion text, digest text)\n");
 
   CLog::Log(LOGINFO, "create addonextra table");
   m_pDS->exec("CREATE TABLE addonextra (id integer, key text, value text)\n");
@@ -65,6 +116,9 @@ void CAddonDatabase::CreateTables()
   m_pDS->exec("CREATE TABLE repo (id integer primary key, addonID text,"
               "checksum text, lastcheck text, version text)\n");
 
+  CLog::Log(LOGINFO, "create repoindex table");
+  m_pDS->exec("CREATE TABLE repoindex (idRepo integer, url text, etag text, lastmodified text)\n");
+
   CLog::Log(LOGINFO, "create addonlinkrepo table");
   m_pDS->exec("CREATE TABLE addonlinkrepo (idRepo integer, idAddon integer)\n");
 
@@ -96,6 +150,71 @@ void CAddonDatabase::CreateAnalytics()
   m_pDS->exec("CREATE UNIQUE INDEX idxBroken ON broken(addonID)");
   m_pDS->exec("CREATE UNIQUE INDEX idxBlack ON blacklist(addonID)");
   m_pDS->exec("CREATE UNIQUE INDEX idxPackage ON package(filename)");
+
+  CreateSearchIndex();
+}
+
+void CAddonDatabase::CreateSearchIndex()
+{
+  try
+  {
+    if (m_sqlite)
+    {
+      // the index refers to the addon table for its content, the triggers keep it in sync whenever
+      // repository content is added or removed. it has to be rebuilt after the triggers were
+      // dropped for an update.
+      m_pDS->exec("CREATE VIRTUAL TABLE IF NOT EXISTS addonsearch USING fts4(content=\"addon\", "
+                  "name, summary, description, prefix=\"2,3\")");
+      m_pDS->exec("INSERT INTO addonsearch(addonsearch) VALUES('rebuild')");
+      m_pDS->exec("CREATE TRIGGER addonsearch_insert AFTER INSERT ON addon FOR EACH ROW BEGIN "
+                  "INSERT INTO addonsearch(docid, name, summary, description) "
+                  "VALUES (new.id, new.name, new.summary, new.description); END");
+      m_pDS->exec("CREATE TRIGGER addonsearch_delete BEFORE DELETE ON addon FOR EACH ROW BEGIN "
+                  "DELETE FROM addonsearch WHERE docid = old.id; END");
+      m_pDS->exec("CREATE TRIGGER addonsearch_update_before BEFORE UPDATE ON addon FOR EACH ROW BEGIN "
+                  "DELETE FROM addonsearch WHERE docid = old.id; END");
+      m_pDS->exec("CREATE TRIGGER addonsearch_update_after AFTER UPDATE ON addon FOR EACH ROW BEGIN "
+                  "INSERT INTO addonsearch(docid, name, summary, description) "
+                  "VALUES (new.id, new.name, new.summary, new.description); END");
+    }
+    else
+    {
+      // MATCH needs an index with exactly the columns it is given
+      m_pDS->exec("CREATE FULLTEXT INDEX idxAddonSearch ON addon(name, summary, description)");
+      m_pDS->exec("CREATE FULLTEXT INDEX idxAddonSearchName ON addon(name)");
+      m_pDS->exec("CREATE FULLTEXT INDEX idxAddonSearchSummary ON addon(summary)");
+    }
+  }
+  catch (...)
+  {
+    CLog::Log(LOGWARNING, "%s - full-text search isn't supported by the database, searching add-ons will be slow", __FUNCTION__);
+  }
+}
+
+bool CAddonDatabase::HasSearchIndex()
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    std::string sql;
+    if (m_sqlite)
+      sql = "SELECT name FROM sqlite_master WHERE type = 'trigger' AND name = 'addonsearch_insert'";
+    else
+      sql = "SELECT index_name FROM information_schema.statistics WHERE table_schema = DATABASE() "
+            "AND table_name = 'addon' AND index_name = 'idxAddonSearchSummary'";
+
+    m_pDS->query(sql);
+    bool result = !m_pDS->eof();
+    m_pDS->close();
+    return result;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
 }
 
 void CAddonDatabase::UpdateTables(int version)
@@ -124,6 +243,11 @@ void CAddonDatabase::UpdateTables(int version)
     m_pDS->exec("DROP TABLE blacklist");
     m_pDS->exec("ALTER TABLE tmp RENAME TO blacklist");
   }
+  if (version < 22)
+  {
+    m_pDS->exec("ALTER TABLE addon ADD digest text");
+    m_pDS->exec("CREATE TABLE repoindex (idRepo integer, url text, etag text, lastmodified text)\n");
+  }
 }
 
 int CAddonDatabase::GetAddonId(const ADDON::AddonPtr& item)
@@ -142,9 +266,9 @@ int CAddonDatabase::AddAddon(const AddonPtr& addon,
 
     std::string sql = PrepareSQL("insert into addon (id, type, name, summary,"
                                "description, stars, path, icon, changelog, "
-                               "fanart, addonID, version, author, disclaimer, minversion)"
+                               "fanart, addonID, version, author, disclaimer, minversion, digest)"
                                " values(NULL, '%s', '%s', '%s', '%s', %i,"
-                               "'%s', '%s', '%s', '%s', '%s','%s','%s','%s','%s')",
+                               "'%s', '%s', '%s', '%s', '%s','%s','%s','%s','%s','%s')",
                                TranslateType(addon->Type(),false).c_str(),
                                addon->Name().c_str(), addon->Summary().c_str(),
                                addon->Description().c_str(),addon->Stars(),
@@ -152,7 +276,8 @@ int CAddonDatabase::AddAddon(const AddonPtr& addon,
                                addon->ChangeLog().c_str(),addon->FanArt().c_str(),
                                addon->ID().c_str(), addon->Version().asString().c_str(),
                                addon->Author().c_str(),addon->Disclaimer().c_str(),
-                               addon->MinVersion().asString().c_str());
+                               addon->MinVersion().asString().c_str(),
+                               GetDigest(addon).c_str());
     m_pDS->exec(sql);
     int idAddon = (int)m_pDS->lastinsertid();
 
@@ -438,7 +563,8 @@ void CAddonDatabase::DeleteRepository(int idRepo)
     m_pDS->exec(sql);
     sql = PrepareSQL("delete from addonlinkrepo where idRepo=%i",idRepo);
     m_pDS->exec(sql);
-
+    sql = PrepareSQL("delete from repoindex where idRepo=%i",idRepo);
+    m_pDS->exec(sql);
   }
   catch (...)
   {
@@ -446,32 +572,78 @@ void CAddonDatabase::DeleteRepository(int idRepo)
   }
 }
 
-int CAddonDatabase::AddRepository(const std::string& id, const VECADDONS& addons, const std::string& checksum, const AddonVersion& version)
+int CAddonDatabase::UpdateRepositoryContent(const std::string& id, const AddonVersion& version,
+    const std::string& checksum, const VECADDONS& addons,
+    const std::vector<std::string>& unchangedDirs, VECADDONS& updated)
 {
   try
   {
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
-    std::string sql;
-    int idRepo = GetRepoChecksum(id,sql);
-    if (idRepo > -1)
-      DeleteRepository(idRepo);
-
     if (!SetLastChecked(id, version, CDateTime::GetCurrentDateTime().GetAsDBDateTime()))
       return -1;
 
+    std::string sql;
+    int idRepo = GetRepoChecksum(id, sql);
+    if (idRepo == -1)
+      return -1;
+
+    // an add-on that is stored with the same digest is unchanged
+    std::multimap<std::string, AddonPtr> added;
+    for (const auto& addon : addons)
+      added.insert(std::make_pair(GetDigest(addon), addon));
+
+    std::vector<int> removed;
+    std::set<std::string> removedIds;
+    sql = PrepareSQL("SELECT addon.id, addon.addonID, addon.path, addon.digest FROM addon "
+        "JOIN addonlinkrepo ON addonlinkrepo.idAddon=addon.id WHERE addonlinkrepo.idRepo=%i", idRepo);
+    m_pDS->query(sql);
+    while (!m_pDS->eof())
+    {
+      const std::string path = m_pDS->fv(2).get_asString();
+      const bool keep = std::any_of(unchangedDirs.begin(), unchangedDirs.end(),
+          [&path](const std::string& datadir){ return URIUtils::IsInPath(path, datadir); });
+      if (!keep)
+      {
+        auto it = added.find(m_pDS->fv(3).get_asString());
+        if (it != added.end())
+          added.erase(it);
+        else
+        {
+          removed.push_back(m_pDS->fv(0).get_asInt());
+          removedIds.insert(m_pDS->fv(1).get_asString());
+        }
+      }
+      m_pDS->next();
+    }
+    m_pDS->close();
+
     BeginTransaction();
 
-    sql = PrepareSQL("UPDATE repo SET checksum='%s', version='%s' WHERE addonID='%s'",
-        checksum.c_str(), version.asString().c_str(), id.c_str());
+    for (int idAddon : removed)
+    {
+      m_pDS->exec(PrepareSQL("DELETE FROM addon WHERE id=%i", idAddon));
+      m_pDS->exec(PrepareSQL("DELETE FROM addonextra WHERE id=%i", idAddon));
+      m_pDS->exec(PrepareSQL("DELETE FROM dependencies WHERE id=%i", idAddon));
+      m_pDS->exec(PrepareSQL("DELETE FROM addonlinkrepo WHERE idAddon=%i", idAddon));
+    }
 
-    m_pDS->exec(sql);
-    idRepo = (int)m_pDS->lastinsertid();
-    for (unsigned int i=0;i<addons.size();++i)
-      AddAddon(addons[i],idRepo);
+    for (const auto& it : added)
+    {
+      AddAddon(it.second, idRepo);
+      if (removedIds.find(it.second->ID()) != removedIds.end())
+        updated.push_back(it.second);
+    }
+
+    // the validators of the indexes are set once the new content is committed
+    m_pDS->exec(PrepareSQL("DELETE FROM repoindex WHERE idRepo=%i", idRepo));
+    m_pDS->exec(PrepareSQL("UPDATE repo SET checksum='%s' WHERE id=%i", checksum.c_str(), idRepo));
 
     CommitTransaction();
+
+    CLog::Log(LOGDEBUG, "%s repo '%s': %u add-ons added, %u removed", __FUNCTION__, id.c_str(),
+        static_cast<unsigned int>(added.size()), static_cast<unsigned int>(removed.size()));
     return idRepo;
   }
   catch (...)
@@ -505,6 +677,52 @@ int CAddonDatabase::GetRepoChecksum(const std::string& id, std::string& checksum
   return -1;
 }
 
+bool CAddonDatabase::GetIndexValidators(int idRepo, const std::string& url,
+    std::string& etag, std::string& lastModified)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    std::string sql = PrepareSQL("SELECT etag, lastmodified FROM repoindex WHERE idRepo=%i AND url='%s'",
+        idRepo, url.c_str());
+    m_pDS->query(sql);
+    if (!m_pDS->eof())
+    {
+      etag = m_pDS->fv(0).get_asString();
+      lastModified = m_pDS->fv(1).get_asString();
+      m_pDS->close();
+      return true;
+    }
+    m_pDS->close();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on repo %i", __FUNCTION__, idRepo);
+  }
+  return false;
+}
+
+void CAddonDatabase::SetIndexValidators(int idRepo, const std::string& url,
+    const std::string& etag, const std::string& lastModified)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    m_pDS->exec(PrepareSQL("DELETE FROM repoindex WHERE idRepo=%i AND url='%s'", idRepo, url.c_str()));
+    if (!etag.empty() || !lastModified.empty())
+      m_pDS->exec(PrepareSQL("INSERT INTO repoindex (idRepo, url, etag, lastmodified) VALUES (%i, '%s', '%s', '%s')",
+          idRepo, url.c_str(), etag.c_str(), lastModified.c_str()));
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on repo %i", __FUNCTION__, idRepo);
+  }
+}
+
 std::pair<CDateTime, ADDON::AddonVersion> CAddonDatabase::LastChecked(const std::string& id)
 {
   CDateTime date;
@@ -601,21 +819,77 @@ bool CAddonDatabase::Search(const std::string& search, VECADDONS& addons)
     if (NULL == m_pDS.get()) return false;
 
     std::string strSQL;
-    strSQL=PrepareSQL("SELECT addonID FROM addon WHERE name LIKE '%%%s%%' OR summary LIKE '%%%s%%' OR description LIKE '%%%s%%'", search.c_str(), search.c_str(), search.c_str());
+    if (m_hasSearchIndex)
+    {
+      // split into words the way the index does, and match them by prefix
+      std::string lower(search);
+      StringUtils::ToLower(lower);
+      std::vector<std::string> words;
+      std::string word;
+      for (const char c : lower)
+      {
+        if (StringUtils::isasciialphanum(c) || static_cast<unsigned char>(c) >= 0x80)
+          word += c;
+        else if (!word.empty())
+        {
+          words.push_back(word);
+          word.clear();
+        }
+      }
+      if (!word.empty())
+        words.push_back(word);
+      if (words.empty())
+        return false;
+
+      if (m_sqlite)
+      {
+        std::string inName, inSummary, anywhere;
+        for (const auto& w : words)
+        {
+          inName += " name:" + w + "*";
+          inSummary += " summary:" + w + "*";
+          anywhere += " " + w + "*";
+        }
+
+        strSQL = PrepareSQL("SELECT addon.addonID, MIN(hits.searchrank) AS searchrank FROM ("
+                            "SELECT docid, 0 AS searchrank FROM addonsearch WHERE addonsearch MATCH '%s' "
+                            "UNION ALL SELECT docid, 1 AS searchrank FROM addonsearch WHERE addonsearch MATCH '%s' "
+                            "UNION ALL SELECT docid, 2 AS searchrank FROM addonsearch WHERE addonsearch MATCH '%s'"
+                            ") AS hits JOIN addon ON addon.id = hits.docid "
+                            "GROUP BY addon.addonID ORDER BY searchrank, MIN(addon.name)",
+                            inName.c_str(), inSummary.c_str(), anywhere.c_str());
+      }
+      else
+      {
+        std::string query;
+        for (const auto& w : words)
+          query += " +" + w + "*";
+
+        strSQL = PrepareSQL("SELECT addonID, MIN(CASE WHEN MATCH(name) AGAINST('%s' IN BOOLEAN MODE) THEN 0 "
+                            "WHEN MATCH(summary) AGAINST('%s' IN BOOLEAN MODE) THEN 1 ELSE 2 END) AS searchrank "
+                            "FROM addon WHERE MATCH(name, summary, description) AGAINST('%s' IN BOOLEAN MODE) "
+                            "GROUP BY addonID ORDER BY searchrank, MIN(name)",
+                            query.c_str(), query.c_str(), query.c_str());
+      }
+    }
+    else
+      strSQL = PrepareSQL("SELECT addonID FROM addon WHERE name LIKE '%%%s%%' OR summary LIKE '%%%s%%' OR description LIKE '%%%s%%'", search.c_str(), search.c_str(), search.c_str());
     CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
 
+    auto start = XbmcThreads::SystemClockMillis();
     if (!m_pDS->query(strSQL)) return false;
     if (m_pDS->num_rows() == 0) return false;
 
     while (!m_pDS->eof())
     {
       AddonPtr addon;
-      GetAddon(m_pDS->fv(0).get_asString(),addon);
-      if (addon->Type() >= ADDON_UNKNOWN+1 && addon->Type() < ADDON_SCRAPER_LIBRARY)
+      if (GetAddon(m_pDS->fv(0).get_asString(), addon) &&
+          addon->Type() >= ADDON_UNKNOWN+1 && addon->Type() < ADDON_SCRAPER_LIBRARY)
         addons.push_back(addon);
       m_pDS->next();
     }
     m_pDS->close();
+    CLog::Log(LOGDEBUG, "%s took %i ms", __FUNCTION__, XbmcThreads::SystemClockMillis() - start);
     return true;
   }
   catch (...)
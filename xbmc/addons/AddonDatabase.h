@@ -51,11 +51,35 @@ public:
   /*! Get the most recent version for an add-on and the repo id it belongs to*/
   std::pair<ADDON::AddonVersion, std::string> GetAddonVersion(const std::string &id);
 
-  int AddRepository(const std::string& id, const ADDON::VECADDONS& addons, const std::string& checksum, const ADDON::AddonVersion& version);
+  /*!
+   \brief Update the stored content of a repository to the given add-ons.
+   Add-ons that are stored already are left untouched, only those that were added,
+   removed or changed are written.
+   \param id id of the repository
+   \param version version of the repository
+   \param checksum checksum of the new content
+   \param addons the add-ons of the directories that changed
+   \param unchangedDirs the data directories whose add-ons are kept as they are
+   \param updated [out] the add-ons that replaced a stored add-on with the same id
+   \return id of the repository, -1 on error.
+   */
+  int UpdateRepositoryContent(const std::string& id, const ADDON::AddonVersion& version,
+      const std::string& checksum, const ADDON::VECADDONS& addons,
+      const std::vector<std::string>& unchangedDirs, ADDON::VECADDONS& updated);
   void DeleteRepository(const std::string& id);
   void DeleteRepository(int id);
   int GetRepoChecksum(const std::string& id, std::string& checksum);
 
+  /*!
+   \brief Get the validators of the last fetched index of a repository directory.
+   \param idRepo id of the repository
+   \param url url of the index
+   \return true if the index was fetched before, false otherwise.
+   \sa SetIndexValidators
+   */
+  bool GetIndexValidators(int idRepo, const std::string& url, std::string& etag, std::string& lastModified);
+  void SetIndexValidators(int idRepo, const std::string& url, const std::string& etag, const std::string& lastModified);
+
   /*!
    \brief Get addons in repository `id`
    \param id id of the repository
@@ -71,6 +95,14 @@ public:
    */
   std::pair<CDateTime, ADDON::AddonVersion> LastChecked(const std::string& id);
 
+  /*!
+   \brief Search the name, summary and description of the add-ons in the repositories
+   Words are matched by prefix. Add-ons matching in their name come first, followed by the
+   ones matching in their summary and then the ones matching anywhere.
+   \param search the words to search for
+   \param items [out] the matching add-ons
+   \return true if add-ons were found, false otherwise.
+   */
   bool Search(const std::string& search, ADDON::VECADDONS& items);
   static void SetPropertiesFromAddon(const ADDON::AddonPtr& addon, CFileItemPtr& item); 
 
@@ -151,11 +183,19 @@ protected:
   virtual void CreateAnalytics();
   virtual void UpdateTables(int version);
   virtual int GetMinSchemaVersion() const { return 15; }
-  virtual int GetSchemaVersion() const { return 20; }
+  virtual int GetSchemaVersion() const { return 22; }
   const char *GetBaseDBName() const { return "Addons"; }
 
   bool GetAddon(int id, ADDON::AddonPtr& addon);
 
+  /*! \brief Create the full-text index used by Search.
+   The index is kept up to date by the database, it is left out if the database doesn't support it.
+   */
+  void CreateSearchIndex();
+  bool HasSearchIndex();
+
+  bool m_hasSearchIndex;
+
   /* keep in sync with the select in GetAddon */
   enum AddonFields
   {
@@ -174,6 +214,7 @@ protected:
     addon_author,
     addon_disclaimer,
     addon_minversion,
+    addon_digest,
     broken_reason,
     addonextra_key,
     addonextra_value,
@@ -20,6 +20,8 @@
 
 #include "AddonManager.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <utility>
 
@@ -56,6 +58,7 @@
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/XBMCTinyXML.h"
+#include "utils/XMLElementReader.h"
 
 #ifdef HAS_VISUALISATION
 #include "Visualisation.h"
@@ -237,7 +240,8 @@ bool CAddonMgr::CheckUserDirs(const cp_cfg_element_t *settings)
 }
 
 CAddonMgr::CAddonMgr() :
-  m_cp_context(nullptr)
+  m_cp_context(nullptr),
+  m_snapshotInfo(nullptr)
 {
 }
 
@@ -323,6 +327,10 @@ bool CAddonMgr::Init()
     return false;
   }
 
+  // descriptors of add-ons that didn't change since the last run don't need to be parsed again
+  m_manifestCache.Load();
+  cp_set_descriptor_loader(m_cp_context, CAddonManifestCache::LoadDescriptor, &m_manifestCache);
+
   FindAddons();
 
   // disable some system addons by default because they are optional
@@ -363,7 +371,9 @@ bool CAddonMgr::Init()
 
 void CAddonMgr::DeInit()
 {
+  ClearSnapshot();
   cp_destroy();
+  m_cp_context = nullptr;
   m_database.Close();
   m_disabled.clear();
 }
@@ -483,41 +493,87 @@ bool CAddonMgr::GetDisabledAddons(VECADDONS& addons, const TYPE& type)
   return false;
 }
 
-static cp_extension_t* GetFirstExtPoint(cp_plugin_info_t* addon, TYPE type)
+bool CAddonMgr::LoadSnapshot()
 {
-  for (unsigned int i = 0; i < addon->num_extensions; ++i)
+  if (m_snapshotInfo)
+    return true;
+  if (!m_cp_context)
+    return false;
+
+  cp_status_t status;
+  int num;
+  m_snapshotInfo = cp_get_plugins_info(m_cp_context, &status, &num);
+  if (!m_snapshotInfo)
+    return false;
+
+  m_snapshot.reserve(num);
+  for (int i = 0; i < num; i++)
   {
-    cp_extension_t* ext = &addon->extensions[i];
-    if (strcmp(ext->ext_point_id, "kodi.addon.metadata") == 0 || strcmp(ext->ext_point_id, "xbmc.addon.metadata") == 0)
-      continue;
+    SnapshotPlugin plugin;
+    plugin.info = m_snapshotInfo[i];
+    for (unsigned int j = 0; j < plugin.info->num_extensions; ++j)
+    {
+      const cp_extension_t* ext = &plugin.info->extensions[j];
+      if (strcmp(ext->ext_point_id, "kodi.addon.metadata") == 0 || strcmp(ext->ext_point_id, "xbmc.addon.metadata") == 0)
+        continue;
 
-    if (type == ADDON_UNKNOWN)
-      return ext;
+      SnapshotExtension extension = { ext, TranslateType(ext->ext_point_id), false, AddonPtr() };
+      plugin.extensions.push_back(extension);
+    }
+    m_snapshotIndex[plugin.info->identifier] = m_snapshot.size();
+    m_snapshot.push_back(plugin);
+  }
+  return true;
+}
+
+void CAddonMgr::ClearSnapshot()
+{
+  m_snapshot.clear();
+  m_snapshotIndex.clear();
+  if (m_snapshotInfo)
+  {
+    cp_release_info(m_cp_context, m_snapshotInfo);
+    m_snapshotInfo = nullptr;
+  }
+}
+
+AddonPtr CAddonMgr::GetSnapshotAddon(SnapshotExtension &extension)
+{
+  switch (extension.type)
+  {
+    // these don't implement Clone() (or lose their type when cloned), create them from scratch
+    case ADDON_VIZ:
+    case ADDON_PVRDLL:
+    case ADDON_ADSPDLL:
+    case ADDON_CONTEXT_ITEM:
+      return Factory(extension.extension);
+    default:
+      break;
+  }
 
-    if (type == TranslateType(ext->ext_point_id))
-      return ext;
+  if (!extension.created)
+  {
+    extension.addon = Factory(extension.extension);
+    extension.created = true;
   }
-  return nullptr;
+  return extension.addon ? extension.addon->Clone() : AddonPtr();
 }
 
 bool CAddonMgr::GetAddonsInternal(const TYPE &type, VECADDONS &addons, bool enabledOnly)
 {
   CSingleLock lock(m_critSection);
-  if (!m_cp_context)
+  if (!LoadSnapshot())
     return false;
-  cp_status_t status;
-  int num;
-  std::string ext_point(TranslateType(type));
-  cp_plugin_info_t **cpaddons = cp_get_plugins_info(m_cp_context, &status, &num);
 
-  for(int i=0; i <num; i++)
+  for (auto &plugin : m_snapshot)
   {
-    cp_extension_t *props = GetFirstExtPoint(cpaddons[i], type);
-    if (props == nullptr)
+    auto extension = std::find_if(plugin.extensions.begin(), plugin.extensions.end(),
+        [&type](const SnapshotExtension& ext){ return type == ADDON_UNKNOWN || type == ext.type; });
+    if (extension == plugin.extensions.end())
       continue;
-    if (enabledOnly && IsAddonDisabled(cpaddons[i]->identifier))
+    if (enabledOnly && IsAddonDisabled(plugin.info->identifier))
       continue;
-    AddonPtr addon(Factory(props));
+    AddonPtr addon(GetSnapshotAddon(*extension));
     if (addon)
     {
       // if the addon has a running instance, grab that
@@ -527,37 +583,43 @@ bool CAddonMgr::GetAddonsInternal(const TYPE &type, VECADDONS &addons, bool enab
       addons.push_back(addon);
     }
   }
-  cp_release_info(m_cp_context, cpaddons);
   return addons.size() > 0;
 }
 
 bool CAddonMgr::GetAddon(const std::string &str, AddonPtr &addon, const TYPE &type/*=ADDON_UNKNOWN*/, bool enabledOnly /*= true*/)
 {
   CSingleLock lock(m_critSection);
+  if (!LoadSnapshot())
+    return false;
 
-  cp_status_t status;
-  cp_plugin_info_t *cpaddon = cp_get_plugin_info(m_cp_context, str.c_str(), &status);
-  if (status == CP_OK && cpaddon)
+  auto it = m_snapshotIndex.find(str);
+  if (it == m_snapshotIndex.end())
+    return false;
+
+  SnapshotPlugin &plugin = m_snapshot[it->second];
+  if (!plugin.info->extensions && type == ADDON_UNKNOWN)
+  { // no extensions, so we need only the dep information
+    addon = AddonPtr(new CAddon(plugin.info));
+  }
+  else
   {
-    addon = GetAddonFromDescriptor(cpaddon, type==ADDON_UNKNOWN?"":TranslateType(type));
-    cp_release_info(m_cp_context, cpaddon);
+    const std::string extPoint = type == ADDON_UNKNOWN ? "" : TranslateType(type);
+    auto extension = std::find_if(plugin.extensions.begin(), plugin.extensions.end(),
+        [&extPoint](const SnapshotExtension& ext){ return extPoint.empty() || extPoint == ext.extension->ext_point_id; });
+    addon = extension != plugin.extensions.end() ? GetSnapshotAddon(*extension) : AddonPtr();
+  }
 
-    if (addon)
-    {
-      if (enabledOnly && IsAddonDisabled(addon->ID()))
-        return false;
+  if (addon)
+  {
+    if (enabledOnly && IsAddonDisabled(addon->ID()))
+      return false;
 
-      // if the addon has a running instance, grab that
-      AddonPtr runningAddon = addon->GetRunningInstance();
-      if (runningAddon)
-        addon = runningAddon;
-    }
-    return NULL != addon.get();
+    // if the addon has a running instance, grab that
+    AddonPtr runningAddon = addon->GetRunningInstance();
+    if (runningAddon)
+      addon = runningAddon;
   }
-  if (cpaddon)
-    cp_release_info(m_cp_context, cpaddon);
-
-  return false;
+  return NULL != addon.get();
 }
 
 //TODO handle all 'default' cases here, not just scrapers & vizs
@@ -658,7 +720,9 @@ void CAddonMgr::FindAddons()
     CSingleLock lock(m_critSection);
     if (m_cp_context)
     {
+      ClearSnapshot();
       cp_scan_plugins(m_cp_context, CP_SP_UPGRADE);
+      m_manifestCache.Save();
       SetChanged();
     }
   }
@@ -671,6 +735,7 @@ void CAddonMgr::UnregisterAddon(const std::string& ID)
   m_disabled.erase(ID);
   if (m_cp_context)
   {
+    ClearSnapshot();
     cp_uninstall_plugin(m_cp_context,ID.c_str());
     SetChanged();
     lock.Leave();
@@ -1104,25 +1169,28 @@ bool CAddonMgr::LoadAddonDescription(const std::string &path, AddonPtr &addon)
   return false;
 }
 
-bool CAddonMgr::AddonsFromRepoXML(const TiXmlElement *root, VECADDONS &addons)
+bool CAddonMgr::AddonsFromRepoXML(const std::string &xml, VECADDONS &addons)
 {
   // create a context for these addons
   cp_status_t status;
   cp_context_t *context = cp_create_context(&status);
-  if (!root || !context)
+  if (!context)
     return false;
 
-  // each addon XML should have a UTF-8 declaration
-  TiXmlDeclaration decl("1.0", "UTF-8", "");
-  const TiXmlElement *element = root->FirstChildElement("addon");
-  while (element)
+  // the index is handed to c-pluff one add-on at a time, there's no need to parse it as a whole
+  CXMLElementReader reader(xml);
+  std::string name;
+  const char *element;
+  size_t length;
+  while (reader.Next(name, element, length))
   {
-    // dump the XML back to text
-    std::string xml;
-    xml << decl;
-    xml << *element;
-    cp_status_t status;
-    cp_plugin_info_t *info = cp_load_plugin_descriptor_from_memory(context, xml.c_str(), xml.size(), &status);
+    if (name != "addon")
+      continue;
+
+    // keep the declaration, it has the encoding of the index
+    std::string descriptor(reader.GetDeclaration());
+    descriptor.append(element, length);
+    cp_plugin_info_t *info = cp_load_plugin_descriptor_from_memory(context, descriptor.c_str(), descriptor.size(), &status);
     if (info)
     {
       AddonPtr addon = GetAddonFromDescriptor(info);
@@ -1130,10 +1198,9 @@ bool CAddonMgr::AddonsFromRepoXML(const TiXmlElement *root, VECADDONS &addons)
         addons.push_back(addon);
       cp_release_info(context, info);
     }
-    element = element->NextSiblingElement("addon");
   }
   cp_destroy_context(context);
-  return true;
+  return !reader.Failed();
 }
 
 bool CAddonMgr::LoadAddonDescriptionFromMemory(const TiXmlElement *root, AddonPtr &addon)
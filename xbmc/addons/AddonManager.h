@@ -26,6 +26,7 @@
 #include <map>
 #include <deque>
 #include "AddonDatabase.h"
+#include "AddonManifestCache.h"
 
 extern "C"
 {
@@ -221,11 +222,11 @@ namespace ADDON
 
     /*! \brief Parse a repository XML file for addons and load their descriptors
      A repository XML is essentially a concatenated list of addon descriptors.
-     \param root Root element of an XML document.
+     \param xml the content of the repository XML file.
      \param addons [out] returned list of addons.
      \return true if the repository XML file is parsed, false otherwise.
      */
-    bool AddonsFromRepoXML(const TiXmlElement *root, VECADDONS &addons);
+    bool AddonsFromRepoXML(const std::string &xml, VECADDONS &addons);
 
     /*! \brief Start all services addons.
         \return True is all addons are started, false otherwise
@@ -263,6 +264,33 @@ namespace ADDON
 
     bool GetAddonsInternal(const TYPE &type, VECADDONS &addons, bool enabledOnly);
 
+    struct SnapshotExtension
+    {
+      const cp_extension_t *extension;
+      TYPE type;
+      bool created;
+      AddonPtr addon; //!< NULL if the add-on isn't supported on this platform
+    };
+
+    struct SnapshotPlugin
+    {
+      const cp_plugin_info_t *info;
+      std::vector<SnapshotExtension> extensions; //!< excluding the metadata extension point
+    };
+
+    /*! \brief Retrieve the installed plug-ins from c-pluff unless they were retrieved since the last scan.
+     The add-ons are created from the plug-in descriptors once and copied for every query, instead of
+     creating every add-on of every plug-in on every query.
+     \return true if the plug-ins are available, false otherwise.
+     */
+    bool LoadSnapshot();
+    void ClearSnapshot();
+
+    /*! \brief Retrieve a copy of the add-on of a plug-in extension.
+     Add-ons hold per-instance state (e.g. settings), so callers never share the instance kept in the snapshot.
+     */
+    AddonPtr GetSnapshotAddon(SnapshotExtension &extension);
+
     // private construction, and no assignements; use the provided singleton methods
     CAddonMgr();
     CAddonMgr(const CAddonMgr&);
@@ -274,6 +302,11 @@ namespace ADDON
     static std::map<TYPE, IAddonMgrCallback*> m_managers;
     CCriticalSection m_critSection;
     CAddonDatabase m_database;
+    CAddonManifestCache m_manifestCache;
+
+    cp_plugin_info_t **m_snapshotInfo;
+    std::vector<SnapshotPlugin> m_snapshot;
+    std::map<std::string, size_t> m_snapshotIndex;
   };
 
 }; /* namespace ADDON */
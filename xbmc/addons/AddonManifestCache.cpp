@@ -0,0 +1,216 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AddonManifestCache.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "filesystem/File.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+
+#define MANIFEST_CACHE_PATH   "special://temp/addonmanifests.dat"
+#define MANIFEST_CACHE_MAGIC  "AMC2"
+
+namespace
+{
+  template<typename T>
+  void Append(std::string &buffer, T value)
+  {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void AppendString(std::string &buffer, const std::string &value)
+  {
+    Append(buffer, static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+  }
+
+  template<typename T>
+  bool Extract(const char *&data, const char *end, T &value)
+  {
+    if (end - data < static_cast<ptrdiff_t>(sizeof(value)))
+      return false;
+
+    memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+  }
+
+  bool ExtractString(const char *&data, const char *end, std::string &value)
+  {
+    uint32_t size;
+    if (!Extract(data, end, size) || end - data < static_cast<ptrdiff_t>(size))
+      return false;
+
+    value.assign(data, size);
+    data += size;
+    return true;
+  }
+}
+
+namespace ADDON
+{
+
+CAddonManifestCache::CAddonManifestCache()
+  : m_modified(false)
+{ }
+
+void CAddonManifestCache::Load()
+{
+  m_entries.clear();
+  m_modified = false;
+
+  XFILE::CFile file;
+  XFILE::auto_buffer buffer;
+  if (!XFILE::CFile::Exists(MANIFEST_CACHE_PATH) || file.LoadFile(MANIFEST_CACHE_PATH, buffer) <= 0)
+    return;
+
+  const char *data = buffer.get();
+  const char *end = data + buffer.size();
+
+  uint32_t count;
+  if (buffer.size() < 4 || memcmp(data, MANIFEST_CACHE_MAGIC, 4) != 0)
+    return;
+  data += 4;
+  if (!Extract(data, end, count))
+    return;
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string path;
+    Entry entry;
+    if (!ExtractString(data, end, path) ||
+        !Extract(data, end, entry.crc) ||
+        !Extract(data, end, entry.size) ||
+        !ExtractString(data, end, entry.descriptor))
+    {
+      CLog::Log(LOGWARNING, "CAddonManifestCache::%s - discarding corrupt cache", __FUNCTION__);
+      m_entries.clear();
+      m_modified = true;
+      return;
+    }
+    entry.used = false;
+    m_entries.insert(std::make_pair(path, entry));
+  }
+
+  CLog::Log(LOGDEBUG, "CAddonManifestCache::%s - loaded %u add-on descriptors", __FUNCTION__, count);
+}
+
+void CAddonManifestCache::Save()
+{
+  for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); )
+  {
+    // the add-on was removed
+    if (!it->second.used)
+    {
+      m_entries.erase(it++);
+      m_modified = true;
+    }
+    else
+      ++it;
+  }
+
+  if (!m_modified)
+    return;
+
+  std::string buffer(MANIFEST_CACHE_MAGIC);
+  Append(buffer, static_cast<uint32_t>(m_entries.size()));
+  for (std::map<std::string, Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    AppendString(buffer, it->first);
+    Append(buffer, it->second.crc);
+    Append(buffer, it->second.size);
+    AppendString(buffer, it->second.descriptor);
+  }
+
+  // write to a temporary file first so the cache is never read while it is only partially written
+  const std::string tempPath = MANIFEST_CACHE_PATH ".tmp";
+  XFILE::CFile file;
+  if (!file.OpenForWrite(tempPath, true))
+    return;
+
+  bool success = file.Write(buffer.c_str(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+  file.Close();
+
+  if (!success || !XFILE::CFile::Rename(tempPath, MANIFEST_CACHE_PATH))
+  {
+    XFILE::CFile::Delete(tempPath);
+    return;
+  }
+
+  m_modified = false;
+}
+
+cp_plugin_info_t* CAddonManifestCache::LoadDescriptor(cp_context_t *context, const char *path, cp_status_t *status, void *userData)
+{
+  return static_cast<CAddonManifestCache*>(userData)->Get(context, path, status);
+}
+
+cp_plugin_info_t* CAddonManifestCache::Get(cp_context_t *context, const std::string &path, cp_status_t *status)
+{
+  XFILE::CFile file;
+  XFILE::auto_buffer manifest;
+  if (file.LoadFile(URIUtils::AddFileToFolder(path, "addon.xml"), manifest) <= 0)
+  {
+    // not an add-on folder, let c-pluff report it
+    return cp_load_plugin_descriptor(context, path.c_str(), status);
+  }
+
+  Crc32 crc;
+  crc.Compute(manifest.get(), manifest.size());
+
+  std::map<std::string, Entry>::iterator it = m_entries.find(path);
+  if (it != m_entries.end())
+  {
+    Entry &entry = it->second;
+    if (entry.crc == static_cast<uint32_t>(crc) && entry.size == static_cast<int64_t>(manifest.size()))
+    {
+      cp_plugin_info_t *info = cp_load_plugin_descriptor_from_serialized(context, path.c_str(),
+          entry.descriptor.c_str(), entry.descriptor.size(), status);
+      if (info)
+      {
+        entry.used = true;
+        return info;
+      }
+    }
+    m_entries.erase(it);
+    m_modified = true;
+  }
+
+  cp_plugin_info_t *info = cp_load_plugin_descriptor(context, path.c_str(), status);
+  if (!info)
+    return NULL;
+
+  Entry entry;
+  entry.crc = crc;
+  entry.size = manifest.size();
+  entry.descriptor.resize(cp_serialize_plugin_descriptor(info, NULL, 0));
+  cp_serialize_plugin_descriptor(info, &entry.descriptor[0], entry.descriptor.size());
+  entry.used = true;
+  m_entries.insert(std::make_pair(path, entry));
+  m_modified = true;
+
+  return info;
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+extern "C"
+{
+#include "cpluff.h"
+}
+
+namespace ADDON
+{
+  /*!
+   \brief Keeps the parsed add-on descriptors across restarts.
+
+   Every start used to parse the addon.xml of each installed add-on. The cache
+   stores the descriptors parsed by c-pluff in its binary form, keyed by the
+   add-on folder and checked against the size and checksum of its addon.xml,
+   so only new or changed descriptors are parsed again. Reading the manifests
+   is cheap compared to parsing them, and unlike modification times checksums
+   also catch edits which don't change the time or size of the file.
+
+   The cache is installed as the descriptor loader of the c-pluff context and
+   isn't thread safe, plug-in scans are serialized by the add-on manager.
+   */
+  class CAddonManifestCache
+  {
+  public:
+    CAddonManifestCache();
+
+    /*!
+     \brief Load the cache stored by an earlier run.
+     */
+    void Load();
+
+    /*!
+     \brief Store the cache if descriptors were added or changed since it was loaded.
+     Entries of add-ons that weren't seen by the last scan are dropped.
+     */
+    void Save();
+
+    /*!
+     \brief Descriptor loader to pass to cp_set_descriptor_loader.
+     \param userData the CAddonManifestCache instance
+     */
+    static cp_plugin_info_t* LoadDescriptor(cp_context_t *context, const char *path, cp_status_t *status, void *userData);
+
+  private:
+    struct Entry
+    {
+      uint32_t crc;
+      int64_t size;
+      std::string descriptor;
+      bool used;
+    };
+
+    cp_plugin_info_t* Get(cp_context_t *context, const std::string &path, cp_status_t *status);
+
+    std::map<std::string, Entry> m_entries;
+    bool m_modified;
+  };
+}
@@ -20,7 +20,9 @@
 
 #include "Repository.h"
 
+#include <algorithm>
 #include <iterator>
+#include <sstream>
 #include <utility>
 
 #include "addons/AddonDatabase.h"
@@ -46,7 +48,6 @@
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
-#include "utils/XBMCTinyXML.h"
 
 using namespace XFILE;
 using namespace ADDON;
@@ -166,14 +167,27 @@ std::string CRepository::GetAddonHash(const AddonPtr& addon) const
   }
 
 
-bool CRepository::FetchIndex(const std::string& url, VECADDONS& addons)
+CRepository::FetchStatus CRepository::FetchIndex(const std::string& url, IndexValidators& validators, VECADDONS& addons)
 {
   XFILE::CCurlFile http;
   http.SetContentEncoding("gzip");
+  if (!validators.etag.empty())
+    http.SetRequestHeader("If-None-Match", validators.etag);
+  if (!validators.lastModified.empty())
+    http.SetRequestHeader("If-Modified-Since", validators.lastModified);
 
   std::string content;
   if (!http.Get(url, content))
-    return false;
+    return STATUS_ERROR;
+
+  if (http.GetResponseCode() == 304)
+  {
+    CLog::Log(LOGDEBUG, "CRepository '%s' not modified", url.c_str());
+    return STATUS_NOT_MODIFIED;
+  }
+
+  validators.etag = http.GetHttpHeader().GetValue("etag");
+  validators.lastModified = http.GetHttpHeader().GetValue("last-modified");
 
   if (URIUtils::HasExtension(url, ".gz")
       || CMime::GetFileTypeFromMime(http.GetMimeType()) == CMime::EFileType::FileTypeGZip)
@@ -181,24 +195,23 @@ bool CRepository::FetchIndex(const std::string& url, VECADDONS& addons)
     CLog::Log(LOGDEBUG, "CRepository '%s' is gzip. decompressing", url.c_str());
     std::string buffer;
     if (!CZipFile::DecompressGzip(content, buffer))
-      return false;
+      return STATUS_ERROR;
     content = std::move(buffer);
   }
 
-  CXBMCTinyXML doc;
-  if (!doc.Parse(content) || !doc.RootElement()
-      || !CAddonMgr::GetInstance().AddonsFromRepoXML(doc.RootElement(), addons))
+  if (!CAddonMgr::GetInstance().AddonsFromRepoXML(content, addons))
   {
     CLog::Log(LOGERROR, "CRepository: Failed to parse addons.xml. Malformated.");
-    return false;
+    return STATUS_ERROR;
   }
-  return true;
+  return STATUS_OK;
 }
 
-bool CRepository::Parse(const DirInfo& dir, VECADDONS& addons)
+CRepository::FetchStatus CRepository::Parse(const DirInfo& dir, IndexValidators& validators, VECADDONS& addons)
 {
-  if (!FetchIndex(dir.info, addons))
-    return false;
+  FetchStatus status = FetchIndex(dir.info, validators, addons);
+  if (status != STATUS_OK)
+    return status;
 
     for (IVECADDONS i = addons.begin(); i != addons.end(); ++i)
     {
@@ -220,7 +233,7 @@ bool CRepository::Parse(const DirInfo& dir, VECADDONS& addons)
         SET_IF_NOT_EMPTY(addon->Props().fanart,URIUtils::AddFileToFolder(dir.datadir,addon->ID()+"/fanart.jpg"))
       }
     }
-  return true;
+  return STATUS_OK;
 }
 
 
@@ -234,51 +247,59 @@ bool CRepositoryUpdateJob::DoWork()
   database.Open();
 
   std::string oldChecksum;
-  if (database.GetRepoChecksum(m_repo->ID(), oldChecksum) == -1)
+  int idRepo = database.GetRepoChecksum(m_repo->ID(), oldChecksum);
+  if (idRepo == -1)
     oldChecksum = "";
 
   std::string newChecksum;
   VECADDONS addons;
-  auto status = FetchIfChanged(oldChecksum, newChecksum, addons);
+  std::vector<std::string> unchangedDirs;
+  std::map<std::string, CRepository::IndexValidators> validators;
+  auto status = FetchIfChanged(database, idRepo, oldChecksum, newChecksum, addons, unchangedDirs, validators);
 
   database.SetLastChecked(m_repo->ID(), m_repo->Version(),
       CDateTime::GetCurrentDateTime().GetAsDBDateTime());
 
   MarkFinished();
 
-  if (status == STATUS_ERROR)
+  if (status == CRepository::STATUS_ERROR)
     return false;
 
-  if (status == STATUS_NOT_MODIFIED)
+  if (status == CRepository::STATUS_NOT_MODIFIED)
   {
     CLog::Log(LOGDEBUG, "CRepositoryUpdateJob[%s] checksum not changed.", m_repo->ID().c_str());
     return true;
   }
 
-  //Invalidate art.
+  VECADDONS updated;
+  idRepo = database.UpdateRepositoryContent(m_repo->ID(), m_repo->Version(), newChecksum,
+      addons, unchangedDirs, updated);
+  if (idRepo == -1)
+    return false;
+
+  // only remember the validators once the content they stand for is stored
+  for (const auto& it : validators)
+    database.SetIndexValidators(idRepo, it.first, it.second.etag, it.second.lastModified);
+
+  //Invalidate art of the add-ons that got replaced by a new version.
+  if (!updated.empty())
   {
     CTextureDatabase textureDB;
     textureDB.Open();
     textureDB.BeginMultipleExecute();
 
-    for (const auto& addon : addons)
+    for (const auto& addon : updated)
     {
-      AddonPtr oldAddon;
-      if (database.GetAddon(addon->ID(), oldAddon) && addon->Version() > oldAddon->Version())
-      {
-        if (!addon->Props().icon.empty() || !addon->Props().fanart.empty())
-          CLog::Log(LOGDEBUG, "CRepository: invalidating cached art for '%s'", addon->ID().c_str());
-        if (!addon->Props().icon.empty())
-          textureDB.InvalidateCachedTexture(addon->Props().icon);
-        if (!addon->Props().fanart.empty())
-          textureDB.InvalidateCachedTexture(addon->Props().fanart);
-      }
+      if (!addon->Props().icon.empty() || !addon->Props().fanart.empty())
+        CLog::Log(LOGDEBUG, "CRepository: invalidating cached art for '%s'", addon->ID().c_str());
+      if (!addon->Props().icon.empty())
+        textureDB.InvalidateCachedTexture(addon->Props().icon);
+      if (!addon->Props().fanart.empty())
+        textureDB.InvalidateCachedTexture(addon->Props().fanart);
     }
     textureDB.CommitMultipleExecute();
   }
 
-  database.AddRepository(m_repo->ID(), addons, newChecksum, m_repo->Version());
-
   //Update broken status
   database.BeginMultipleExecute();
   for (const auto& addon : addons)
@@ -298,10 +319,10 @@ bool CRepositoryUpdateJob::DoWork()
     if (!depsMet && addon->Props().broken.empty())
       addon->Props().broken = "DEPSNOTMET";
 
+    const std::string brokenInDb = database.IsAddonBroken(addon->ID());
     if (localAddon)
     {
-      bool brokenInDb = !database.IsAddonBroken(addon->ID()).empty();
-      if (!addon->Props().broken.empty() && !brokenInDb)
+      if (!addon->Props().broken.empty() && brokenInDb.empty())
       {
         //newly broken
         int line = 24096;
@@ -318,7 +339,7 @@ bool CRepositoryUpdateJob::DoWork()
 
         CEventLog::GetInstance().Add(EventPtr(new CAddonManagementEvent(addon, 24096)));
       }
-      else if (addon->Props().broken.empty() && brokenInDb)
+      else if (addon->Props().broken.empty() && !brokenInDb.empty())
       {
         //Unbroken
         CLog::Log(LOGDEBUG, "CRepositoryUpdateJob[%s] addon '%s' unbroken",
@@ -327,14 +348,16 @@ bool CRepositoryUpdateJob::DoWork()
     }
 
     //Update broken status
-    database.BreakAddon(addon->ID(), addon->Props().broken);
+    if (addon->Props().broken != brokenInDb)
+      database.BreakAddon(addon->ID(), addon->Props().broken);
   }
   database.CommitMultipleExecute();
   return true;
 }
 
-CRepositoryUpdateJob::FetchStatus CRepositoryUpdateJob::FetchIfChanged(const std::string& oldChecksum,
-    std::string& checksum, VECADDONS& addons)
+CRepository::FetchStatus CRepositoryUpdateJob::FetchIfChanged(CAddonDatabase& database, int idRepo,
+    const std::string& oldChecksum, std::string& checksum, VECADDONS& addons,
+    std::vector<std::string>& unchangedDirs, std::map<std::string, CRepository::IndexValidators>& validators)
 {
   SetText(StringUtils::Format(g_localizeStrings.Get(24093).c_str(), m_repo->Name().c_str()));
   const unsigned int total = m_repo->m_dirs.size() * 2;
@@ -345,38 +368,77 @@ CRepositoryUpdateJob::FetchStatus CRepositoryUpdateJob::FetchIfChanged(const std
     if (!it->checksum.empty())
     {
       if (ShouldCancel(std::distance(m_repo->m_dirs.cbegin(), it), total))
-        return STATUS_ERROR;
+        return CRepository::STATUS_ERROR;
 
       auto dirsum = CRepository::FetchChecksum(it->checksum);
       if (dirsum.empty())
       {
         CLog::Log(LOGERROR, "CRepositoryUpdateJob[%s] failed read checksum for "
             "directory '%s'", m_repo->ID().c_str(), it->info.c_str());
-        return STATUS_ERROR;
+        return CRepository::STATUS_ERROR;
       }
       checksum += dirsum;
     }
   }
 
   if (oldChecksum == checksum && !oldChecksum.empty())
-    return STATUS_NOT_MODIFIED;
+    return CRepository::STATUS_NOT_MODIFIED;
 
+  std::vector<std::string> modifiedDirs;
+  std::vector<const CRepository::DirInfo*> notModified;
   for (auto it = m_repo->m_dirs.cbegin(); it != m_repo->m_dirs.cend(); ++it)
   {
     if (ShouldCancel(m_repo->m_dirs.size() + std::distance(m_repo->m_dirs.cbegin(), it), total))
-      return STATUS_ERROR;
+      return CRepository::STATUS_ERROR;
+
+    CRepository::IndexValidators& dirValidators = validators[it->info];
+    if (idRepo != -1)
+      database.GetIndexValidators(idRepo, it->info, dirValidators.etag, dirValidators.lastModified);
 
     VECADDONS tmp;
-    if (!CRepository::Parse(*it, tmp))
+    auto status = CRepository::Parse(*it, dirValidators, tmp);
+    if (status == CRepository::STATUS_ERROR)
     {
       CLog::Log(LOGERROR, "CRepositoryUpdateJob[%s] failed to read or parse "
           "directory '%s'", m_repo->ID().c_str(), it->info.c_str());
-      return STATUS_ERROR;
+      return CRepository::STATUS_ERROR;
+    }
+    if (status == CRepository::STATUS_NOT_MODIFIED)
+    {
+      notModified.push_back(&*it);
+      continue;
+    }
+    modifiedDirs.push_back(it->datadir);
+    addons.insert(addons.end(), tmp.begin(), tmp.end());
+  }
+
+  for (const auto* dir : notModified)
+  {
+    // the stored add-ons are told apart by their data directory. If it overlaps with
+    // the one of a changed index, the add-ons of both have to be fetched.
+    const bool overlaps = std::any_of(modifiedDirs.begin(), modifiedDirs.end(),
+        [dir](const std::string& datadir)
+        {
+          return URIUtils::IsInPath(datadir, dir->datadir) || URIUtils::IsInPath(dir->datadir, datadir);
+        });
+    if (!overlaps)
+    {
+      unchangedDirs.push_back(dir->datadir);
+      continue;
+    }
+
+    CRepository::IndexValidators& dirValidators = validators[dir->info];
+    dirValidators = CRepository::IndexValidators();
+    VECADDONS tmp;
+    if (CRepository::Parse(*dir, dirValidators, tmp) != CRepository::STATUS_OK)
+    {
+      CLog::Log(LOGERROR, "CRepositoryUpdateJob[%s] failed to read or parse "
+          "directory '%s'", m_repo->ID().c_str(), dir->info.c_str());
+      return CRepository::STATUS_ERROR;
     }
     addons.insert(addons.end(), tmp.begin(), tmp.end());
   }
 
   SetProgress(total, total);
-  return STATUS_OK;
+  return CRepository::STATUS_OK;
 }
-
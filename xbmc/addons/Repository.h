@@ -19,10 +19,16 @@
  *
  */
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "Addon.h"
 #include "utils/Job.h"
 #include "utils/ProgressJob.h"
 
+class CAddonDatabase;
+
 namespace ADDON
 {
   class CRepository : public CAddon
@@ -54,13 +60,35 @@ namespace ADDON
     typedef std::vector<DirInfo> DirList;
     DirList m_dirs;
 
-    static bool Parse(const DirInfo& dir, VECADDONS& addons);
+    enum FetchStatus
+    {
+      STATUS_OK,
+      STATUS_NOT_MODIFIED,
+      STATUS_ERROR
+    };
+
+    /*! \brief The validators (ETag and Last-Modified) the server sent along with an index.
+     */
+    struct IndexValidators
+    {
+      std::string etag;
+      std::string lastModified;
+    };
+
+    /*! \brief Fetch and parse the index of a directory.
+     \param dir the directory.
+     \param validators [in,out] the validators of the index fetched earlier, if any. The index is
+            only transferred if the server reports it changed since. Set to those of the new index.
+     \param addons [out] the add-ons of the directory. Empty if the index didn't change.
+     \return STATUS_NOT_MODIFIED if the index didn't change since it was fetched with the given validators.
+     */
+    static FetchStatus Parse(const DirInfo& dir, IndexValidators& validators, VECADDONS& addons);
     static std::string FetchChecksum(const std::string& url);
 
   private:
     CRepository(const CRepository &rhs);
 
-    static bool FetchIndex(const std::string& url, VECADDONS& addons);
+    static FetchStatus FetchIndex(const std::string& url, IndexValidators& validators, VECADDONS& addons);
   };
 
   typedef std::shared_ptr<CRepository> RepositoryPtr;
@@ -75,15 +103,14 @@ namespace ADDON
     const RepositoryPtr& GetAddon() const { return m_repo; };
 
   private:
-    enum FetchStatus
-    {
-      STATUS_OK,
-      STATUS_NOT_MODIFIED,
-      STATUS_ERROR
-    };
-
-    FetchStatus FetchIfChanged(const std::string& oldChecksum,
-        std::string& checksum, VECADDONS& addons);
+    /*! \brief Fetch the indexes that changed since the last check.
+     \param unchangedDirs [out] the data directories whose index is unchanged, their add-ons aren't fetched.
+     \param validators [out] the validators of the indexes, by index url.
+     */
+    CRepository::FetchStatus FetchIfChanged(CAddonDatabase& database, int idRepo,
+        const std::string& oldChecksum, std::string& checksum, VECADDONS& addons,
+        std::vector<std::string>& unchangedDirs,
+        std::map<std::string, CRepository::IndexValidators>& validators);
 
     const RepositoryPtr m_repo;
   };
@@ -39,7 +39,10 @@
 namespace ADDON
 {
 
+#define MAX_CONCURRENT_CHECKS 3
+
 CRepositoryUpdater::CRepositoryUpdater() :
+  CJobQueue(false, MAX_CONCURRENT_CHECKS, CJob::PRIORITY_LOW),
   m_timer(this),
   m_doneEvent(true)
 {}
@@ -57,6 +60,8 @@ void CRepositoryUpdater::Start()
 
 void CRepositoryUpdater::OnJobComplete(unsigned int jobID, bool success, CJob* job)
 {
+  CJobQueue::OnJobComplete(jobID, success, job);
+
   CSingleLock lock(m_criticalSection);
   m_jobs.erase(std::find(m_jobs.begin(), m_jobs.end(), job));
   if (m_jobs.empty())
@@ -124,7 +129,7 @@ void CRepositoryUpdater::CheckForUpdates(const ADDON::RepositoryPtr& repo, bool
     m_doneEvent.Reset();
     if (showProgress)
       SetProgressIndicator(job);
-    CJobManager::GetInstance().AddJob(job, this, CJob::PRIORITY_LOW);
+    AddJob(job);
   }
   else
   {
@@ -23,13 +23,19 @@
 #include "dialogs/GUIDialogExtendedProgressBar.h"
 #include "threads/CriticalSection.h"
 #include "threads/Timer.h"
+#include "utils/JobManager.h"
 #include "XBDateTime.h"
 #include <vector>
 
 namespace ADDON
 {
 
-class CRepositoryUpdater : private ITimerCallback, private IJobCallback, public ISettingCallback
+/**
+ * Checks the repositories for updates. The checks are mostly waiting on the network,
+ * a few of them run at once. Running all of them at once would hold up the other low
+ * priority jobs, of which only a few run at a time.
+ */
+class CRepositoryUpdater : private ITimerCallback, private CJobQueue, public ISettingCallback
 {
 public:
   static CRepositoryUpdater& GetInstance();
@@ -288,6 +288,17 @@ void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool
   m_includes.ResolveIncludes(node, xmlIncludeConditions);
 }
 
+TiXmlElement* CSkinInfo::ResolveWindowIncludes(const std::string &windowFile, const TiXmlElement *root,
+                                               std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  return m_includes.ResolveWindowIncludes(windowFile, root, xmlIncludeConditions);
+}
+
+void CSkinInfo::ClearResolvedWindow(const std::string &windowFile)
+{
+  m_includes.ClearResolvedWindow(windowFile);
+}
+
 int CSkinInfo::GetStartWindow() const
 {
   int windowID = CSettings::GetInstance().GetInt(CSettings::SETTING_LOOKANDFEEL_STARTUPWINDOW);
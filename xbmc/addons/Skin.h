@@ -156,6 +156,13 @@ public:
 
   void ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions = NULL);
 
+  /*! \brief Resolve the includes of a window, reusing an earlier resolution where possible
+   \sa CGUIIncludes::ResolveWindowIncludes
+   */
+  TiXmlElement* ResolveWindowIncludes(const std::string &windowFile, const TiXmlElement *root,
+                                      std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+  void ClearResolvedWindow(const std::string &windowFile);
+
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
   const std::vector<CStartupWindow> &GetStartupWindows() const { return m_startupWindows; };
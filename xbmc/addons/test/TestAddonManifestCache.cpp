@@ -0,0 +1,290 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+#include <string>
+
+#include "addons/AddonManifestCache.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+
+#include "gtest/gtest.h"
+
+using namespace ADDON;
+
+namespace
+{
+  const char *manifest =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<addon id=\"plugin.video.test\" name=\"Test\" version=\"1.0.0\" provider-name=\"Team Kodi\">\n"
+    "  <requires>\n"
+    "    <import addon=\"xbmc.python\" version=\"2.24.0\"/>\n"
+    "    <import addon=\"script.module.test\" version=\"1.0.0\" optional=\"true\"/>\n"
+    "  </requires>\n"
+    "  <extension point=\"xbmc.python.pluginsource\" library=\"default.py\">\n"
+    "    <provides>video</provides>\n"
+    "  </extension>\n"
+    "  <extension point=\"xbmc.addon.metadata\">\n"
+    "    <summary lang=\"en\">Summary</summary>\n"
+    "    <summary lang=\"de\"></summary>\n"
+    "    <platform>all</platform>\n"
+    "  </extension>\n"
+    "</addon>\n";
+
+  // same size as the manifest above
+  const char *manifestChanged =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<addon id=\"plugin.video.test\" name=\"Test\" version=\"1.0.1\" provider-name=\"Team Kodi\">\n"
+    "  <requires>\n"
+    "    <import addon=\"xbmc.python\" version=\"2.24.0\"/>\n"
+    "    <import addon=\"script.module.test\" version=\"1.0.0\" optional=\"true\"/>\n"
+    "  </requires>\n"
+    "  <extension point=\"xbmc.python.pluginsource\" library=\"default.py\">\n"
+    "    <provides>video</provides>\n"
+    "  </extension>\n"
+    "  <extension point=\"xbmc.addon.metadata\">\n"
+    "    <summary lang=\"en\">Summary</summary>\n"
+    "    <summary lang=\"de\"></summary>\n"
+    "    <platform>all</platform>\n"
+    "  </extension>\n"
+    "</addon>\n";
+
+  void ExpectEqualStrings(const char *a, const char *b)
+  {
+    if (a == NULL || b == NULL)
+      EXPECT_EQ(a, b);
+    else
+      EXPECT_STREQ(a, b);
+  }
+
+  void ExpectEqualElements(const cp_cfg_element_t *a, const cp_cfg_element_t *b)
+  {
+    ExpectEqualStrings(a->name, b->name);
+    ExpectEqualStrings(a->value, b->value);
+    ASSERT_EQ(a->num_atts, b->num_atts);
+    for (unsigned int i = 0; i < a->num_atts * 2; i++)
+      ExpectEqualStrings(a->atts[i], b->atts[i]);
+    ASSERT_EQ(a->num_children, b->num_children);
+    for (unsigned int i = 0; i < a->num_children; i++)
+    {
+      EXPECT_EQ(b, b->children[i].parent);
+      EXPECT_EQ(i, b->children[i].index);
+      ExpectEqualElements(&a->children[i], &b->children[i]);
+    }
+  }
+
+  bool WriteManifest(const std::string &folder, const char *content)
+  {
+    XFILE::CFile file;
+    if (!file.OpenForWrite(folder + "addon.xml", true))
+      return false;
+    bool success = file.Write(content, strlen(content)) == static_cast<ssize_t>(strlen(content));
+    file.Close();
+    return success;
+  }
+}
+
+class TestAddonManifestCache : public testing::Test
+{
+protected:
+  TestAddonManifestCache()
+    : context(NULL),
+      info(NULL)
+  {
+    cp_status_t status = cp_init();
+    EXPECT_EQ(CP_OK, status);
+    context = cp_create_context(&status);
+    EXPECT_EQ(CP_OK, status);
+    if (context)
+      info = cp_load_plugin_descriptor_from_memory(context, manifest, strlen(manifest), &status);
+    EXPECT_EQ(CP_OK, status);
+  }
+
+  ~TestAddonManifestCache()
+  {
+    if (info)
+      cp_release_info(context, info);
+    if (context)
+      cp_destroy_context(context);
+    cp_destroy();
+
+    XFILE::CFile::Delete("special://temp/addonmanifests.dat");
+    XFILE::CFile::Delete("special://temp/addonmanifesttest/addon.xml");
+    XFILE::CDirectory::Remove("special://temp/addonmanifesttest/");
+  }
+
+  std::string Serialize() const
+  {
+    std::string data(cp_serialize_plugin_descriptor(info, NULL, 0), '\0');
+    EXPECT_EQ(data.size(), cp_serialize_plugin_descriptor(info, &data[0], data.size()));
+    return data;
+  }
+
+  cp_context_t *context;
+  cp_plugin_info_t *info;
+};
+
+TEST_F(TestAddonManifestCache, SerializeRoundTrip)
+{
+  ASSERT_TRUE(info != NULL);
+  std::string data = Serialize();
+
+  cp_status_t status;
+  cp_plugin_info_t *loaded = cp_load_plugin_descriptor_from_serialized(context, "/addons/plugin.video.test", data.c_str(), data.size(), &status);
+  ASSERT_TRUE(loaded != NULL);
+  EXPECT_EQ(CP_OK, status);
+
+  EXPECT_STREQ("/addons/plugin.video.test", loaded->plugin_path);
+  ExpectEqualStrings(info->identifier, loaded->identifier);
+  ExpectEqualStrings(info->name, loaded->name);
+  ExpectEqualStrings(info->version, loaded->version);
+  ExpectEqualStrings(info->provider_name, loaded->provider_name);
+
+  ASSERT_EQ(info->num_imports, loaded->num_imports);
+  for (unsigned int i = 0; i < info->num_imports; i++)
+  {
+    ExpectEqualStrings(info->imports[i].plugin_id, loaded->imports[i].plugin_id);
+    ExpectEqualStrings(info->imports[i].version, loaded->imports[i].version);
+    EXPECT_EQ(info->imports[i].optional, loaded->imports[i].optional);
+  }
+
+  ASSERT_EQ(info->num_extensions, loaded->num_extensions);
+  for (unsigned int i = 0; i < info->num_extensions; i++)
+  {
+    EXPECT_EQ(loaded, loaded->extensions[i].plugin);
+    ExpectEqualStrings(info->extensions[i].ext_point_id, loaded->extensions[i].ext_point_id);
+    ExpectEqualStrings(info->extensions[i].identifier, loaded->extensions[i].identifier);
+    ASSERT_TRUE(loaded->extensions[i].configuration != NULL);
+    ExpectEqualElements(info->extensions[i].configuration, loaded->extensions[i].configuration);
+  }
+
+  // the serialized form of the loaded descriptor is the same
+  std::string reserialized(cp_serialize_plugin_descriptor(loaded, NULL, 0), '\0');
+  cp_serialize_plugin_descriptor(loaded, &reserialized[0], reserialized.size());
+  EXPECT_EQ(data, reserialized);
+
+  cp_release_info(context, loaded);
+}
+
+TEST_F(TestAddonManifestCache, SerializeSmallBuffer)
+{
+  ASSERT_TRUE(info != NULL);
+  std::string data = Serialize();
+
+  std::string buffer(data.size() - 1, 'x');
+  EXPECT_EQ(data.size(), cp_serialize_plugin_descriptor(info, &buffer[0], buffer.size()));
+  EXPECT_EQ(std::string(data.size() - 1, 'x'), buffer);
+}
+
+TEST_F(TestAddonManifestCache, DeserializeTruncated)
+{
+  ASSERT_TRUE(info != NULL);
+  std::string data = Serialize();
+
+  for (size_t size = 0; size < data.size(); size++)
+  {
+    cp_status_t status = CP_OK;
+    EXPECT_EQ(NULL, cp_load_plugin_descriptor_from_serialized(context, "/addons/plugin.video.test", data.c_str(), size, &status));
+    EXPECT_NE(CP_OK, status);
+  }
+}
+
+TEST_F(TestAddonManifestCache, DeserializeCorrupt)
+{
+  ASSERT_TRUE(info != NULL);
+  std::string data = Serialize();
+
+  // trailing data
+  cp_status_t status = CP_OK;
+  std::string longer = data + '\0';
+  EXPECT_EQ(NULL, cp_load_plugin_descriptor_from_serialized(context, "/addons/plugin.video.test", longer.c_str(), longer.size(), &status));
+  EXPECT_EQ(CP_ERR_MALFORMED, status);
+
+  // huge counts and string lengths mustn't be trusted, anything read has to be released again
+  for (size_t pos = 0; pos < data.size(); pos++)
+  {
+    std::string corrupt(data);
+    corrupt[pos] = static_cast<char>(0xff);
+    cp_plugin_info_t *loaded = cp_load_plugin_descriptor_from_serialized(context, "/addons/plugin.video.test", corrupt.c_str(), corrupt.size(), &status);
+    if (loaded)
+      cp_release_info(context, loaded);
+  }
+}
+
+TEST_F(TestAddonManifestCache, CorruptCacheFile)
+{
+  ASSERT_TRUE(context != NULL);
+  const std::string folder = "special://temp/addonmanifesttest/";
+  ASSERT_TRUE(XFILE::CDirectory::Create(folder));
+  ASSERT_TRUE(WriteManifest(folder, manifest));
+  const std::string path = CSpecialProtocol::TranslatePath(folder);
+
+  {
+    CAddonManifestCache cache;
+    cache.Load();
+    cp_status_t status;
+    cp_plugin_info_t *loaded = CAddonManifestCache::LoadDescriptor(context, path.c_str(), &status, &cache);
+    ASSERT_TRUE(loaded != NULL);
+    cp_release_info(context, loaded);
+    cache.Save();
+  }
+
+  // cut the cache short
+  XFILE::CFile file;
+  XFILE::auto_buffer buffer;
+  ASSERT_GT(file.LoadFile("special://temp/addonmanifests.dat", buffer), 8);
+  ASSERT_TRUE(file.OpenForWrite("special://temp/addonmanifests.dat", true));
+  file.Write(buffer.get(), buffer.size() - 8);
+  file.Close();
+
+  CAddonManifestCache cache;
+  cache.Load();
+  cp_status_t status;
+  cp_plugin_info_t *loaded = CAddonManifestCache::LoadDescriptor(context, path.c_str(), &status, &cache);
+  ASSERT_TRUE(loaded != NULL);
+  EXPECT_STREQ("plugin.video.test", loaded->identifier);
+  cp_release_info(context, loaded);
+}
+
+TEST_F(TestAddonManifestCache, ChangedManifestOfSameSize)
+{
+  ASSERT_TRUE(context != NULL);
+  ASSERT_EQ(strlen(manifest), strlen(manifestChanged));
+  const std::string folder = "special://temp/addonmanifesttest/";
+  ASSERT_TRUE(XFILE::CDirectory::Create(folder));
+  ASSERT_TRUE(WriteManifest(folder, manifest));
+  const std::string path = CSpecialProtocol::TranslatePath(folder);
+
+  CAddonManifestCache cache;
+  cache.Load();
+  cp_status_t status;
+  cp_plugin_info_t *loaded = CAddonManifestCache::LoadDescriptor(context, path.c_str(), &status, &cache);
+  ASSERT_TRUE(loaded != NULL);
+  EXPECT_STREQ("1.0.0", loaded->version);
+  cp_release_info(context, loaded);
+
+  // rewritten right away, so likely within the same second
+  ASSERT_TRUE(WriteManifest(folder, manifestChanged));
+  loaded = CAddonManifestCache::LoadDescriptor(context, path.c_str(), &status, &cache);
+  ASSERT_TRUE(loaded != NULL);
+  EXPECT_STREQ("1.0.1", loaded->version);
+  cp_release_info(context, loaded);
+}
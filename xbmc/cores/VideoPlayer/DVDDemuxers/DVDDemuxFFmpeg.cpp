@@ -198,6 +198,7 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   memset(&m_pkt.pkt, 0, sizeof(AVPacket));
   m_streaminfo = true; /* set to true if we want to look for streams before playback */
   m_checkvideo = false;
+  m_keyframeStream = -1;
   avformat_network_init();
 }
 
@@ -530,6 +531,8 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput, bool streaminfo, bool filein
   if (skipCreateStreams && GetNrOfStreams() == 0)
     m_program = 0;
 
+  OpenKeyframeIndex();
+
   return true;
 }
 
@@ -538,6 +541,10 @@ void CDVDDemuxFFmpeg::Dispose()
   m_pkt.result = -1;
   av_free_packet(&m_pkt.pkt);
 
+  // keep the keyframes seen for the next time the file is opened
+  m_keyframeIndex.Save();
+  m_keyframeIndex.Clear();
+
   if (m_pFormatContext)
   {
     for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
@@ -884,6 +891,17 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
         if (pPacket->dts != DVD_NOPTS_VALUE && (pPacket->dts > m_currentPts || m_currentPts == DVD_NOPTS_VALUE))
           m_currentPts = pPacket->dts;
 
+        if (m_keyframeIndex.IsEnabled() && stream->codec && stream->codec->codec_type == AVMEDIA_TYPE_VIDEO
+        && !(stream->disposition & AV_DISPOSITION_ATTACHED_PIC))
+        {
+          if (m_keyframeStream < 0)
+            m_keyframeStream = m_pkt.pkt.stream_index;
+
+          double keyframePts = pPacket->pts != DVD_NOPTS_VALUE ? pPacket->pts : pPacket->dts;
+          if ((m_pkt.pkt.flags & AV_PKT_FLAG_KEY) && m_pkt.pkt.stream_index == m_keyframeStream && keyframePts != DVD_NOPTS_VALUE)
+            m_keyframeIndex.Add(DVD_TIME_TO_MSEC(keyframePts), m_pkt.pkt.pos);
+        }
+
 
         // check if stream has passed full duration, needed for live streams
         bool bAllowDurationExt = (stream->codec && (stream->codec->codec_type == AVMEDIA_TYPE_VIDEO || stream->codec->codec_type == AVMEDIA_TYPE_AUDIO));
@@ -1003,16 +1021,29 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
   int ret;
   {
     CSingleLock lock(m_critSection);
-    ret = av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
 
-    // demuxer will return failure, if you seek behind eof
-    if (ret < 0 && m_pFormatContext->duration && seek_pts >= (m_pFormatContext->duration + m_pFormatContext->start_time))
-      ret = 0;
-    else if (ret < 0 && m_pInput->IsEOF())
+    // jump straight to a known keyframe instead of letting ffmpeg search for it by reading timestamps
+    int keyframeTime;
+    int64_t keyframePos;
+    if (m_keyframeIndex.FindTime(time, backwords, keyframeTime, keyframePos)
+    &&  av_seek_frame(m_pFormatContext, -1, keyframePos, AVSEEK_FLAG_BYTE) >= 0)
+    {
       ret = 0;
+      m_currentPts = DVD_MSEC_TO_TIME(keyframeTime);
+    }
+    else
+    {
+      ret = av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
 
-    if(ret >= 0)
-      UpdateCurrentPTS();
+      // demuxer will return failure, if you seek behind eof
+      if (ret < 0 && m_pFormatContext->duration && seek_pts >= (m_pFormatContext->duration + m_pFormatContext->start_time))
+        ret = 0;
+      else if (ret < 0 && m_pInput->IsEOF())
+        ret = 0;
+
+      if(ret >= 0)
+        UpdateCurrentPTS();
+    }
   }
 
   if(m_currentPts == DVD_NOPTS_VALUE)
@@ -1033,8 +1064,14 @@ bool CDVDDemuxFFmpeg::SeekByte(int64_t pos)
   int ret = av_seek_frame(m_pFormatContext, -1, pos, AVSEEK_FLAG_BYTE);
 
   if(ret >= 0)
+  {
     UpdateCurrentPTS();
 
+    int keyframeTime;
+    if (m_currentPts == DVD_NOPTS_VALUE && m_keyframeIndex.FindPosition(pos, keyframeTime))
+      m_currentPts = DVD_MSEC_TO_TIME(keyframeTime);
+  }
+
   m_pkt.result = -1;
   av_free_packet(&m_pkt.pkt);
 
@@ -1057,6 +1094,37 @@ void CDVDDemuxFFmpeg::UpdateCurrentPTS()
   }
 }
 
+void CDVDDemuxFFmpeg::OpenKeyframeIndex()
+{
+  m_keyframeStream = -1;
+
+  if (!m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE) || !m_pInput->Seek(0, SEEK_POSSIBLE))
+    return;
+
+  // only containers ffmpeg can't seek in without bisecting the file benefit from it
+  const char *name = m_pFormatContext->iformat->name;
+  bool indexed = strcmp(name, "mpegts") != 0
+              && strcmp(name, "mpeg") != 0
+              && strcmp(name, "mpegvideo") != 0
+              && strcmp(name, "h264") != 0
+              && strcmp(name, "hevc") != 0
+              && strcmp(name, "vc1") != 0
+              && !m_bAVI;
+
+  // avi files usually have an index, unless they were cut off while being written
+  for (unsigned int i = 0; m_bAVI && i < m_pFormatContext->nb_streams; i++)
+  {
+    if (m_pFormatContext->streams[i]->nb_index_entries > 0)
+      indexed = true;
+  }
+
+  int64_t length = m_pInput->GetLength();
+  if (indexed || length <= 0)
+    return;
+
+  m_keyframeIndex.Load(m_pInput->GetFileName(), length);
+}
+
 int CDVDDemuxFFmpeg::GetStreamLength()
 {
   if (!m_pFormatContext)
@@ -21,6 +21,7 @@
  */
 
 #include "DVDDemux.h"
+#include "DVDDemuxKeyframeIndex.h"
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
 #include <map>
@@ -140,6 +141,7 @@ protected:
   double ConvertTimestamp(int64_t pts, int den, int num);
   void UpdateCurrentPTS();
   bool IsProgramChange();
+  void OpenKeyframeIndex();
 
   std::string GetStereoModeFromMetadata(AVDictionary *pMetadata);
   std::string ConvertCodecToInternalStereoMode(const std::string &mode, const StereoModeConversionMap *conversionMap);
@@ -171,5 +173,9 @@ protected:
 
   bool m_streaminfo;
   bool m_checkvideo;
+
+  // keyframes of containers without a usable index of their own
+  CDVDDemuxKeyframeIndex m_keyframeIndex;
+  int m_keyframeStream;
 };
 
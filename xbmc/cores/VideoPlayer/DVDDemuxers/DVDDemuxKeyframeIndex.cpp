@@ -0,0 +1,242 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemuxKeyframeIndex.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include "FileItem.h"
+#include "URL.h"
+#include "XBDateTime.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+#define KEYFRAME_INDEX_DIRECTORY    "special://temp/keyframes/"
+#define KEYFRAME_INDEX_MAGIC        "KFI1"
+// keyframes closer than this to an indexed one aren't added, keeps the index small for short GOPs
+#define KEYFRAME_INDEX_MIN_DISTANCE 1000
+// the index doesn't cover times further away than this from the closest keyframe
+#define KEYFRAME_INDEX_MAX_DISTANCE 10000
+// indexes not updated for this many days are removed, as are the oldest ones beyond the total size
+#define KEYFRAME_INDEX_MAX_AGE      30
+#define KEYFRAME_INDEX_MAX_SIZE     (32 * 1024 * 1024)
+
+namespace
+{
+  template<typename T>
+  void Append(std::string &buffer, T value)
+  {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template<typename T>
+  bool Extract(const char *&data, const char *end, T &value)
+  {
+    if (end - data < static_cast<ptrdiff_t>(sizeof(value)))
+      return false;
+
+    memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+  }
+}
+
+CDVDDemuxKeyframeIndex::CDVDDemuxKeyframeIndex()
+  : m_size(0),
+    m_modified(false)
+{ }
+
+bool CDVDDemuxKeyframeIndex::Load(const std::string &path, int64_t size)
+{
+  Clear();
+
+  Crc32 crc;
+  crc.ComputeFromLowerCase(path);
+  m_indexPath = StringUtils::Format(KEYFRAME_INDEX_DIRECTORY "%08x.idx", (unsigned int)crc);
+  m_size = size;
+
+  XFILE::CFile file;
+  XFILE::auto_buffer buffer;
+  if (!XFILE::CFile::Exists(m_indexPath) || file.LoadFile(m_indexPath, buffer) <= 0)
+    return false;
+
+  const char *data = buffer.get();
+  const char *end = data + buffer.size();
+
+  int64_t indexedSize;
+  uint32_t count;
+  if (buffer.size() < 4 || memcmp(data, KEYFRAME_INDEX_MAGIC, 4) != 0)
+    return false;
+  data += 4;
+  if (!Extract(data, end, indexedSize) || !Extract(data, end, count))
+    return false;
+
+  // files that are still being recorded only ever grow, anything else means the file was replaced
+  if (indexedSize > size)
+  {
+    CLog::Log(LOGDEBUG, "%s - discarding outdated keyframe index of %s", __FUNCTION__, CURL::GetRedacted(path).c_str());
+    m_modified = true;
+    return false;
+  }
+
+  m_entries.reserve(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    Entry entry;
+    if (!Extract(data, end, entry.time) || !Extract(data, end, entry.pos))
+    {
+      m_entries.clear();
+      return false;
+    }
+    m_entries.push_back(entry);
+  }
+
+  m_modified = indexedSize != size;
+
+  CLog::Log(LOGDEBUG, "%s - loaded %u keyframes of %s", __FUNCTION__, count, CURL::GetRedacted(path).c_str());
+  return true;
+}
+
+void CDVDDemuxKeyframeIndex::Save()
+{
+  if (!m_modified || m_indexPath.empty() || m_entries.size() < 2)
+    return;
+
+  std::string buffer(KEYFRAME_INDEX_MAGIC);
+  buffer.reserve(4 + sizeof(int64_t) + sizeof(uint32_t) + m_entries.size() * (sizeof(int) + sizeof(int64_t)));
+  Append(buffer, m_size);
+  Append(buffer, static_cast<uint32_t>(m_entries.size()));
+  for (std::vector<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    Append(buffer, it->time);
+    Append(buffer, it->pos);
+  }
+
+  if (!XFILE::CDirectory::Exists(KEYFRAME_INDEX_DIRECTORY))
+    XFILE::CDirectory::Create(KEYFRAME_INDEX_DIRECTORY);
+
+  // write to a temporary file first so an index is never read while it is only partially written
+  const std::string tempPath = m_indexPath + ".tmp";
+  XFILE::CFile file;
+  if (!file.OpenForWrite(tempPath, true))
+    return;
+
+  bool success = file.Write(buffer.c_str(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+  file.Close();
+
+  if (!success || !XFILE::CFile::Rename(tempPath, m_indexPath))
+  {
+    XFILE::CFile::Delete(tempPath);
+    return;
+  }
+
+  m_modified = false;
+
+  Prune(m_indexPath);
+}
+
+void CDVDDemuxKeyframeIndex::Prune(const std::string &keep)
+{
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(KEYFRAME_INDEX_DIRECTORY, items, ".idx", XFILE::DIR_FLAG_NO_FILE_DIRS))
+    return;
+
+  const CDateTime oldest = CDateTime::GetCurrentDateTime() - CDateTimeSpan(KEYFRAME_INDEX_MAX_AGE, 0, 0, 0);
+  int64_t size = 0;
+
+  items.Sort(SortByDate, SortOrderDescending);
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CFileItemPtr item = items[i];
+    if (item->m_bIsFolder || item->GetPath() == keep)
+      continue;
+
+    size += item->m_dwSize;
+    if (size > KEYFRAME_INDEX_MAX_SIZE || (item->m_dateTime.IsValid() && item->m_dateTime < oldest))
+      XFILE::CFile::Delete(item->GetPath());
+  }
+}
+
+void CDVDDemuxKeyframeIndex::Clear()
+{
+  m_indexPath.clear();
+  m_size = 0;
+  m_entries.clear();
+  m_modified = false;
+}
+
+void CDVDDemuxKeyframeIndex::Add(int time, int64_t pos)
+{
+  if (m_indexPath.empty() || time < 0 || pos < 0)
+    return;
+
+  std::vector<Entry>::iterator it = std::lower_bound(m_entries.begin(), m_entries.end(), time, CompareTime);
+
+  // the neighbours have to be before and after the keyframe in time as well as in position
+  if (it != m_entries.end() && (it->pos <= pos || it->time - time < KEYFRAME_INDEX_MIN_DISTANCE))
+    return;
+  if (it != m_entries.begin() && ((it - 1)->pos >= pos || time - (it - 1)->time < KEYFRAME_INDEX_MIN_DISTANCE))
+    return;
+
+  Entry entry = { time, pos };
+  m_entries.insert(it, entry);
+  m_modified = true;
+}
+
+bool CDVDDemuxKeyframeIndex::FindTime(int time, bool backwards, int &keyframeTime, int64_t &pos) const
+{
+  std::vector<Entry>::const_iterator it = std::lower_bound(m_entries.begin(), m_entries.end(), time, CompareTime);
+  if (backwards && (it == m_entries.end() || it->time > time))
+  {
+    if (it == m_entries.begin())
+      return false;
+    --it;
+  }
+  else if (!backwards && it == m_entries.end())
+    return false;
+
+  // there may be keyframes in between that haven't been seen yet
+  if (abs(time - it->time) > KEYFRAME_INDEX_MAX_DISTANCE)
+    return false;
+
+  keyframeTime = it->time;
+  pos = it->pos;
+  return true;
+}
+
+bool CDVDDemuxKeyframeIndex::FindPosition(int64_t pos, int &keyframeTime) const
+{
+  std::vector<Entry>::const_iterator next = std::upper_bound(m_entries.begin(), m_entries.end(), pos, ComparePosition);
+  if (next == m_entries.begin() || next == m_entries.end())
+    return false;
+
+  std::vector<Entry>::const_iterator it = next - 1;
+  if (next->time - it->time > KEYFRAME_INDEX_MAX_DISTANCE)
+    return false;
+
+  keyframeTime = it->time;
+  return true;
+}
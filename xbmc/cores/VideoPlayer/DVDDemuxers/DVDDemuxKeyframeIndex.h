@@ -0,0 +1,105 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Maps the times of the keyframes of a video stream to their byte positions.
+
+ Containers like MPEG-TS, MPEG-PS, raw elementary streams or AVI files without
+ an index have no (usable) index of their own, so ffmpeg has to bisect the file
+ by reading timestamps on every seek. The index is filled with the keyframes
+ seen while the file is demuxed and stored in the temp folder, so later seeks
+ into the parts that have been played before are a single byte seek.
+
+ Entries are kept sorted by time and by position, keyframes contradicting that
+ order (e.g. after a timestamp discontinuity) are ignored.
+ */
+class CDVDDemuxKeyframeIndex
+{
+public:
+  CDVDDemuxKeyframeIndex();
+
+  /*!
+   \brief Load the index stored for the given file.
+   \param path the demuxed file
+   \param size the current size of the file, an index of a file that shrunk is discarded
+   \return true if an index was loaded, false otherwise.
+   */
+  bool Load(const std::string &path, int64_t size);
+
+  /*!
+   \brief Store the index if it was changed since it was loaded.
+
+   Indexes of other files are removed when they weren't updated for a month
+   or when all indexes together grow too large.
+   */
+  void Save();
+  void Clear();
+
+  bool IsEnabled() const { return !m_indexPath.empty(); }
+
+  /*!
+   \brief Add a keyframe to the index.
+   \param time the (presentation) time of the keyframe in milliseconds
+   \param pos the byte position of the packet holding the keyframe
+   */
+  void Add(int time, int64_t pos);
+
+  /*!
+   \brief Look up the closest known keyframe at or before (or after) the given time.
+   \param time the time to seek to in milliseconds
+   \param backwards true to look for a keyframe at or before the given time, false for one at or after it
+   \param keyframeTime [out] the time of the keyframe
+   \param pos [out] the byte position of the keyframe
+   \return true if the index covers the given time, false otherwise.
+   */
+  bool FindTime(int time, bool backwards, int &keyframeTime, int64_t &pos) const;
+
+  /*!
+   \brief Look up the time of the closest keyframe preceding the given byte position.
+   \return true if the index covers the given position, false otherwise.
+   */
+  bool FindPosition(int64_t pos, int &keyframeTime) const;
+
+private:
+  struct Entry
+  {
+    int time;
+    int64_t pos;
+  };
+
+  /*!
+   \brief Remove outdated indexes and the least recently updated ones beyond the total size.
+   \param keep the index which is in use
+   */
+  static void Prune(const std::string &keep);
+
+  static bool CompareTime(const Entry &entry, int time) { return entry.time < time; }
+  static bool ComparePosition(int64_t pos, const Entry &entry) { return pos < entry.pos; }
+
+  std::string m_indexPath;
+  int64_t m_size;
+  std::vector<Entry> m_entries;
+  bool m_modified;
+};
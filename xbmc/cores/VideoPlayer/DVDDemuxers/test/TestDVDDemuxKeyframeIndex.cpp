@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxKeyframeIndex.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+
+#include "gtest/gtest.h"
+
+#define TEST_FILE "/recordings/show.ts"
+#define TEST_SIZE 1000000
+
+class TestDVDDemuxKeyframeIndex : public testing::Test
+{
+protected:
+  TestDVDDemuxKeyframeIndex()
+  {
+    EXPECT_FALSE(index.Load(TEST_FILE, TEST_SIZE));
+    EXPECT_TRUE(index.IsEnabled());
+
+    index.Add(0, 0);
+    index.Add(2000, 1000);
+    index.Add(4000, 2000);
+  }
+
+  ~TestDVDDemuxKeyframeIndex()
+  {
+    CFileItemList items;
+    XFILE::CDirectory::GetDirectory("special://temp/keyframes/", items);
+    for (int i = 0; i < items.Size(); i++)
+      XFILE::CFile::Delete(items[i]->GetPath());
+    XFILE::CDirectory::Remove("special://temp/keyframes/");
+  }
+
+  CDVDDemuxKeyframeIndex index;
+};
+
+TEST_F(TestDVDDemuxKeyframeIndex, FindTime)
+{
+  int time;
+  int64_t pos;
+  EXPECT_TRUE(index.FindTime(3000, true, time, pos));
+  EXPECT_EQ(2000, time);
+  EXPECT_EQ(1000, pos);
+
+  EXPECT_TRUE(index.FindTime(3000, false, time, pos));
+  EXPECT_EQ(4000, time);
+  EXPECT_EQ(2000, pos);
+
+  EXPECT_TRUE(index.FindTime(4000, true, time, pos));
+  EXPECT_EQ(4000, time);
+  EXPECT_TRUE(index.FindTime(4000, false, time, pos));
+  EXPECT_EQ(4000, time);
+
+  // nothing is known about keyframes after the last one
+  EXPECT_FALSE(index.FindTime(4001, false, time, pos));
+  EXPECT_FALSE(index.FindTime(15000, true, time, pos));
+}
+
+TEST_F(TestDVDDemuxKeyframeIndex, FindPosition)
+{
+  int time;
+  EXPECT_TRUE(index.FindPosition(0, time));
+  EXPECT_EQ(0, time);
+  EXPECT_TRUE(index.FindPosition(1500, time));
+  EXPECT_EQ(2000, time);
+
+  EXPECT_FALSE(index.FindPosition(2500, time));
+}
+
+TEST_F(TestDVDDemuxKeyframeIndex, AddIgnoresContradictions)
+{
+  // before an earlier keyframe in the file
+  index.Add(3000, 500);
+  // too close to a known keyframe
+  index.Add(2500, 1500);
+
+  int time;
+  int64_t pos;
+  EXPECT_TRUE(index.FindTime(3500, true, time, pos));
+  EXPECT_EQ(2000, time);
+  EXPECT_EQ(1000, pos);
+}
+
+TEST_F(TestDVDDemuxKeyframeIndex, SaveLoad)
+{
+  index.Save();
+
+  CDVDDemuxKeyframeIndex loaded;
+  EXPECT_TRUE(loaded.Load(TEST_FILE, TEST_SIZE));
+
+  int time;
+  int64_t pos;
+  EXPECT_TRUE(loaded.FindTime(3000, true, time, pos));
+  EXPECT_EQ(2000, time);
+  EXPECT_EQ(1000, pos);
+
+  // a file that grew (e.g. a recording) keeps its index
+  EXPECT_TRUE(loaded.Load(TEST_FILE, TEST_SIZE * 2));
+
+  // a file that shrunk was replaced
+  EXPECT_FALSE(loaded.Load(TEST_FILE, TEST_SIZE / 2));
+  EXPECT_FALSE(loaded.FindTime(3000, true, time, pos));
+}
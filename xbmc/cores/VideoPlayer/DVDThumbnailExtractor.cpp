@@ -0,0 +1,297 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDThumbnailExtractor.h"
+
+#include <cstring>
+
+#include "FileItem.h"
+#include "URL.h"
+#include "DVDCodecs/DVDCodecs.h"
+#include "DVDCodecs/DVDFactoryCodec.h"
+#include "DVDCodecs/Video/DVDVideoCodec.h"
+#include "DVDCodecs/Video/DVDVideoCodecFFmpeg.h"
+#include "DVDDemuxers/DVDDemux.h"
+#include "DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDDemuxers/DVDFactoryDemuxer.h"
+#include "DVDInputStreams/DVDFactoryInputStream.h"
+#include "DVDInputStreams/DVDInputStream.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libswscale/swscale.h"
+}
+
+CDVDThumbnailExtractor::CDVDThumbnailExtractor(unsigned int width, bool keyframesOnly)
+  : m_width(width),
+    m_keyframesOnly(keyframesOnly),
+    m_videoStream(-1),
+    m_codecKeyframesOnly(false),
+    m_packetsTried(0)
+{ }
+
+CDVDThumbnailExtractor::~CDVDThumbnailExtractor()
+{
+  Close();
+}
+
+bool CDVDThumbnailExtractor::Open(const std::string &path)
+{
+  Close();
+
+  m_redactedPath = CURL::GetRedacted(path);
+  CFileItem item(path, false);
+  m_inputStream.reset(CDVDFactoryInputStream::CreateInputStream(NULL, item));
+  if (!m_inputStream)
+  {
+    CLog::Log(LOGERROR, "InputStream: Error creating stream for %s", m_redactedPath.c_str());
+    return false;
+  }
+
+  if (m_inputStream->IsStreamType(DVDSTREAM_TYPE_DVD)
+   || m_inputStream->IsStreamType(DVDSTREAM_TYPE_BLURAY))
+  {
+    CLog::Log(LOGDEBUG, "%s: disc streams not supported for thumb extraction, file: %s", __FUNCTION__, m_redactedPath.c_str());
+    Close();
+    return false;
+  }
+
+  if (m_inputStream->IsStreamType(DVDSTREAM_TYPE_PVRMANAGER))
+  {
+    Close();
+    return false;
+  }
+
+  if (!m_inputStream->Open())
+  {
+    CLog::Log(LOGERROR, "InputStream: Error opening, %s", m_redactedPath.c_str());
+    Close();
+    return false;
+  }
+
+  try
+  {
+    m_demuxer.reset(CDVDFactoryDemuxer::CreateDemuxer(m_inputStream.get(), true));
+    if (!m_demuxer)
+    {
+      CLog::Log(LOGERROR, "%s - Error creating demuxer", __FUNCTION__);
+      Close();
+      return false;
+    }
+  }
+  catch(...)
+  {
+    CLog::Log(LOGERROR, "%s - Exception thrown when opening demuxer", __FUNCTION__);
+    Close();
+    return false;
+  }
+
+  for (int i = 0; i < m_demuxer->GetNrOfStreams(); i++)
+  {
+    CDemuxStream* pStream = m_demuxer->GetStream(i);
+    if (pStream)
+    {
+      // ignore if it's a picture attachment (e.g. jpeg artwork)
+      if (pStream->type == STREAM_VIDEO && !(pStream->flags & AV_DISPOSITION_ATTACHED_PIC))
+        m_videoStream = i;
+      else
+        pStream->SetDiscard(AVDISCARD_ALL);
+    }
+  }
+
+  // the demuxer is still of use for the stream details without a video stream
+  if (m_videoStream >= 0)
+  {
+    m_hint = CDVDStreamInfo(*m_demuxer->GetStream(m_videoStream), true);
+    m_hint.software = true;
+
+    OpenCodec(m_keyframesOnly);
+  }
+
+  return true;
+}
+
+void CDVDThumbnailExtractor::Close()
+{
+  m_codec.reset();
+  m_demuxer.reset();
+  m_inputStream.reset();
+  m_videoStream = -1;
+  m_packetsTried = 0;
+}
+
+int CDVDThumbnailExtractor::GetStreamLength() const
+{
+  if (!m_demuxer)
+    return 0;
+
+  return m_demuxer->GetStreamLength();
+}
+
+bool CDVDThumbnailExtractor::Extract(int pos, std::vector<uint8_t> &pixels, unsigned int &height, int &orientation)
+{
+  m_packetsTried = 0;
+  if (!m_codec)
+    return false;
+
+  DVDVideoPicture picture;
+  bool success = Decode(pos, picture);
+
+  // some streams don't mark their keyframes the way the decoder expects, decode everything instead
+  if (!success && m_codecKeyframesOnly)
+  {
+    CLog::Log(LOGDEBUG, "%s - no keyframe decoded in %s, retrying with all frames", __FUNCTION__, m_redactedPath.c_str());
+    if (!OpenCodec(false))
+      return false;
+
+    success = Decode(pos, picture);
+  }
+
+  if (!success)
+  {
+    CLog::Log(LOGDEBUG, "%s - decode failed in %s after %d packets.", __FUNCTION__, m_redactedPath.c_str(), m_packetsTried);
+    return false;
+  }
+
+  if (!Scale(picture, pixels, height))
+    return false;
+
+  orientation = DegreeToOrientation(m_hint.orientation);
+  return true;
+}
+
+bool CDVDThumbnailExtractor::OpenCodec(bool keyframesOnly)
+{
+  m_codec.reset();
+
+  CDVDCodecOptions options;
+  options.m_formats.push_back(RENDER_FMT_YUV420P);
+  if (keyframesOnly)
+  {
+    // a thumbnail doesn't need the in-loop filtering and full resolution
+    options.m_keys.push_back(CDVDCodecOption("skip_frame", "nokey"));
+    options.m_keys.push_back(CDVDCodecOption("skip_loop_filter", "all"));
+
+    AVCodec *codec = avcodec_find_decoder(m_hint.codec);
+    int maxLowres = codec ? av_codec_get_max_lowres(codec) : 0;
+    int lowres = 0;
+    while (lowres < maxLowres && (m_hint.width >> (lowres + 1)) >= static_cast<int>(m_width))
+      lowres++;
+
+    if (lowres > 0)
+      options.m_keys.push_back(CDVDCodecOption("lowres", StringUtils::Format("%d", lowres)));
+  }
+
+  // always use ffmpeg, libmpeg2 is not thread safe and hardware decoders don't support the options above
+  m_codec.reset(CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), m_hint, options));
+  m_codecKeyframesOnly = keyframesOnly;
+
+  return m_codec != nullptr;
+}
+
+bool CDVDThumbnailExtractor::Decode(int pos, DVDVideoPicture &picture)
+{
+  CLog::Log(LOGDEBUG, "%s - seeking to pos %dms (total: %dms) in %s", __FUNCTION__, pos, GetStreamLength(), m_redactedPath.c_str());
+  if (!m_demuxer->SeekTime(pos, true))
+    return false;
+
+  m_codec->Reset();
+
+  int iDecoderState = VC_ERROR;
+  memset(&picture, 0, sizeof(picture));
+
+  // num streams * 160 frames, should get a valid frame, if not abort.
+  int abort_index = m_demuxer->GetNrOfStreams() * 160;
+  do
+  {
+    DemuxPacket* pPacket = m_demuxer->Read();
+    m_packetsTried++;
+
+    if (!pPacket)
+      break;
+
+    if (pPacket->iStreamId != m_videoStream)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+      continue;
+    }
+
+    iDecoderState = m_codec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+    if (iDecoderState & VC_ERROR)
+      break;
+
+    if (iDecoderState & VC_PICTURE)
+    {
+      memset(&picture, 0, sizeof(DVDVideoPicture));
+      if (m_codec->GetPicture(&picture))
+      {
+        if (!(picture.iFlags & DVP_FLAG_DROPPED))
+          break;
+      }
+    }
+
+  } while (abort_index--);
+
+  return (iDecoderState & VC_PICTURE) && !(picture.iFlags & DVP_FLAG_DROPPED);
+}
+
+bool CDVDThumbnailExtractor::Scale(const DVDVideoPicture &picture, std::vector<uint8_t> &pixels, unsigned int &height) const
+{
+  double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
+  if (m_hint.forced_aspect && m_hint.aspect != 0)
+    aspect = m_hint.aspect;
+  height = (unsigned int)((double)m_width / aspect);
+
+  struct SwsContext *context = sws_getContext(picture.iWidth, picture.iHeight,
+        AV_PIX_FMT_YUV420P, m_width, height, AV_PIX_FMT_BGRA, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+  if (!context)
+    return false;
+
+  pixels.resize(m_width * height * 4);
+
+  uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
+  int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
+  uint8_t *dst[] = { pixels.data(), 0, 0, 0 };
+  int     dstStride[] = { (int)m_width*4, 0, 0, 0 };
+  sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
+  sws_freeContext(context);
+
+  return true;
+}
+
+int CDVDThumbnailExtractor::DegreeToOrientation(int degrees)
+{
+  switch(degrees)
+  {
+    case 90:
+      return 5;
+    case 180:
+      return 2;
+    case 270:
+      return 7;
+    default:
+      return 0;
+  }
+}
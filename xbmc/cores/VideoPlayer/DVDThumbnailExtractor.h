@@ -0,0 +1,109 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "DVDStreamInfo.h"
+
+class CDVDDemux;
+class CDVDInputStream;
+class CDVDVideoCodec;
+struct DVDVideoPicture;
+
+/*!
+ \brief Extracts scaled down pictures from a video file.
+
+ The input stream and demuxer are kept open so pictures can be extracted at
+ several positions of the same file. By default only keyframes are decoded and
+ the decoder's low resolution mode is used when the codec supports it, which is
+ a lot cheaper than decoding full resolution frames. If that doesn't yield a
+ picture, the extractor falls back to decoding every frame.
+ */
+class CDVDThumbnailExtractor
+{
+public:
+  /*!
+   \param width width of the extracted pictures
+   \param keyframesOnly whether to only decode keyframes (at reduced resolution)
+   */
+  CDVDThumbnailExtractor(unsigned int width, bool keyframesOnly = true);
+  ~CDVDThumbnailExtractor();
+
+  /*!
+   \brief Open the given file and the decoder for its video stream.
+   \return true if the file could be demuxed, false otherwise.
+   */
+  bool Open(const std::string &path);
+  void Close();
+
+  CDVDInputStream* GetInputStream() const { return m_inputStream.get(); }
+  CDVDDemux* GetDemuxer() const { return m_demuxer.get(); }
+
+  /*!
+   \brief Retrieve the length of the video in milliseconds.
+   */
+  int GetStreamLength() const;
+
+  /*!
+   \brief Whether the file has a video stream that can be decoded.
+   */
+  bool HasVideo() const { return m_codec != nullptr; }
+
+  /*!
+   \brief Extract the picture at the given position.
+   \param pos position in milliseconds, the picture is taken from the closest preceding keyframe
+   \param pixels [out] the picture as BGRA pixels with a stride of width * 4
+   \param height [out] the height of the picture
+   \param orientation [out] the (EXIF) orientation of the picture
+   \return true if a picture was extracted, false otherwise.
+   */
+  bool Extract(int pos, std::vector<uint8_t> &pixels, unsigned int &height, int &orientation);
+
+  /*!
+   \brief Retrieve the number of packets read by the last call to Extract().
+   */
+  int GetPacketsTried() const { return m_packetsTried; }
+
+private:
+  CDVDThumbnailExtractor(const CDVDThumbnailExtractor&);
+  CDVDThumbnailExtractor const& operator=(CDVDThumbnailExtractor const&);
+
+  bool OpenCodec(bool keyframesOnly);
+  bool Decode(int pos, DVDVideoPicture &picture);
+  bool Scale(const DVDVideoPicture &picture, std::vector<uint8_t> &pixels, unsigned int &height) const;
+
+  static int DegreeToOrientation(int degrees);
+
+  unsigned int m_width;
+  bool m_keyframesOnly;
+  std::string m_redactedPath;
+
+  std::unique_ptr<CDVDInputStream> m_inputStream;
+  std::unique_ptr<CDVDDemux> m_demuxer;
+  std::unique_ptr<CDVDVideoCodec> m_codec;
+  CDVDStreamInfo m_hint;
+  int m_videoStream;
+  bool m_codecKeyframesOnly;
+  int m_packetsTried;
+};
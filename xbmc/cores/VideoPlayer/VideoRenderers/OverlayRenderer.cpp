@@ -78,6 +78,10 @@ void CRenderer::AddOverlay(CDVDOverlay* o, double pts, int index)
   e.pts = pts;
   e.overlay_dvd = o->Acquire();
   m_buffers[index].push_back(e);
+
+  // rasterize the subtitles before the frame is due for presentation
+  if (o->IsOverlayType(DVDOVERLAY_TYPE_SSA))
+    m_ssaRasterizer.Prerender((CDVDOverlaySSA*)o, pts);
 }
 
 void CRenderer::Release(std::vector<SElement>& list)
@@ -100,6 +104,7 @@ void CRenderer::Flush()
     Release(m_buffers[i]);
 
   ReleaseCache();
+  m_ssaRasterizer.Flush();
 }
 
 void CRenderer::Release(int idx)
@@ -116,6 +121,7 @@ void CRenderer::ReleaseCache()
   }
   m_textureCache.clear();
   m_textureid++;
+  m_ssaQuads.reset();
 }
 
 void CRenderer::ReleaseUnused()
@@ -336,24 +342,22 @@ COverlay* CRenderer::Convert(CDVDOverlaySSA* o, double pts)
   }
   else
     position = 0.0;
-  int changes = 0;
-  ASS_Image* images = o->m_libass->RenderImage(targetWidth, targetHeight, videoWidth, videoHeight, pts, useMargin, position, &changes);
+  CSSARasterizer::SParams params = { targetWidth, targetHeight, videoWidth, videoHeight, useMargin, position };
+  std::shared_ptr<SQuads> quads = m_ssaRasterizer.Get(o, pts, params);
 
-  if(o->m_textureid)
+  // the glyphs are shared with the previous frame if nothing changed
+  if(o->m_textureid && quads == m_ssaQuads)
   {
-    if(changes == 0)
-    {
-      std::map<unsigned int, COverlay*>::iterator it = m_textureCache.find(o->m_textureid);
-      if (it != m_textureCache.end())
-        return it->second;
-    }
+    std::map<unsigned int, COverlay*>::iterator it = m_textureCache.find(o->m_textureid);
+    if (it != m_textureCache.end())
+      return it->second;
   }
 
   COverlay *overlay = NULL;
 #if defined(HAS_GL) || defined(HAS_GLES)
-  overlay = new COverlayGlyphGL(images, targetWidth, targetHeight);
+  overlay = new COverlayGlyphGL(*quads, targetWidth, targetHeight);
 #elif defined(HAS_DX)
-  overlay = new COverlayQuadsDX(images, targetWidth, targetHeight);
+  overlay = new COverlayQuadsDX(*quads, targetWidth, targetHeight);
 #endif
   // scale to video dimensions
   if (overlay)
@@ -363,6 +367,7 @@ COverlay* CRenderer::Convert(CDVDOverlaySSA* o, double pts)
     overlay->m_x = ((float)videoWidth - targetWidth) / 2 / videoWidth;
     overlay->m_y = ((float)videoHeight - targetHeight) / 2 / videoHeight;
   }
+  m_ssaQuads = quads;
   m_textureCache[m_textureid] = overlay;
   o->m_textureid = m_textureid;
   m_textureid++;
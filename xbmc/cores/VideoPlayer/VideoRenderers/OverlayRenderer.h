@@ -23,9 +23,11 @@
 
 #include "threads/CriticalSection.h"
 #include "BaseRenderer.h"
+#include "OverlayRendererSSA.h"
 
 #include <vector>
 #include <map>
+#include <memory>
 
 class CDVDOverlay;
 class CDVDOverlayImage;
@@ -113,6 +115,8 @@ namespace OVERLAY {
     std::vector<SElement> m_buffers[NUM_BUFFERS];
     std::map<unsigned int, COverlay*> m_textureCache;
     static unsigned int m_textureid;
+    CSSARasterizer m_ssaRasterizer;
+    std::shared_ptr<SQuads> m_ssaQuads; // glyphs of the last overlay created for ssa subtitles
     CRect m_rv, m_rs, m_rd;
   };
 }
@@ -27,12 +27,13 @@ class CDVDOverlay;
 class CDVDOverlayImage;
 class CDVDOverlaySpu;
 class CDVDOverlaySSA;
-typedef struct ass_image ASS_Image;
 
 #if defined(HAS_GL) || HAS_GLES == 2
 
 namespace OVERLAY {
 
+  struct SQuads;
+
   class COverlayTextureGL : public COverlay
   {
   public:
@@ -51,7 +52,7 @@ namespace OVERLAY {
   class COverlayGlyphGL : public COverlay
   {
   public:
-   COverlayGlyphGL(ASS_Image* images, int width, int height);
+   COverlayGlyphGL(const SQuads& quads, int width, int height);
 
    virtual ~COverlayGlyphGL();
 
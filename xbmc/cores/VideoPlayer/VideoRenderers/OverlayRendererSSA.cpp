@@ -0,0 +1,235 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "OverlayRendererSSA.h"
+#include "OverlayRendererUtil.h"
+#include "cores/VideoPlayer/DVDClock.h"
+#include "cores/VideoPlayer/DVDCodecs/Overlay/DVDOverlaySSA.h"
+#include "threads/SingleLock.h"
+
+// number of frames rasterized ahead of the last one queued for presentation
+#define SSA_PRERENDER_FRAMES 8
+// upper bound of rasterized frames kept, e.g. while the presentation is paused
+#define SSA_MAX_FRAMES       32
+// larger gaps between queued frames aren't used to predict the following ones
+#define SSA_MAX_INTERVAL     250
+
+using namespace OVERLAY;
+
+bool CSSARasterizer::SParams::operator==(const SParams& right) const
+{
+  return targetWidth  == right.targetWidth
+      && targetHeight == right.targetHeight
+      && videoWidth   == right.videoWidth
+      && videoHeight  == right.videoHeight
+      && useMargin    == right.useMargin
+      && position     == right.position;
+}
+
+CSSARasterizer::CSSARasterizer()
+  : CThread("SSARasterizer")
+  , m_libass(NULL)
+  , m_hasParams(false)
+  , m_generation(0)
+  , m_requested(-1)
+  , m_interval(0)
+  , m_lastGeneration(0)
+{
+  m_params.targetWidth  = 0;
+  m_params.targetHeight = 0;
+  m_params.videoWidth   = 0;
+  m_params.videoHeight  = 0;
+  m_params.useMargin    = 0;
+  m_params.position     = 0.0;
+}
+
+CSSARasterizer::~CSSARasterizer()
+{
+  m_bStop = true;
+  m_event.Set();
+  StopThread();
+
+  if (m_libass)
+    m_libass->Release();
+}
+
+void CSSARasterizer::Prerender(CDVDOverlaySSA* o, double pts)
+{
+  if (pts == DVD_NOPTS_VALUE)
+    return;
+
+  CSingleLock lock(m_section);
+  if (o->m_libass != m_libass)
+    Reset(o->m_libass);
+
+  // the size of the frames isn't known until the renderer presented the first one
+  if (!m_hasParams)
+    return;
+
+  int time = DVD_TIME_TO_MSEC(pts);
+  if (m_requested >= 0 && time > m_requested && time - m_requested <= SSA_MAX_INTERVAL)
+    m_interval = time - m_requested;
+  m_requested = time;
+
+  if (!IsRunning())
+    Create();
+  m_event.Set();
+}
+
+std::shared_ptr<SQuads> CSSARasterizer::Get(CDVDOverlaySSA* o, double pts, const SParams& params)
+{
+  int time = DVD_TIME_TO_MSEC(pts);
+
+  {
+    CSingleLock lock(m_section);
+    if (o->m_libass != m_libass)
+      Reset(o->m_libass);
+
+    if (!m_hasParams || params != m_params)
+    {
+      m_params = params;
+      m_hasParams = true;
+      m_frames.clear();
+      m_generation++;
+    }
+
+    m_frames.erase(m_frames.begin(), m_frames.lower_bound(time));
+
+    std::map<int, std::shared_ptr<SQuads> >::iterator it = m_frames.find(time);
+    if (it != m_frames.end())
+      return it->second;
+  }
+
+  // the rasterizer may just be working on this frame
+  CSingleLock renderLock(m_renderSection);
+  unsigned int generation;
+  {
+    CSingleLock lock(m_section);
+    std::map<int, std::shared_ptr<SQuads> >::iterator it = m_frames.find(time);
+    if (it != m_frames.end())
+      return it->second;
+
+    generation = m_generation;
+  }
+
+  std::shared_ptr<SQuads> quads = Rasterize(o->m_libass, params, generation, time);
+
+  CSingleLock lock(m_section);
+  if (generation == m_generation)
+    m_frames[time] = quads;
+
+  return quads;
+}
+
+void CSSARasterizer::Flush()
+{
+  CSingleLock renderLock(m_renderSection);
+  CSingleLock lock(m_section);
+  Reset(NULL);
+  m_last.reset();
+}
+
+void CSSARasterizer::Process()
+{
+  while (!m_bStop)
+  {
+    {
+      CSingleLock renderLock(m_renderSection);
+      CDVDSubtitlesLibass* libass = NULL;
+      SParams params;
+      unsigned int generation;
+      int time;
+      {
+        CSingleLock lock(m_section);
+        if (GetNextFrame(time))
+        {
+          libass = m_libass->Acquire();
+          params = m_params;
+          generation = m_generation;
+        }
+      }
+
+      if (libass)
+      {
+        std::shared_ptr<SQuads> quads = Rasterize(libass, params, generation, time);
+        libass->Release();
+
+        CSingleLock lock(m_section);
+        if (generation == m_generation)
+          m_frames[time] = quads;
+        continue;
+      }
+    }
+
+    m_event.Wait();
+  }
+}
+
+void CSSARasterizer::Reset(CDVDSubtitlesLibass* libass)
+{
+  if (m_libass)
+    m_libass->Release();
+  m_libass = libass ? libass->Acquire() : NULL;
+
+  m_frames.clear();
+  m_requested = -1;
+  m_interval = 0;
+  m_generation++;
+}
+
+bool CSSARasterizer::GetNextFrame(int& time)
+{
+  if (!m_libass || !m_hasParams || m_requested < 0 || m_frames.size() >= SSA_MAX_FRAMES)
+    return false;
+
+  for (int i = 0; i < SSA_PRERENDER_FRAMES; i++)
+  {
+    int next = m_requested + i * m_interval;
+    if (m_frames.find(next) == m_frames.end())
+    {
+      time = next;
+      return true;
+    }
+
+    if (m_interval == 0)
+      break;
+  }
+
+  return false;
+}
+
+std::shared_ptr<SQuads> CSSARasterizer::Rasterize(CDVDSubtitlesLibass* libass, const SParams& params, unsigned int generation, int time)
+{
+  int changes = 0;
+  ASS_Image* images = libass->RenderImage(params.targetWidth, params.targetHeight, params.videoWidth, params.videoHeight,
+                                          DVD_MSEC_TO_TIME(time), params.useMargin, params.position, &changes);
+
+  // libass compares with the frame it rendered last, which may have been for other parameters
+  if (changes == 0 && m_last && m_lastGeneration == generation)
+    return m_last;
+
+  std::shared_ptr<SQuads> quads(new SQuads());
+  convert_quad(images, *quads);
+
+  m_last = quads;
+  m_lastGeneration = generation;
+  return quads;
+}
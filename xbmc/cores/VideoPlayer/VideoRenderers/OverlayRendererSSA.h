@@ -0,0 +1,106 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <memory>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+class CDVDOverlaySSA;
+class CDVDSubtitlesLibass;
+
+namespace OVERLAY {
+
+  struct SQuads;
+
+  /*!
+   \brief Rasterizes SSA/ASS subtitles ahead of their presentation.
+
+   libass renders complex typesetting slowly, which used to happen on the render
+   thread for every displayed frame. The rasterizer renders the frames queued for
+   presentation (and the ones expected to follow them) on its own thread, the
+   render thread only picks up the result and falls back to rendering it itself
+   when the rasterizer didn't get to it in time.
+
+   Frames that libass reports to be unchanged share their rasterized glyphs, so
+   the renderer can keep using the texture it created for them.
+   */
+  class CSSARasterizer : private CThread
+  {
+  public:
+    struct SParams
+    {
+      int    targetWidth;
+      int    targetHeight;
+      int    videoWidth;
+      int    videoHeight;
+      int    useMargin;
+      double position;
+
+      bool operator==(const SParams& right) const;
+      bool operator!=(const SParams& right) const { return !(*this == right); }
+    };
+
+    CSSARasterizer();
+    virtual ~CSSARasterizer();
+
+    /*!
+     \brief Queue the rasterization of the given subtitles at pts and the frames after it.
+     */
+    void Prerender(CDVDOverlaySSA* o, double pts);
+
+    /*!
+     \brief Retrieve the subtitles to present at pts, they are rasterized right away if necessary.
+     Frames before pts are dropped, the presentation time is expected to increase.
+     */
+    std::shared_ptr<SQuads> Get(CDVDOverlaySSA* o, double pts, const SParams& params);
+
+    void Flush();
+
+  protected:
+    virtual void Process();
+
+  private:
+    void Reset(CDVDSubtitlesLibass* libass);
+    bool GetNextFrame(int& time);
+    std::shared_ptr<SQuads> Rasterize(CDVDSubtitlesLibass* libass, const SParams& params, unsigned int generation, int time);
+
+    CCriticalSection m_section;
+    CCriticalSection m_renderSection;
+    CEvent m_event;
+
+    CDVDSubtitlesLibass* m_libass;
+    SParams m_params;
+    bool m_hasParams;
+    unsigned int m_generation;
+
+    std::map<int, std::shared_ptr<SQuads> > m_frames;
+    int m_requested;
+    int m_interval;
+
+    // result of the last call to libass, reused if it reports no changes
+    std::shared_ptr<SQuads> m_last;
+    unsigned int m_lastGeneration;
+  };
+
+}
@@ -468,6 +468,10 @@ void CCurlFile::SetCommonOptions(CReadState* state)
 
   g_curlInterface.easy_setopt(h, CURLOPT_DEBUGFUNCTION, debug_callback);
 
+  // share connections, dns lookups and tls sessions with all other handles
+  if (g_curlInterface.GetShare())
+    g_curlInterface.easy_setopt(h, CURLOPT_SHARE, g_curlInterface.GetShare());
+
   if( g_advancedSettings.m_logLevel >= LOG_LEVEL_DEBUG )
     g_curlInterface.easy_setopt(h, CURLOPT_VERBOSE, TRUE);
   else
@@ -93,6 +93,7 @@ namespace XFILE
       void SetBufferSize(unsigned int size);
 
       const CHttpHeader& GetHttpHeader() const { return m_state->m_httpheader; }
+      long GetResponseCode() const { return m_httpresponse; }
       std::string GetServerReportedCharset(void);
 
       /* static function that will get content type of a file */
@@ -50,6 +50,7 @@ namespace XFILE
     CDirectoryCache(void);
     virtual ~CDirectoryCache(void);
     bool GetDirectory(const std::string& strPath, CFileItemList &items, bool retrieveAll = false);
+    bool HasDirectory(const std::string& strPath);
     void SetDirectory(const std::string& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType);
     void ClearDirectory(const std::string& strPath);
     void ClearFile(const std::string& strFile);
@@ -0,0 +1,207 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DirectoryWalker.h"
+
+#include <algorithm>
+
+#include "Directory.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+using namespace XFILE;
+
+CDirectoryWalker::CWorker::CWorker(CDirectoryWalker &walker, unsigned int id)
+  : CThread(StringUtils::Format("DirectoryWalker-%u", id).c_str()),
+    m_walker(walker)
+{ }
+
+void CDirectoryWalker::CWorker::Process()
+{
+  while (!m_bStop)
+  {
+    std::string directory, share;
+    if (!m_walker.GetWork(directory, share))
+      continue;
+
+    std::shared_ptr<CFileItemList> items(new CFileItemList);
+    CDirectory::GetDirectory(directory, *items, m_walker.m_mask, m_walker.m_flags);
+    m_walker.WorkDone(directory, share, items);
+  }
+}
+
+CDirectoryWalker::CDirectoryWalker(const std::string &mask, int flags, unsigned int maxPerShare)
+  : m_mask(mask),
+    m_flags(flags),
+    m_maxPerShare(std::max(maxPerShare, 1U)),
+    m_workEvent(true),
+    m_resultEvent(true),
+    m_stopped(true),
+    m_inFlight(0)
+{ }
+
+CDirectoryWalker::~CDirectoryWalker()
+{
+  Stop();
+}
+
+std::string CDirectoryWalker::GetShare(const std::string &directory)
+{
+  // local directories all compete for the same disk
+  if (!URIUtils::IsRemote(directory))
+    return "";
+
+  CURL url(directory);
+  std::string share = url.GetFileName();
+  size_t slash = share.find('/');
+  if (slash != std::string::npos)
+    share.erase(slash);
+
+  return StringUtils::Format("%s://%s:%i/%s", url.GetProtocol().c_str(), url.GetHostName().c_str(), url.GetPort(), share.c_str());
+}
+
+void CDirectoryWalker::Start(const std::string &directory)
+{
+  Stop();
+
+  {
+    CSingleLock lock(m_section);
+    m_stopped = false;
+    m_pending.clear();
+    m_queued.clear();
+    m_busy.clear();
+    m_results.clear();
+    Queue(directory);
+  }
+
+  // local directories are listed one at a time anyway
+  const unsigned int workers = GetShare(directory).empty() ? 1 : m_maxPerShare;
+  for (unsigned int i = 0; i < workers; i++)
+  {
+    m_workers.push_back(std::unique_ptr<CWorker>(new CWorker(*this, i)));
+    m_workers.back()->Create();
+  }
+}
+
+void CDirectoryWalker::Stop()
+{
+  {
+    CSingleLock lock(m_section);
+    m_stopped = true;
+    m_pending.clear();
+  }
+
+  for (std::vector<std::unique_ptr<CWorker> >::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    (*it)->StopThread(false);
+  m_workEvent.Set();
+  for (std::vector<std::unique_ptr<CWorker> >::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    (*it)->StopThread(true);
+
+  m_workers.clear();
+  m_inFlight = 0;
+  m_resultEvent.Set();
+}
+
+bool CDirectoryWalker::GetNext(std::string &directory, CFileItemList &items)
+{
+  CSingleLock lock(m_section);
+  while (true)
+  {
+    if (!m_results.empty())
+    {
+      directory = m_results.front().first;
+      items.Assign(*m_results.front().second);
+      m_results.pop_front();
+      return true;
+    }
+
+    // nothing left to list, and nothing being listed
+    if (m_stopped || (m_pending.empty() && m_inFlight == 0))
+      return false;
+
+    // the event is set by every finished listing and by Stop()
+    m_resultEvent.Reset();
+    CSingleExit exit(m_section);
+    m_resultEvent.Wait();
+  }
+}
+
+bool CDirectoryWalker::GetWork(std::string &directory, std::string &share)
+{
+  {
+    CSingleLock lock(m_section);
+    if (!m_stopped)
+    {
+      // take the first directory whose share has a worker to spare
+      for (std::deque<std::string>::iterator it = m_pending.begin(); it != m_pending.end(); ++it)
+      {
+        std::string candidate = GetShare(*it);
+        unsigned int &busy = m_busy[candidate];
+        if (busy < (candidate.empty() ? 1 : m_maxPerShare))
+        {
+          directory = *it;
+          share = candidate;
+          busy++;
+          m_inFlight++;
+          m_pending.erase(it);
+          return true;
+        }
+      }
+    }
+
+    m_workEvent.Reset();
+  }
+
+  // the event is set by every finished listing and by Stop()
+  m_workEvent.Wait();
+  return false;
+}
+
+void CDirectoryWalker::WorkDone(const std::string &directory, const std::string &share, const std::shared_ptr<CFileItemList> &items)
+{
+  CSingleLock lock(m_section);
+  m_inFlight--;
+  m_busy[share]--;
+
+  if (!m_stopped)
+  {
+    // queue the subfolders before handing out the listing so the walk continues
+    // while the consumer processes it
+    for (int i = 0; i < items->Size(); i++)
+    {
+      const CFileItemPtr item = items->Get(i);
+      if (item->m_bIsFolder && !item->IsParentFolder() && !item->IsPath(".."))
+        Queue(item->GetPath());
+    }
+    m_results.push_back(Listing(directory, items));
+  }
+
+  m_workEvent.Set();
+  m_resultEvent.Set();
+}
+
+void CDirectoryWalker::Queue(const std::string &directory)
+{
+  if (m_queued.insert(directory).second)
+    m_pending.push_back(directory);
+}
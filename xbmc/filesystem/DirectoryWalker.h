@@ -0,0 +1,111 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+class CFileItemList;
+
+namespace XFILE
+{
+  /*!
+   \brief Lists a directory tree with several directories in flight at once.
+
+   Each listed directory is handed to the consumer through GetNext() as soon as
+   it has been retrieved, while its subfolders are already queued for listing.
+   Listings therefore arrive in completion order rather than tree order.
+   Directories on the same share are listed by at most a fixed number of
+   workers at a time, local directories one at a time by a single worker.
+   */
+  class CDirectoryWalker
+  {
+  public:
+    /*!
+     \param mask the file mask passed to CDirectory::GetDirectory()
+     \param flags the DIR_FLAG_* flags passed to CDirectory::GetDirectory()
+     \param maxPerShare maximum number of concurrent listings on a remote share
+     */
+    CDirectoryWalker(const std::string &mask, int flags, unsigned int maxPerShare = 4);
+    ~CDirectoryWalker();
+
+    /*!
+     \brief Start walking the tree below (and including) the given directory.
+     */
+    void Start(const std::string &directory);
+    void Stop();
+
+    /*!
+     \brief Retrieve the next listed directory, waiting for it if necessary.
+     \param directory [out] the path of the listed directory
+     \param items [out] the listing of the directory
+     \return true if a listing was retrieved, false once the whole tree has been walked.
+     */
+    bool GetNext(std::string &directory, CFileItemList &items);
+
+    /*!
+     \brief Retrieve the key used to limit the concurrent listings of a directory's share.
+     */
+    static std::string GetShare(const std::string &directory);
+
+  private:
+    class CWorker : public CThread
+    {
+    public:
+      CWorker(CDirectoryWalker &walker, unsigned int id);
+
+    protected:
+      virtual void Process();
+
+    private:
+      CDirectoryWalker &m_walker;
+    };
+
+    typedef std::pair<std::string, std::shared_ptr<CFileItemList> > Listing;
+
+    bool GetWork(std::string &directory, std::string &share);
+    void WorkDone(const std::string &directory, const std::string &share, const std::shared_ptr<CFileItemList> &items);
+    void Queue(const std::string &directory);
+
+    std::string m_mask;
+    int m_flags;
+    unsigned int m_maxPerShare;
+
+    CCriticalSection m_section;
+    CEvent m_workEvent;
+    CEvent m_resultEvent;
+    bool m_stopped;
+    unsigned int m_inFlight;
+    std::deque<std::string> m_pending;
+    std::set<std::string> m_queued;                ///< directories queued so far, to guard against cycles
+    std::map<std::string, unsigned int> m_busy;    ///< number of listings in flight per share
+    std::deque<Listing> m_results;
+    std::vector<std::unique_ptr<CWorker> > m_workers;
+  };
+}
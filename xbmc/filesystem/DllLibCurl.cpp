@@ -61,6 +61,24 @@ unsigned long ssl_thread_id(void)
 
 using namespace XCURL;
 
+/* maximum number of idle sessions kept around per host if connections are shared */
+#define MAX_IDLE_SESSIONS_PER_HOST 4
+/* maximum number of concurrent transfers to a host, and how long to wait for one to finish */
+#define MAX_BUSY_SESSIONS_PER_HOST 16
+#define MAX_BUSY_SESSIONS_WAIT     2000 // ms
+
+static CCriticalSection g_curlShareLocks[CURL_LOCK_DATA_LAST];
+
+static void share_lock_callback(CURL_HANDLE *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+  g_curlShareLocks[data].lock();
+}
+
+static void share_unlock_callback(CURL_HANDLE *handle, curl_lock_data data, void *userptr)
+{
+  g_curlShareLocks[data].unlock();
+}
+
 /* okey this is damn ugly. our dll loader doesn't allow for postload, preunload functions */
 static long g_curlReferences = 0;
 #if(0)
@@ -88,6 +106,8 @@ bool DllLibCurlGlobal::Load()
     return false;
   }
 
+  CreateShare();
+
   /* check idle will clean up the last one */
   g_curlReferences = 2;
 
@@ -112,6 +132,8 @@ void DllLibCurlGlobal::Unload()
     if (!IsLoaded())
       return;
 
+    DestroyShare();
+
     // close libcurl
     global_cleanup();
 
@@ -151,6 +173,8 @@ void DllLibCurlGlobal::CheckIdle()
     if( !it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > idletime )
     {
       CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__, it->m_protocol.c_str(), it->m_hostname.c_str(), (void*)it->m_easy, (void*)it->m_multi);
+      CLog::Log(LOGDEBUG, "%s - %u connections created, %u handshakes saved by reusing connections", __FUNCTION__,
+                m_connectionsCreated.load(), m_connectionsReused.load());
 
       // It's important to clean up multi *before* cleaning up easy, because the multi cleanup
       // code accesses stuff in the easy's structure.
@@ -180,6 +204,12 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
 
   CSingleLock lock(m_critSection);
 
+  /* limit the connections to a host. Callers may hold on to a session while
+   * acquiring another one, so we don't wait forever for one to be released */
+  XbmcThreads::EndTime timeout(MAX_BUSY_SESSIONS_WAIT);
+  while (GetSessionCount(protocol, hostname, true) >= MAX_BUSY_SESSIONS_PER_HOST && !timeout.IsTimePast())
+    m_sessionReleased.wait(lock, timeout.MillisLeft());
+
   VEC_CURLSESSIONS::iterator it;
   for(it = m_sessions.begin(); it != m_sessions.end(); ++it)
   {
@@ -264,6 +294,25 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
   {
     if( it->m_easy == easy && (multi == NULL || it->m_multi == multi) )
     {
+      if (easy)
+        UpdateConnectionStats(easy);
+
+      m_sessionReleased.notifyAll();
+
+      /* if connections live in the shared cache, there is no point in
+       * keeping more than a few idle handles around for the same host */
+      if (m_shareConnections && GetSessionCount(it->m_protocol, it->m_hostname, false) >= MAX_IDLE_SESSIONS_PER_HOST)
+      {
+        if (it->m_multi)
+          multi_cleanup(it->m_multi);
+        if (it->m_easy)
+          easy_cleanup(it->m_easy);
+
+        m_sessions.erase(it);
+        Unload();
+        return;
+      }
+
       /* reset session so next caller doesn't reuse options, only connections */
       /* will reset verbose too so it won't print that it closed connections on cleanup*/
       easy_reset(easy);
@@ -274,6 +323,78 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
   }
 }
 
+unsigned int DllLibCurlGlobal::GetSessionCount(const std::string& protocol, const std::string& hostname, bool busy) const
+{
+  unsigned int count = 0;
+  for (VEC_CURLSESSIONS::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it)
+  {
+    if (it->m_busy == busy && it->m_protocol == protocol && it->m_hostname == hostname)
+      count++;
+  }
+  return count;
+}
+
+void DllLibCurlGlobal::UpdateConnectionStats(CURL_HANDLE* easy_handle)
+{
+  /* only handles which actually performed a transfer got a response */
+  long responseCode = 0;
+  if (easy_getinfo(easy_handle, CURLINFO_RESPONSE_CODE, &responseCode) != CURLE_OK || responseCode == 0)
+    return;
+
+  long connects = 0;
+  if (easy_getinfo(easy_handle, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK)
+    return;
+
+  if (connects == 0)
+    m_connectionsReused++;
+  else
+    m_connectionsCreated += static_cast<unsigned int>(connects);
+}
+
+void DllLibCurlGlobal::CreateShare()
+{
+  m_share = share_init();
+  if (!m_share)
+  {
+    CLog::Log(LOGWARNING, "%s - unable to create shared connection cache", __FUNCTION__);
+    return;
+  }
+
+  share_setopt(m_share, CURLSHOPT_LOCKFUNC, share_lock_callback);
+  share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, share_unlock_callback);
+  share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+  /* sharing the connection cache is supported since 7.57.0, the loaded library may be older */
+  m_shareConnections = share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT) == CURLSHE_OK;
+#endif
+}
+
+void DllLibCurlGlobal::DestroyShare()
+{
+  if (!m_share)
+    return;
+
+  /* the share can't be cleaned up while handles still use it */
+  if (share_cleanup(m_share) == CURLSHE_IN_USE)
+  {
+    for (VEC_CURLSESSIONS::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it)
+    {
+      if (it->m_easy)
+        easy_setopt(it->m_easy, CURLOPT_SHARE, static_cast<CURLSH*>(NULL));
+    }
+
+    if (share_cleanup(m_share) == CURLSHE_IN_USE)
+    {
+      /* leak it rather than pulling it away from under the handles */
+      CLog::Log(LOGWARNING, "%s - shared connection cache is still in use", __FUNCTION__);
+    }
+  }
+
+  m_share = NULL;
+  m_shareConnections = false;
+}
+
 CURL_HANDLE* DllLibCurlGlobal::easy_duphandle(CURL_HANDLE* easy_handle)
 {
   CSingleLock lock(m_critSection);
@@ -20,7 +20,9 @@
  */
 
 #include "DynamicDll.h"
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
+#include <atomic>
 #include <stdio.h>
 #include <vector>
 
@@ -55,6 +57,9 @@ namespace XCURL
     virtual void multi_cleanup(CURL_HANDLE * handle )=0;
     virtual struct curl_slist* slist_append(struct curl_slist *, const char *)=0;
     virtual void  slist_free_all(struct curl_slist *)=0;
+    virtual CURLSH* share_init(void)=0;
+    //virtual CURLSHcode share_setopt(CURLSH *share, CURLSHoption option, ...)=0;
+    virtual CURLSHcode share_cleanup(CURLSH *share)=0;
   };
 
   class DllLibCurl : public DllDynamic, DllLibCurlInterface
@@ -81,6 +86,9 @@ namespace XCURL
     DEFINE_METHOD2(struct curl_slist*, slist_append, (struct curl_slist * p1, const char * p2))
     DEFINE_METHOD1(void, slist_free_all, (struct curl_slist * p1))
     DEFINE_METHOD1(const char *, easy_strerror, (CURLcode p1))
+    DEFINE_METHOD0(CURLSH *, share_init)
+    DEFINE_METHOD_FP(CURLSHcode, share_setopt, (CURLSH *p1, CURLSHoption p2, ...))
+    DEFINE_METHOD1(CURLSHcode, share_cleanup, (CURLSH *p1))
 #if defined(HAS_CURL_STATIC)
     DEFINE_METHOD1(void, crypto_set_id_callback, (unsigned long (*p1)(void)))
     DEFINE_METHOD1(void, crypto_set_locking_callback, (void (*p1)(int, int, const char *, int)))
@@ -107,6 +115,9 @@ namespace XCURL
       RESOLVE_METHOD_RENAME(curl_multi_cleanup, multi_cleanup)
       RESOLVE_METHOD_RENAME(curl_slist_append, slist_append)
       RESOLVE_METHOD_RENAME(curl_slist_free_all, slist_free_all)
+      RESOLVE_METHOD_RENAME(curl_share_init, share_init)
+      RESOLVE_METHOD_RENAME_FP(curl_share_setopt, share_setopt)
+      RESOLVE_METHOD_RENAME(curl_share_cleanup, share_cleanup)
 #if defined(HAS_CURL_STATIC)
       RESOLVE_METHOD_RENAME(CRYPTO_set_id_callback, crypto_set_id_callback)
       RESOLVE_METHOD_RENAME(CRYPTO_set_locking_callback, crypto_set_locking_callback)
@@ -118,6 +129,8 @@ namespace XCURL
   class DllLibCurlGlobal : public DllLibCurl
   {
   public:
+    DllLibCurlGlobal() : m_share(NULL), m_shareConnections(false), m_connectionsCreated(0), m_connectionsReused(0) {}
+
     /* extend interface with buffered functions */
     void easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle);
     void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle);
@@ -125,6 +138,9 @@ namespace XCURL
     CURL_HANDLE* easy_duphandle(CURL_HANDLE* easy_handle);
     void CheckIdle();
 
+    /* process wide connection, dns and tls session cache shared by all handles */
+    CURLSH* GetShare() const { return m_share; }
+
     /* overloaded load and unload with reference counter */
     virtual bool Load();
     virtual void Unload();
@@ -144,6 +160,18 @@ namespace XCURL
 
     VEC_CURLSESSIONS m_sessions;
     CCriticalSection m_critSection;
+
+  private:
+    void CreateShare();
+    void DestroyShare();
+    void UpdateConnectionStats(CURL_HANDLE* easy_handle);
+    unsigned int GetSessionCount(const std::string& protocol, const std::string& hostname, bool busy) const;
+
+    CURLSH* m_share;
+    bool m_shareConnections; /* whether the share holds the connection cache */
+    XbmcThreads::ConditionVariable m_sessionReleased;
+    std::atomic<unsigned int> m_connectionsCreated;
+    std::atomic<unsigned int> m_connectionsReused;
   };
 }
 
@@ -25,6 +25,7 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "MultiRangeReader.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "settings/AdvancedSettings.h"
@@ -44,6 +45,7 @@
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
+#define READ_AHEAD_SEGMENT_SIZE (1024*1024)
 
 class CWriteRate
 {
@@ -109,6 +111,7 @@ CFileCache::CFileCache(const unsigned int flags)
   , m_pCache(NULL)
   , m_bDeleteCache(true)
   , m_seekPossible(0)
+  , m_sourceEnd(0)
   , m_nSeekResult(0)
   , m_seekPos(0)
   , m_readPos(0)
@@ -125,6 +128,7 @@ CFileCache::CFileCache(const unsigned int flags)
 CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache /* = true */)
   : CThread("FileCacheStrategy")
   , m_seekPossible(0)
+  , m_sourceEnd(0)
   , m_chunkSize(0)
   , m_writeRate(0)
   , m_writeRateActual(0)
@@ -187,6 +191,14 @@ bool CFileCache::Open(const CURL& url)
   m_chunkSize = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_SIZE);
   m_fileSize = m_source.GetLength();
 
+  // keep several range requests in flight on high latency sources
+  if (g_advancedSettings.m_cacheReadAheadConnections > 1 && m_seekPossible > 0 &&
+      m_fileSize > READ_AHEAD_SEGMENT_SIZE && CMultiRangeReader::IsSupported(url))
+  {
+    CLog::Log(LOGDEBUG, "CFileCache::Open - using up to %u connections to read ahead", g_advancedSettings.m_cacheReadAheadConnections);
+    m_readAhead.reset(new CMultiRangeReader(url, m_fileSize, g_advancedSettings.m_cacheReadAheadConnections, READ_AHEAD_SEGMENT_SIZE));
+  }
+
   if (!m_pCache)
   {
     if (g_advancedSettings.m_cacheMemBufferSize == 0)
@@ -267,6 +279,13 @@ void CFileCache::Process()
   CWriteRate average;
   bool cacheReachEOF = false;
 
+  if (m_readAhead)
+  {
+    // the transfer opened by Open() serves the first segment
+    m_sourceEnd = std::min(static_cast<int64_t>(READ_AHEAD_SEGMENT_SIZE), static_cast<int64_t>(m_fileSize));
+    m_readAhead->Start(m_sourceEnd);
+  }
+
   while (!m_bStop)
   {
     // Update filesize
@@ -279,7 +298,15 @@ void CFileCache::Process()
       int64_t cacheMaxPos = m_pCache->CachedDataEndPosIfSeekTo(m_seekPos);
       cacheReachEOF = (cacheMaxPos == m_fileSize);
       bool sourceSeekFailed = false;
-      if (!cacheReachEOF)
+      if (!cacheReachEOF && m_readAhead)
+      {
+        if (m_sourceEnd > m_writePos)
+          ReleaseSourceStream();
+        m_sourceEnd = 0;
+        m_readAhead->Start(cacheMaxPos);
+        m_nSeekResult = cacheMaxPos;
+      }
+      else if (!cacheReachEOF)
       {
         m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
         if (m_nSeekResult != cacheMaxPos)
@@ -338,7 +365,12 @@ void CFileCache::Process()
 
     ssize_t iRead = 0;
     if (!cacheReachEOF)
-      iRead = m_source.Read(buffer.get(), maxWrite);
+    {
+      iRead = ReadFromSource(buffer.get(), maxWrite);
+      // the next segment is still on its way, go check for seek requests
+      if (iRead == 0 && m_readAhead && !m_readAhead->IsEndOfFile())
+        continue;
+    }
     if (iRead == 0)
     {
       CLog::Log(LOGINFO, "CFileCache::Process - Hit eof.");
@@ -395,6 +427,55 @@ void CFileCache::Process()
   }
 }
 
+ssize_t CFileCache::ReadFromSource(char* buffer, size_t size)
+{
+  if (!m_readAhead)
+    return m_source.Read(buffer, size);
+
+  // the source stream serves the start of the file and the segments the read ahead failed to fetch
+  if (m_writePos < m_sourceEnd)
+  {
+    ssize_t iRead = m_source.Read(buffer, static_cast<size_t>(std::min(static_cast<int64_t>(size), m_sourceEnd - m_writePos)));
+    if (iRead <= 0)
+      return -1;
+
+    if (m_writePos + iRead >= m_sourceEnd)
+      ReleaseSourceStream();
+    return iRead;
+  }
+
+  ssize_t iRead = m_readAhead->Read(buffer, size, 100);
+  if (iRead >= 0)
+    return iRead;
+
+  int64_t segmentEnd = m_readAhead->SkipFailedSegment();
+  if (segmentEnd >= 0)
+  {
+    CLog::Log(LOGDEBUG, "CFileCache::Process - reading the segment at %" PRId64 " from the source stream", m_writePos);
+    if (m_source.Seek(m_writePos, SEEK_SET) != m_writePos)
+      return -1;
+
+    m_sourceEnd = segmentEnd;
+    return ReadFromSource(buffer, size);
+  }
+
+  // fall back to a single stream, e.g. if the server doesn't honour our ranges
+  CLog::Log(LOGWARNING, "CFileCache::Process - read ahead failed, continuing with a single stream at %" PRId64, m_writePos);
+  m_readAhead.reset();
+  if (m_source.Seek(m_writePos, SEEK_SET) != m_writePos)
+    return -1;
+
+  return m_source.Read(buffer, size);
+}
+
+void CFileCache::ReleaseSourceStream()
+{
+  // a request for the last byte completes right away, so the source doesn't hold on
+  // to a stalled transfer while reading ahead. Seeking back reopens it when needed.
+  if (m_fileSize > 0)
+    m_source.Seek(m_fileSize - 1, SEEK_SET);
+}
+
 void CFileCache::OnExit()
 {
   m_bStop = true;
@@ -526,6 +607,7 @@ void CFileCache::Close()
   if (m_pCache)
     m_pCache->Close();
 
+  m_readAhead.reset();
   m_source.Close();
 }
 
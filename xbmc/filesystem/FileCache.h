@@ -25,9 +25,11 @@
 #include "File.h"
 #include "threads/Thread.h"
 #include <atomic>
+#include <memory>
 
 namespace XFILE
 {
+  class CMultiRangeReader;
 
   class CFileCache : public IFile, public CThread
   {
@@ -63,10 +65,15 @@ namespace XFILE
     virtual std::string GetContentCharset(void);
 
   private:
+    ssize_t ReadFromSource(char* buffer, size_t size);
+    void ReleaseSourceStream();
+
     CCacheStrategy *m_pCache;
     bool      m_bDeleteCache;
     int        m_seekPossible;
     CFile      m_source;
+    std::unique_ptr<CMultiRangeReader> m_readAhead;
+    int64_t      m_sourceEnd; ///< while reading ahead, the source is read up to here
     std::string    m_sourcePath;
     CEvent      m_seekEvent;
     CEvent      m_seekEnded;
@@ -0,0 +1,353 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MultiRangeReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "CurlFile.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+using namespace XFILE;
+
+// weight of a new measurement in the smoothed round trip time and bandwidth
+#define MEASUREMENT_WEIGHT 0.2
+// number of times a segment is requested before the caller has to fetch it
+#define MAX_SEGMENT_ATTEMPTS 3
+
+CMultiRangeReader::CConnection::CConnection(CMultiRangeReader& reader, unsigned int id)
+  : CThread(StringUtils::Format("MultiRangeReader-%u", id).c_str()),
+    m_reader(reader)
+{ }
+
+void CMultiRangeReader::CConnection::Process()
+{
+  std::vector<char> data;
+  while (!m_bStop)
+  {
+    int64_t offset;
+    unsigned int length;
+    unsigned int generation;
+    if (!m_reader.GetNextSegment(offset, length, generation))
+      continue;
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    unsigned int firstData = start;
+    FetchResult result = m_reader.Fetch(offset, length, generation, data, firstData);
+    if (result == FETCH_OK && data.size() != length)
+      result = FETCH_FAILED;
+
+    if (result == FETCH_OK)
+      m_reader.SegmentDone(offset, generation, data, firstData - start, XbmcThreads::SystemClockMillis() - firstData);
+    else
+      m_reader.SegmentFailed(offset, length, generation, result);
+  }
+}
+
+CMultiRangeReader::CMultiRangeReader(const CURL& url, int64_t fileSize, unsigned int maxConnections, unsigned int segmentSize)
+  : m_url(url.Get()),
+    m_fileSize(fileSize),
+    m_maxConnections(std::max(maxConnections, 1U)),
+    m_segmentSize(segmentSize),
+    m_workEvent(true),
+    m_stopped(true),
+    m_failed(false),
+    m_generation(0),
+    m_readPos(0),
+    m_requestPos(0),
+    m_inFlight(0),
+    m_window(std::min(2U, m_maxConnections)),
+    m_rtt(0.0),
+    m_bandwidth(0.0)
+{ }
+
+CMultiRangeReader::~CMultiRangeReader()
+{
+  Stop();
+}
+
+bool CMultiRangeReader::IsSupported(const CURL& url)
+{
+  return url.IsProtocol("http") || url.IsProtocol("https") ||
+         url.IsProtocol("dav") || url.IsProtocol("davs");
+}
+
+CMultiRangeReader::FetchResult CMultiRangeReader::Fetch(int64_t offset, unsigned int length, unsigned int generation, std::vector<char>& data, unsigned int& firstData)
+{
+  CCurlFile file;
+  file.SetRequestHeader("Range", StringUtils::Format("bytes=%" PRId64 "-%" PRId64, offset, offset + length - 1));
+  if (!file.Open(CURL(m_url)))
+    return FETCH_FAILED;
+
+  // a server ignoring the range would send us the whole file
+  if (file.GetLength() != static_cast<int64_t>(length))
+  {
+    CLog::Log(LOGWARNING, "CMultiRangeReader - range request for %s returned %" PRId64 " instead of %u bytes",
+              CURL::GetRedacted(m_url).c_str(), file.GetLength(), length);
+    return FETCH_UNSUPPORTED;
+  }
+
+  firstData = XbmcThreads::SystemClockMillis();
+
+  data.resize(length);
+  unsigned int total = 0;
+  while (total < length && IsCurrent(generation))
+  {
+    ssize_t read = file.Read(data.data() + total, length - total);
+    if (read <= 0)
+      return FETCH_FAILED;
+    total += static_cast<unsigned int>(read);
+  }
+
+  return total == length ? FETCH_OK : FETCH_FAILED;
+}
+
+unsigned int CMultiRangeReader::CalculateWindow(unsigned int rtt, double bandwidth, unsigned int segmentSize, unsigned int maxConnections)
+{
+  if (maxConnections <= 1 || bandwidth <= 0.0)
+    return 1;
+
+  // a connection is idle for one round trip per segment, so we need
+  // enough segments in flight to cover that time with transfers
+  double transferTime = 1000.0 * segmentSize / bandwidth;
+  double window = 1.0 + ceil(rtt / std::max(transferTime, 1.0));
+
+  return static_cast<unsigned int>(std::min(window, static_cast<double>(maxConnections)));
+}
+
+void CMultiRangeReader::Start(int64_t position)
+{
+  {
+    CSingleLock lock(m_section);
+    m_generation++;
+    m_segments.clear();
+    m_retries.clear();
+    m_attempts.clear();
+    m_skipped.clear();
+    m_readPos = position;
+    m_requestPos = position;
+    m_failed = false;
+    m_stopped = false;
+  }
+
+  if (m_connections.empty())
+  {
+    for (unsigned int i = 0; i < m_maxConnections; i++)
+    {
+      m_connections.push_back(std::unique_ptr<CConnection>(new CConnection(*this, i)));
+      m_connections.back()->Create();
+    }
+  }
+
+  m_workEvent.Set();
+}
+
+void CMultiRangeReader::Stop()
+{
+  {
+    CSingleLock lock(m_section);
+    m_generation++;
+    m_stopped = true;
+    m_segments.clear();
+  }
+
+  for (std::vector<std::unique_ptr<CConnection> >::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+    (*it)->StopThread(false);
+  m_workEvent.Set();
+  for (std::vector<std::unique_ptr<CConnection> >::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+    (*it)->StopThread(true);
+
+  m_connections.clear();
+  m_inFlight = 0;
+}
+
+ssize_t CMultiRangeReader::Read(char* buffer, size_t size, unsigned int timeout)
+{
+  CSingleLock lock(m_section);
+  for (int attempt = 0; attempt < 2; attempt++)
+  {
+    if (m_failed)
+      return -1;
+
+    if (m_readPos >= m_fileSize)
+      return 0;
+
+    if (m_skipped.find(m_readPos) != m_skipped.end())
+      return -1;
+
+    std::map<int64_t, std::vector<char> >::iterator it = m_segments.upper_bound(m_readPos);
+    if (it != m_segments.begin())
+    {
+      --it;
+      size_t offset = static_cast<size_t>(m_readPos - it->first);
+      if (offset < it->second.size())
+      {
+        size_t length = std::min(size, it->second.size() - offset);
+        memcpy(buffer, it->second.data() + offset, length);
+        m_readPos += length;
+        if (offset + length == it->second.size())
+        {
+          m_segments.erase(it);
+          m_workEvent.Set();
+        }
+        return static_cast<ssize_t>(length);
+      }
+    }
+
+    if (attempt == 0)
+    {
+      CSingleExit exit(m_section);
+      m_dataEvent.WaitMSec(timeout);
+    }
+  }
+
+  return 0;
+}
+
+bool CMultiRangeReader::IsEndOfFile() const
+{
+  CSingleLock lock(m_section);
+  return m_readPos >= m_fileSize;
+}
+
+int64_t CMultiRangeReader::SkipFailedSegment()
+{
+  CSingleLock lock(m_section);
+  std::map<int64_t, unsigned int>::iterator it = m_skipped.find(m_readPos);
+  if (m_failed || it == m_skipped.end())
+    return -1;
+
+  m_readPos += it->second;
+  m_skipped.erase(it);
+  m_workEvent.Set();
+
+  return m_readPos;
+}
+
+unsigned int CMultiRangeReader::GetWindow() const
+{
+  CSingleLock lock(m_section);
+  return m_window;
+}
+
+bool CMultiRangeReader::GetNextSegment(int64_t& offset, unsigned int& length, unsigned int& generation)
+{
+  {
+    CSingleLock lock(m_section);
+    // don't run too far ahead of the reader, the data has to be kept in memory until it's read
+    const int64_t maxAhead = static_cast<int64_t>(m_maxConnections) * m_segmentSize * 2;
+    if (!m_stopped && m_inFlight < m_window && !m_retries.empty())
+    {
+      // failed segments are needed before anything behind them
+      offset = m_retries.begin()->first;
+      length = m_retries.begin()->second;
+      generation = m_generation;
+
+      m_retries.erase(m_retries.begin());
+      m_inFlight++;
+      return true;
+    }
+
+    if (!m_stopped && m_inFlight < m_window &&
+        m_requestPos < m_fileSize && m_requestPos - m_readPos < maxAhead)
+    {
+      offset = m_requestPos;
+      length = static_cast<unsigned int>(std::min(static_cast<int64_t>(m_segmentSize), m_fileSize - m_requestPos));
+      generation = m_generation;
+
+      m_requestPos += length;
+      m_inFlight++;
+      return true;
+    }
+
+    m_workEvent.Reset();
+  }
+
+  m_workEvent.WaitMSec(100);
+  return false;
+}
+
+void CMultiRangeReader::SegmentDone(int64_t offset, unsigned int generation, std::vector<char>& data, unsigned int rtt, unsigned int transferTime)
+{
+  CSingleLock lock(m_section);
+  m_inFlight--;
+
+  if (m_rtt <= 0.0)
+    m_rtt = rtt;
+  else
+    m_rtt += MEASUREMENT_WEIGHT * (rtt - m_rtt);
+
+  double bandwidth = 1000.0 * data.size() / std::max(transferTime, 1U);
+  if (m_bandwidth <= 0.0)
+    m_bandwidth = bandwidth;
+  else
+    m_bandwidth += MEASUREMENT_WEIGHT * (bandwidth - m_bandwidth);
+
+  unsigned int window = CalculateWindow(static_cast<unsigned int>(m_rtt), m_bandwidth, m_segmentSize, m_maxConnections);
+  if (window != m_window)
+  {
+    CLog::Log(LOGDEBUG, "CMultiRangeReader - rtt %.0f ms, %.0f kB/s per connection, using %u connections",
+              m_rtt, m_bandwidth / 1024.0, window);
+    m_window = window;
+  }
+
+  if (generation == m_generation)
+  {
+    m_segments[offset].swap(data);
+    m_attempts.erase(offset);
+    m_dataEvent.Set();
+  }
+  m_workEvent.Set();
+}
+
+void CMultiRangeReader::SegmentFailed(int64_t offset, unsigned int length, unsigned int generation, FetchResult result)
+{
+  CSingleLock lock(m_section);
+  m_inFlight--;
+
+  if (generation == m_generation)
+  {
+    if (result == FETCH_UNSUPPORTED)
+      m_failed = true;
+    else if (++m_attempts[offset] < MAX_SEGMENT_ATTEMPTS)
+      m_retries[offset] = length;
+    else
+    {
+      CLog::Log(LOGWARNING, "CMultiRangeReader - giving up on the segment at %" PRId64 " of %s",
+                offset, CURL::GetRedacted(m_url).c_str());
+      m_attempts.erase(offset);
+      m_skipped[offset] = length;
+    }
+    m_dataEvent.Set();
+  }
+  m_workEvent.Set();
+}
+
+bool CMultiRangeReader::IsCurrent(unsigned int generation) const
+{
+  CSingleLock lock(m_section);
+  return generation == m_generation;
+}
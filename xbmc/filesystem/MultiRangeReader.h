@@ -0,0 +1,156 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+class CURL;
+
+namespace XFILE
+{
+  /*!
+   \brief Reads a file through several concurrent range requests.
+
+   The file is split into segments which are fetched by a pool of connections,
+   each issuing its own range request. Segments may complete out of order and
+   are handed out by Read() in file order. The number of segments in flight is
+   derived from the measured round trip time and per connection bandwidth so
+   that the latency of one request is hidden behind the transfers of the others.
+
+   Failed segments are requested again. Segments that keep failing are skipped
+   with SkipFailedSegment() so the caller can fetch them on its own.
+   */
+  class CMultiRangeReader
+  {
+  public:
+    CMultiRangeReader(const CURL& url, int64_t fileSize, unsigned int maxConnections, unsigned int segmentSize);
+    virtual ~CMultiRangeReader();
+
+    /*!
+     \brief Whether the given url is served by a protocol which supports range requests.
+     */
+    static bool IsSupported(const CURL& url);
+
+    /*!
+     \brief Calculate how many segments need to be in flight to keep a connection busy.
+     \param rtt the time between issuing a request and receiving its first data (in ms)
+     \param bandwidth the transfer rate of a single connection (in bytes per second)
+     \param segmentSize the size of a segment (in bytes)
+     \param maxConnections upper limit for the result
+     \return number of segments to keep in flight, between 1 and maxConnections
+     */
+    static unsigned int CalculateWindow(unsigned int rtt, double bandwidth, unsigned int segmentSize, unsigned int maxConnections);
+
+    /*!
+     \brief Drop all fetched and pending segments and continue reading at the given position.
+     */
+    void Start(int64_t position);
+    void Stop();
+
+    /*!
+     \brief Read the next bytes in file order.
+     \param buffer the buffer to read into
+     \param size the size of the buffer
+     \param timeout how long to wait for the next segment (in ms)
+     \return number of bytes read, 0 if no data arrived within the timeout
+             or the end of the file was reached, -1 if the next segment couldn't
+             be fetched or the server doesn't support range requests
+     */
+    ssize_t Read(char* buffer, size_t size, unsigned int timeout);
+    bool IsEndOfFile() const;
+
+    /*!
+     \brief Give up on the segment at the read position after Read() failed and
+     continue reading behind it.
+     \return the end of the skipped segment, the caller has to fetch the data up to
+             there itself. -1 if range requests aren't supported at all.
+     */
+    int64_t SkipFailedSegment();
+
+    unsigned int GetWindow() const;
+
+  protected:
+    enum FetchResult
+    {
+      FETCH_OK,
+      FETCH_FAILED,      ///< worth trying again
+      FETCH_UNSUPPORTED  ///< the server doesn't honour range requests
+    };
+
+    /*!
+     \brief Fetch a segment, called from the connection threads.
+     Derived classes have to call Stop() in their destructor.
+     \param offset start of the segment
+     \param length size of the segment
+     \param generation pass to IsCurrent() to find out whether the segment is still needed
+     \param data [out] the data of the segment
+     \param firstData [out] the time the first data arrived at (in ms)
+     */
+    virtual FetchResult Fetch(int64_t offset, unsigned int length, unsigned int generation, std::vector<char>& data, unsigned int& firstData);
+    bool IsCurrent(unsigned int generation) const;
+
+  private:
+    class CConnection : public CThread
+    {
+    public:
+      CConnection(CMultiRangeReader& reader, unsigned int id);
+
+    protected:
+      virtual void Process();
+
+    private:
+      CMultiRangeReader& m_reader;
+    };
+
+    bool GetNextSegment(int64_t& offset, unsigned int& length, unsigned int& generation);
+    void SegmentDone(int64_t offset, unsigned int generation, std::vector<char>& data, unsigned int rtt, unsigned int transferTime);
+    void SegmentFailed(int64_t offset, unsigned int length, unsigned int generation, FetchResult result);
+
+    std::string m_url;
+    int64_t m_fileSize;
+    unsigned int m_maxConnections;
+    unsigned int m_segmentSize;
+
+    mutable CCriticalSection m_section;
+    CEvent m_dataEvent;
+    CEvent m_workEvent;
+    bool m_stopped;
+    bool m_failed;        ///< the server doesn't support range requests
+    unsigned int m_generation;
+    int64_t m_readPos;    ///< position of the next byte handed out by Read()
+    int64_t m_requestPos; ///< position of the next segment to request
+    unsigned int m_inFlight;
+    unsigned int m_window;
+    double m_rtt;         ///< smoothed round trip time (ms)
+    double m_bandwidth;   ///< smoothed per connection bandwidth (bytes/s)
+    std::map<int64_t, std::vector<char> > m_segments;
+    std::map<int64_t, unsigned int> m_retries;  ///< length of the failed segments to request again
+    std::map<int64_t, unsigned int> m_attempts; ///< number of failed requests of a segment
+    std::map<int64_t, unsigned int> m_skipped;  ///< length of the segments that keep failing
+    std::vector<std::unique_ptr<CConnection> > m_connections;
+  };
+}
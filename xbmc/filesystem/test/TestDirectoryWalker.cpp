@@ -0,0 +1,85 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/Directory.h"
+#include "filesystem/DirectoryWalker.h"
+#include "filesystem/SpecialProtocol.h"
+#include "FileItem.h"
+#include "utils/URIUtils.h"
+
+#include <set>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+TEST(TestDirectoryWalker, GetShare)
+{
+  EXPECT_EQ(CDirectoryWalker::GetShare("smb://server/share/movies/"),
+            CDirectoryWalker::GetShare("smb://server/share/tv/show/"));
+  EXPECT_NE(CDirectoryWalker::GetShare("smb://server/share/movies/"),
+            CDirectoryWalker::GetShare("smb://server/other/movies/"));
+  EXPECT_NE(CDirectoryWalker::GetShare("smb://server/share/movies/"),
+            CDirectoryWalker::GetShare("nfs://server/share/movies/"));
+  EXPECT_TRUE(CDirectoryWalker::GetShare("/home/user/movies/").empty());
+}
+
+TEST(TestDirectoryWalker, Walk)
+{
+  std::string root = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"), "TestDirectoryWalker");
+  std::string first = URIUtils::AddFileToFolder(root, "first");
+  std::string nested = URIUtils::AddFileToFolder(first, "nested");
+  std::string second = URIUtils::AddFileToFolder(root, "second");
+  ASSERT_TRUE(CDirectory::Create(root));
+  ASSERT_TRUE(CDirectory::Create(first));
+  ASSERT_TRUE(CDirectory::Create(nested));
+  ASSERT_TRUE(CDirectory::Create(second));
+
+  CDirectoryWalker walker("", DIR_FLAG_NO_FILE_DIRS, 2);
+  walker.Start(root);
+
+  // the root is listed first, its subfolders only once it has been listed
+  std::string directory;
+  CFileItemList items;
+  ASSERT_TRUE(walker.GetNext(directory, items));
+  URIUtils::RemoveSlashAtEnd(directory);
+  EXPECT_EQ(root, directory);
+  EXPECT_EQ(2, items.Size());
+  items.Clear();
+
+  std::set<std::string> listed;
+  listed.insert(directory);
+  while (walker.GetNext(directory, items))
+  {
+    URIUtils::RemoveSlashAtEnd(directory);
+    EXPECT_TRUE(listed.insert(directory).second);
+    items.Clear();
+  }
+
+  EXPECT_EQ(4U, listed.size());
+  EXPECT_TRUE(listed.find(first) != listed.end());
+  EXPECT_TRUE(listed.find(nested) != listed.end());
+  EXPECT_TRUE(listed.find(second) != listed.end());
+
+  EXPECT_TRUE(CDirectory::Remove(nested));
+  EXPECT_TRUE(CDirectory::Remove(first));
+  EXPECT_TRUE(CDirectory::Remove(second));
+  EXPECT_TRUE(CDirectory::Remove(root));
+}
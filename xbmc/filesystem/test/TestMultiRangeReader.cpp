@@ -0,0 +1,203 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/MultiRangeReader.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "URL.h"
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+namespace
+{
+  // serves the segments from memory instead of issuing range requests
+  class CTestRangeReader : public CMultiRangeReader
+  {
+  public:
+    CTestRangeReader(const std::string& data, unsigned int connections, unsigned int segmentSize)
+      : CMultiRangeReader(CURL("http://example.com/movie.mkv"), data.size(), connections, segmentSize),
+        m_data(data),
+        m_unsupported(false)
+    { }
+
+    virtual ~CTestRangeReader()
+    {
+      Stop();
+    }
+
+    void SetFailures(int64_t offset, unsigned int count)
+    {
+      CSingleLock lock(m_section);
+      m_failures[offset] = count;
+    }
+
+    void SetUnsupported()
+    {
+      CSingleLock lock(m_section);
+      m_unsupported = true;
+    }
+
+  protected:
+    virtual FetchResult Fetch(int64_t offset, unsigned int length, unsigned int generation, std::vector<char>& data, unsigned int& firstData)
+    {
+      CSingleLock lock(m_section);
+      if (m_unsupported)
+        return FETCH_UNSUPPORTED;
+
+      std::map<int64_t, unsigned int>::iterator it = m_failures.find(offset);
+      if (it != m_failures.end() && it->second > 0)
+      {
+        it->second--;
+        return FETCH_FAILED;
+      }
+
+      firstData = XbmcThreads::SystemClockMillis();
+      data.assign(m_data.begin() + offset, m_data.begin() + offset + length);
+      return FETCH_OK;
+    }
+
+  private:
+    std::string m_data;
+    CCriticalSection m_section;
+    std::map<int64_t, unsigned int> m_failures;
+    bool m_unsupported;
+  };
+
+  std::string CreateData(size_t size)
+  {
+    std::string data(size, 0);
+    for (size_t i = 0; i < size; i++)
+      data[i] = static_cast<char>(i * 7 + i / 251);
+    return data;
+  }
+
+  // read until the end of the file or the first failure
+  bool ReadAll(CMultiRangeReader& reader, std::string& result)
+  {
+    char buffer[700];
+    for (int attempts = 0; attempts < 1000 && !reader.IsEndOfFile(); attempts++)
+    {
+      ssize_t read = reader.Read(buffer, sizeof(buffer), 1000);
+      if (read < 0)
+        return false;
+      result.append(buffer, read);
+    }
+    return reader.IsEndOfFile();
+  }
+}
+
+TEST(TestMultiRangeReader, IsSupported)
+{
+  EXPECT_TRUE(CMultiRangeReader::IsSupported(CURL("http://example.com/movie.mkv")));
+  EXPECT_TRUE(CMultiRangeReader::IsSupported(CURL("https://example.com/movie.mkv")));
+  EXPECT_TRUE(CMultiRangeReader::IsSupported(CURL("davs://example.com/movie.mkv")));
+  EXPECT_FALSE(CMultiRangeReader::IsSupported(CURL("smb://server/share/movie.mkv")));
+  EXPECT_FALSE(CMultiRangeReader::IsSupported(CURL("/home/user/movie.mkv")));
+}
+
+TEST(TestMultiRangeReader, CalculateWindow)
+{
+  const unsigned int segmentSize = 1024 * 1024;
+
+  // nothing measured yet
+  EXPECT_EQ(1U, CMultiRangeReader::CalculateWindow(0, 0.0, segmentSize, 8));
+  // read ahead disabled
+  EXPECT_EQ(1U, CMultiRangeReader::CalculateWindow(100, 1024 * 1024, segmentSize, 1));
+
+  // 1 MB/s per connection takes a second per segment, a 100ms round trip needs one extra request
+  EXPECT_EQ(2U, CMultiRangeReader::CalculateWindow(100, 1024 * 1024, segmentSize, 8));
+  // 10 MB/s takes 100ms per segment, a 250ms round trip needs three extra requests
+  EXPECT_EQ(4U, CMultiRangeReader::CalculateWindow(250, 10 * 1024 * 1024, segmentSize, 8));
+  // never exceed the number of connections
+  EXPECT_EQ(8U, CMultiRangeReader::CalculateWindow(2000, 10 * 1024 * 1024, segmentSize, 8));
+}
+
+TEST(TestMultiRangeReader, Read)
+{
+  const std::string data = CreateData(10 * 1000 + 123);
+  CTestRangeReader reader(data, 4, 1000);
+  reader.Start(0);
+
+  std::string result;
+  EXPECT_TRUE(ReadAll(reader, result));
+  EXPECT_EQ(data, result);
+}
+
+TEST(TestMultiRangeReader, ReadFromPosition)
+{
+  const std::string data = CreateData(10 * 1000 + 123);
+  CTestRangeReader reader(data, 4, 1000);
+  reader.Start(0);
+
+  char buffer[100];
+  ASSERT_GT(reader.Read(buffer, sizeof(buffer), 1000), 0);
+
+  // seeking drops the segments fetched so far
+  reader.Start(2500);
+  std::string result;
+  EXPECT_TRUE(ReadAll(reader, result));
+  EXPECT_EQ(data.substr(2500), result);
+}
+
+TEST(TestMultiRangeReader, RetryFailedSegment)
+{
+  const std::string data = CreateData(10 * 1000);
+  CTestRangeReader reader(data, 4, 1000);
+  reader.SetFailures(3000, 2);
+  reader.Start(0);
+
+  std::string result;
+  EXPECT_TRUE(ReadAll(reader, result));
+  EXPECT_EQ(data, result);
+}
+
+TEST(TestMultiRangeReader, SkipFailedSegment)
+{
+  const std::string data = CreateData(10 * 1000);
+  CTestRangeReader reader(data, 4, 1000);
+  reader.SetFailures(3000, 100);
+  reader.Start(0);
+
+  // reading stops at the segment that keeps failing, the caller fetches it
+  std::string result;
+  EXPECT_FALSE(ReadAll(reader, result));
+  EXPECT_EQ(data.substr(0, 3000), result);
+  EXPECT_EQ(4000, reader.SkipFailedSegment());
+
+  // and read ahead continues behind it
+  result.clear();
+  EXPECT_TRUE(ReadAll(reader, result));
+  EXPECT_EQ(data.substr(4000), result);
+}
+
+TEST(TestMultiRangeReader, RangesUnsupported)
+{
+  const std::string data = CreateData(10 * 1000);
+  CTestRangeReader reader(data, 4, 1000);
+  reader.SetUnsupported();
+  reader.Start(0);
+
+  std::string result;
+  EXPECT_FALSE(ReadAll(reader, result));
+  EXPECT_TRUE(result.empty());
+  EXPECT_EQ(-1, reader.SkipFailedSegment());
+}
@@ -40,6 +40,22 @@ CGUIControlGroupList::CGUIControlGroupList(int parentID, int controlID, float po
   m_minSize = 0;
 }
 
+CGUIControlGroupList::CGUIControlGroupList(const CGUIControlGroupList &from)
+: CGUIControlGroup(from)
+, m_scroller(from.m_scroller)
+{
+  // the children are copied with their navigation already set up
+  m_itemGap = from.m_itemGap;
+  m_pageControl = from.m_pageControl;
+  m_focusedPosition = from.m_focusedPosition;
+  m_totalSize = from.m_totalSize;
+  m_orientation = from.m_orientation;
+  m_alignment = from.m_alignment;
+  m_useControlPositions = from.m_useControlPositions;
+  ControlType = GUICONTROL_GROUPLIST;
+  m_minSize = from.m_minSize;
+}
+
 CGUIControlGroupList::~CGUIControlGroupList(void)
 {
 }
@@ -260,6 +260,7 @@ void CGUIControlProfiler::Start(void)
   m_bIsRunning = true;
   m_pLastItem = NULL;
   m_ItemHead.Reset(this);
+  m_windowActivations.clear();
 }
 
 void CGUIControlProfiler::BeginVisibility(CGUIControl *pControl)
@@ -286,6 +287,15 @@ void CGUIControlProfiler::EndRender(CGUIControl *pControl)
   item->EndRender();
 }
 
+void CGUIControlProfiler::AddWindowActivation(int windowID, const std::string &xmlFile, int64_t time)
+{
+  WindowActivation activation;
+  activation.windowID = windowID;
+  activation.xmlFile = xmlFile;
+  activation.time = (unsigned int)(m_fPerfScale * time);
+  m_windowActivations.push_back(activation);
+}
+
 CGUIControlProfilerItem *CGUIControlProfiler::FindOrAddControl(CGUIControl *pControl)
 {
   if (m_pLastItem)
@@ -329,7 +339,10 @@ void CGUIControlProfiler::EndFrame(void)
 
     m_bIsRunning = false;
     if (SaveResults())
+    {
       m_ItemHead.Reset(this);
+      m_windowActivations.clear();
+    }
   }
 }
 
@@ -349,5 +362,22 @@ bool CGUIControlProfiler::SaveResults(void)
   doc.LinkEndChild(root);
 
   m_ItemHead.SaveToXML(root);
+
+  if (!m_windowActivations.empty())
+  {
+    // Note time is stored in 1/100 milliseconds but reported in ms
+    TiXmlElement *activations = new TiXmlElement("windowactivations");
+    root->LinkEndChild(activations);
+    for (std::vector<WindowActivation>::const_iterator it = m_windowActivations.begin(); it != m_windowActivations.end(); ++it)
+    {
+      TiXmlElement *window = new TiXmlElement("window");
+      window->SetAttribute("id", it->windowID);
+      window->SetAttribute("xmlfile", it->xmlFile.c_str());
+      std::string val = StringUtils::Format("%u", it->time / 100);
+      window->SetAttribute("time", val.c_str());
+      activations->LinkEndChild(window);
+    }
+  }
+
   return doc.SaveFile(m_strOutputFile);
 }
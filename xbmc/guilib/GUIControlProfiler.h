@@ -69,6 +69,12 @@ public:
   void EndVisibility(CGUIControl *pControl);
   void BeginRender(CGUIControl *pControl);
   void EndRender(CGUIControl *pControl);
+  /*! \brief Record how long it took to activate a window, from loading it to initializing it
+   \param windowID id of the window
+   \param xmlFile the XML file of the window
+   \param time the duration in host counter ticks
+   */
+  void AddWindowActivation(int windowID, const std::string &xmlFile, int64_t time);
   int GetMaxFrameCount(void) const { return m_iMaxFrameCount; };
   void SetMaxFrameCount(int iMaxFrameCount) { m_iMaxFrameCount = iMaxFrameCount; };
   void SetOutputFile(const std::string &strOutputFile) { m_strOutputFile = strOutputFile; };
@@ -87,6 +93,14 @@ private:
   CGUIControlProfilerItem *m_pLastItem;
   CGUIControlProfilerItem *FindOrAddControl(CGUIControl *pControl);
 
+  struct WindowActivation
+  {
+    int windowID;
+    std::string xmlFile;
+    unsigned int time;
+  };
+  std::vector<WindowActivation> m_windowActivations;
+
   static bool m_bIsRunning;
   std::string m_strOutputFile;
   int m_iMaxFrameCount;
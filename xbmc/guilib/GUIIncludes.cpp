@@ -19,6 +19,9 @@
  */
 
 #include "GUIIncludes.h"
+
+#include <algorithm>
+
 #include "addons/Skin.h"
 #include "GUIInfoManager.h"
 #include "GUIInfoTypes.h"
@@ -28,6 +31,9 @@
 #include "utils/StringUtils.h"
 #include "interfaces/info/SkinVariable.h"
 
+// number of differently resolved versions of a window that are kept
+#define MAX_RESOLVED_VARIANTS 2
+
 CGUIIncludes::CGUIIncludes()
 {
   m_constantAttributes.insert("x");
@@ -96,6 +102,7 @@ void CGUIIncludes::ClearIncludes()
   m_constants.clear();
   m_skinvariables.clear();
   m_files.clear();
+  m_resolvedWindows.clear();
 }
 
 bool CGUIIncludes::LoadIncludes(const std::string &includeFile)
@@ -113,7 +120,7 @@ bool CGUIIncludes::LoadIncludes(const std::string &includeFile)
   // success, load the tags
   if (LoadIncludesFromXML(doc.RootElement()))
   {
-    m_files.push_back(includeFile);
+    m_files.insert(includeFile);
     return true;
   }
   return false;
@@ -202,9 +209,41 @@ bool CGUIIncludes::LoadIncludesFromXML(const TiXmlElement *root)
 
 bool CGUIIncludes::HasIncludeFile(const std::string &file) const
 {
-  for (iFiles it = m_files.begin(); it != m_files.end(); ++it)
-    if (*it == file) return true;
-  return false;
+  return m_files.find(file) != m_files.end();
+}
+
+TiXmlElement* CGUIIncludes::ResolveWindowIncludes(const std::string &windowFile, const TiXmlElement *root,
+                                                  std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  std::vector<ResolvedWindow> &variants = m_resolvedWindows[windowFile];
+  for (std::vector<ResolvedWindow>::iterator it = variants.begin(); it != variants.end(); ++it)
+  {
+    if (!g_infoManager.ConditionsChangedValues(it->conditions))
+    {
+      xmlIncludeConditions = it->conditions;
+      // keep the most recently used variant in front
+      std::rotate(variants.begin(), it, it + 1);
+      return static_cast<TiXmlElement*>(variants.front().root->Clone());
+    }
+  }
+
+  TiXmlElement *resolved = static_cast<TiXmlElement*>(root->Clone());
+  xmlIncludeConditions.clear();
+  ResolveIncludes(resolved, &xmlIncludeConditions);
+
+  ResolvedWindow variant;
+  variant.root.reset(static_cast<TiXmlElement*>(resolved->Clone()));
+  variant.conditions = xmlIncludeConditions;
+  variants.insert(variants.begin(), variant);
+  if (variants.size() > MAX_RESOLVED_VARIANTS)
+    variants.pop_back();
+
+  return resolved;
+}
+
+void CGUIIncludes::ClearResolvedWindow(const std::string &windowFile)
+{
+  m_resolvedWindows.erase(windowFile);
 }
 
 void CGUIIncludes::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions /* = NULL */)
@@ -232,7 +271,7 @@ void CGUIIncludes::ResolveIncludesForNode(TiXmlElement *node, std::map<INFO::Inf
   if (node->ValueStr() == "control")
   {
     type = XMLUtils::GetAttribute(node, "type");
-    std::map<std::string, TiXmlElement>::const_iterator it = m_defaults.find(type);
+    std::unordered_map<std::string, TiXmlElement>::const_iterator it = m_defaults.find(type);
     if (it != m_defaults.end())
     {
       // we don't insert <left> et. al. if <posx> or <posy> is specified
@@ -307,7 +346,7 @@ void CGUIIncludes::ResolveIncludesForNode(TiXmlElement *node, std::map<INFO::Inf
       }
     }
 
-    std::map<std::string, std::pair<TiXmlElement, Params>>::const_iterator it = m_includes.find(tagName);
+    std::unordered_map<std::string, std::pair<TiXmlElement, Params>>::const_iterator it = m_includes.find(tagName);
     if (it != m_includes.end())
     { // found the tag(s) to include - let's replace it
       const TiXmlElement *includeBody = &it->second.first;
@@ -480,10 +519,13 @@ CGUIIncludes::ResolveParamsResult CGUIIncludes::ResolveParameters(const std::str
 
 std::string CGUIIncludes::ResolveConstant(const std::string &constant) const
 {
+  if (m_constants.empty())
+    return constant;
+
   std::vector<std::string> values = StringUtils::Split(constant, ",");
   for (std::vector<std::string>::iterator i = values.begin(); i != values.end(); ++i)
   {
-    std::map<std::string, std::string>::const_iterator it = m_constants.find(*i);
+    std::unordered_map<std::string, std::string>::const_iterator it = m_constants.find(*i);
     if (it != m_constants.end())
       *i = it->second;
   }
@@ -492,7 +534,7 @@ std::string CGUIIncludes::ResolveConstant(const std::string &constant) const
 
 const INFO::CSkinVariableString* CGUIIncludes::CreateSkinVariable(const std::string& name, int context)
 {
-  std::map<std::string, TiXmlElement>::const_iterator it = m_skinvariables.find(name);
+  std::unordered_map<std::string, TiXmlElement>::const_iterator it = m_skinvariables.find(name);
   if (it != m_skinvariables.end())
     return INFO::CSkinVariable::CreateFromXML(it->second, context);
   return NULL;
@@ -21,8 +21,10 @@
  */
 
 #include <map>
-#include <set>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -51,6 +53,22 @@ public:
    \param node an XML Element - all child elements are traversed.
    */
   void ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions = NULL);
+
+  /*! \brief Resolve the includes of a window, reusing an earlier resolution of the same window
+   The resolved windows are cached by window file, along with the include conditions they
+   depend on. A cached window is reused as long as those conditions keep their values.
+   \param windowFile the file the window was loaded from
+   \param root the window element, it's left untouched.
+   \param xmlIncludeConditions [out] the conditions used to resolve the includes and their values
+   \return the resolved window, to be deleted by the caller.
+   */
+  TiXmlElement* ResolveWindowIncludes(const std::string &windowFile, const TiXmlElement *root,
+                                      std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
+  /*! \brief Drop the cached resolutions of a window, e.g. because its file was (re)loaded
+   */
+  void ClearResolvedWindow(const std::string &windowFile);
+
   const INFO::CSkinVariableString* CreateSkinVariable(const std::string& name, int context);
 
 private:
@@ -68,13 +86,19 @@ private:
   static ResolveParamsResult ResolveParameters(const std::string& strInput, std::string& strOutput, const Params& params);
   std::string ResolveConstant(const std::string &constant) const;
   bool HasIncludeFile(const std::string &includeFile) const;
-  std::map<std::string, std::pair<TiXmlElement, Params>> m_includes;
-  std::map<std::string, TiXmlElement> m_defaults;
-  std::map<std::string, TiXmlElement> m_skinvariables;
-  std::map<std::string, std::string> m_constants;
-  std::vector<std::string> m_files;
-  typedef std::vector<std::string>::const_iterator iFiles;
+  std::unordered_map<std::string, std::pair<TiXmlElement, Params>> m_includes;
+  std::unordered_map<std::string, TiXmlElement> m_defaults;
+  std::unordered_map<std::string, TiXmlElement> m_skinvariables;
+  std::unordered_map<std::string, std::string> m_constants;
+  std::unordered_set<std::string> m_files;
+
+  std::unordered_set<std::string> m_constantAttributes;
+  std::unordered_set<std::string> m_constantNodes;
 
-  std::set<std::string> m_constantAttributes;
-  std::set<std::string> m_constantNodes;
+  struct ResolvedWindow
+  {
+    std::shared_ptr<TiXmlElement> root;
+    std::map<INFO::InfoPtr, bool> conditions;
+  };
+  std::unordered_map<std::string, std::vector<ResolvedWindow>> m_resolvedWindows; ///< most recently resolved first
 };
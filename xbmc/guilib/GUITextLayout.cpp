@@ -19,6 +19,7 @@
  */
 
 #include "GUITextLayout.h"
+#include "GUITextLayoutCache.h"
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
@@ -238,6 +239,28 @@ bool CGUITextLayout::UpdateW(const std::wstring &text, float maxWidth /*= 0*/, b
 
 void CGUITextLayout::UpdateCommon(const std::wstring &text, float maxWidth, bool forceLTRReadingOrder)
 {
+  // the same labels are laid out over and over by the items of lists
+  CGUITextLayoutCache::Key key;
+  key.text = text;
+  key.font = m_font;
+  key.wrapWidth = (m_wrap && maxWidth > 0) ? maxWidth : 0;
+  key.maxHeight = m_maxHeight;
+  key.textColor = m_textColor;
+  key.forceLTRReadingOrder = forceLTRReadingOrder;
+  // the font measures in the coordinates of the window being rendered
+  key.scaleX = g_graphicsContext.GetGUIScaleX();
+  key.scaleY = g_graphicsContext.GetGUIScaleY();
+
+  CGUITextLayoutCache::LayoutPtr cached = CGUITextLayoutCache::GetInstance().Get(key);
+  if (cached)
+  {
+    m_lines = cached->lines;
+    m_colors = cached->colors;
+    m_textWidth = cached->width;
+    m_textHeight = cached->height;
+    return;
+  }
+
   // parse the text for style information
   vecText parsedText;
   vecColors colors;
@@ -245,6 +268,13 @@ void CGUITextLayout::UpdateCommon(const std::wstring &text, float maxWidth, bool
 
   // and update
   UpdateStyled(parsedText, colors, maxWidth, forceLTRReadingOrder);
+
+  std::shared_ptr<CGUITextLayoutCache::Layout> layout(new CGUITextLayoutCache::Layout);
+  layout->lines = m_lines;
+  layout->colors = m_colors;
+  layout->width = m_textWidth;
+  layout->height = m_textHeight;
+  CGUITextLayoutCache::GetInstance().Add(key, layout);
 }
 
 void CGUITextLayout::UpdateStyled(const vecText &text, const vecColors &colors, float maxWidth, bool forceLTRReadingOrder)
@@ -0,0 +1,90 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUITextLayoutCache.h"
+
+#include <functional>
+
+#include "threads/SingleLock.h"
+
+bool CGUITextLayoutCache::Key::operator==(const Key &other) const
+{
+  return font == other.font &&
+         wrapWidth == other.wrapWidth &&
+         maxHeight == other.maxHeight &&
+         textColor == other.textColor &&
+         forceLTRReadingOrder == other.forceLTRReadingOrder &&
+         scaleX == other.scaleX &&
+         scaleY == other.scaleY &&
+         text == other.text;
+}
+
+size_t CGUITextLayoutCache::KeyHash::operator()(const Key *key) const
+{
+  size_t hash = std::hash<std::wstring>()(key->text);
+  hash ^= std::hash<const void*>()(key->font) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  hash ^= std::hash<float>()(key->wrapWidth) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  hash ^= std::hash<float>()(key->scaleX) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+CGUITextLayoutCache::CGUITextLayoutCache()
+{ }
+
+CGUITextLayoutCache& CGUITextLayoutCache::GetInstance()
+{
+  static CGUITextLayoutCache instance;
+  return instance;
+}
+
+CGUITextLayoutCache::LayoutPtr CGUITextLayoutCache::Get(const Key &key)
+{
+  CSingleLock lock(m_critical);
+  std::unordered_map<const Key*, Entries::iterator, KeyHash, KeyEqual>::const_iterator it = m_index.find(&key);
+  if (it == m_index.end())
+    return LayoutPtr();
+
+  // move the entry to the front, iterators (and thus the index) stay valid
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->second;
+}
+
+void CGUITextLayoutCache::Add(const Key &key, const LayoutPtr &layout)
+{
+  CSingleLock lock(m_critical);
+  if (m_index.find(&key) != m_index.end())
+    return;
+
+  m_entries.push_front(std::make_pair(key, layout));
+  m_index.insert(std::make_pair(&m_entries.front().first, m_entries.begin()));
+
+  if (m_entries.size() > TEXT_LAYOUT_CACHE_SIZE)
+  {
+    m_index.erase(&m_entries.back().first);
+    m_entries.pop_back();
+  }
+}
+
+void CGUITextLayoutCache::Flush()
+{
+  CSingleLock lock(m_critical);
+  m_index.clear();
+  m_entries.clear();
+}
@@ -0,0 +1,109 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GUITextLayout.h"
+#include "threads/CriticalSection.h"
+
+// enough for the labels of a few screens of list items
+#define TEXT_LAYOUT_CACHE_SIZE 1000
+
+/*!
+ \brief Shares the laid out text of labels between text layouts.
+
+ Laying out a label means parsing its formatting codes, converting it to
+ styled UTF-32, breaking and wrapping it into lines by measuring the glyphs,
+ and flipping right-to-left sections. Lists show the same labels over and over
+ while they scroll, so the resulting lines are kept, keyed by everything the
+ layout depends on, including the GUI scale as fonts are shared by windows
+ with different coordinate resolutions.
+
+ Fonts are only used as part of the key, nothing is rendered, so the cache
+ works without a rendering context. It has to be flushed whenever fonts are
+ unloaded or their sizes change.
+ */
+class CGUITextLayoutCache
+{
+public:
+  struct Key
+  {
+    std::wstring text;
+    const CGUIFont *font;
+    float wrapWidth;       ///< 0 if the text isn't wrapped
+    float maxHeight;
+    color_t textColor;
+    bool forceLTRReadingOrder;
+    float scaleX;          ///< GUI scale the font measured the text with
+    float scaleY;
+
+    bool operator==(const Key &other) const;
+  };
+
+  struct Layout
+  {
+    std::vector<CGUIString> lines;
+    vecColors colors;
+    float width;
+    float height;
+  };
+  typedef std::shared_ptr<const Layout> LayoutPtr;
+
+  static CGUITextLayoutCache& GetInstance();
+
+  /*!
+   \brief Look up the layout of a text.
+   \return the layout, or an empty pointer if the text wasn't laid out before.
+   */
+  LayoutPtr Get(const Key &key);
+
+  void Add(const Key &key, const LayoutPtr &layout);
+
+  /*!
+   \brief Drop all layouts, e.g. because fonts were unloaded or rescaled.
+   */
+  void Flush();
+
+private:
+  CGUITextLayoutCache();
+  CGUITextLayoutCache(const CGUITextLayoutCache&);
+  CGUITextLayoutCache& operator=(const CGUITextLayoutCache&);
+
+  // the index points to the keys stored in the entries
+  struct KeyHash
+  {
+    size_t operator()(const Key *key) const;
+  };
+  struct KeyEqual
+  {
+    bool operator()(const Key *a, const Key *b) const { return *a == *b; }
+  };
+
+  typedef std::list<std::pair<Key, LayoutPtr> > Entries;
+
+  CCriticalSection m_critical;
+  Entries m_entries; ///< most recently used first
+  std::unordered_map<const Key*, Entries::iterator, KeyHash, KeyEqual> m_index;
+};
@@ -25,6 +25,7 @@
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "TextureManager.h"
 
 #include "addons/Skin.h"
 #include "GUIInfoManager.h"
@@ -43,8 +44,56 @@
 #include "utils/PerformanceSample.h"
 #endif
 
+#include <set>
+
 using namespace KODI::MESSAGING;
 
+// collect the static textures referenced by the (include resolved) window xml
+static void GetTextures(const TiXmlElement *element, std::set<std::string> &textures)
+{
+  for (const TiXmlElement *child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+  {
+    std::string tag = child->Value();
+    StringUtils::ToLower(tag);
+    if (tag.find("texture") != std::string::npos)
+    {
+      const char *diffuse = child->Attribute("diffuse");
+      if (diffuse && !strchr(diffuse, '$'))
+        textures.insert(diffuse);
+      if (child->FirstChild() && !strchr(child->FirstChild()->Value(), '$'))
+        textures.insert(child->FirstChild()->Value());
+    }
+    GetTextures(child, textures);
+  }
+}
+
+// whether a control of the given type is copied completely by its Clone()
+static bool IsClonable(CGUIControl::GUICONTROLTYPES type)
+{
+  switch (type)
+  {
+  case CGUIControl::GUICONTROL_BUTTON:
+  case CGUIControl::GUICONTROL_FADELABEL:
+  case CGUIControl::GUICONTROL_IMAGE:
+  case CGUIControl::GUICONTROL_BORDEREDIMAGE:
+  case CGUIControl::GUICONTROL_LARGE_IMAGE:
+  case CGUIControl::GUICONTROL_LABEL:
+  case CGUIControl::GUICONTROL_LISTGROUP:
+  case CGUIControl::GUICONTROL_PROGRESS:
+  case CGUIControl::GUICONTROL_RADIO:
+  case CGUIControl::GUICONTROL_TEXTBOX:
+  case CGUIControl::GUICONTROL_TOGGLEBUTTON:
+  case CGUIControl::GUICONTROL_MULTI_IMAGE:
+  case CGUIControl::GUICONTROL_GROUP:
+  case CGUIControl::GUICONTROL_GROUPLIST:
+  case CGUIControl::GUICONTROL_LISTLABEL:
+    return true;
+  default:
+    // containers own their list providers, other controls keep runtime state
+    return false;
+  }
+}
+
 bool CGUIWindow::icompare::operator()(const std::string &s1, const std::string &s2) const
 {
   return StringUtils::CompareNoCase(s1, s2) < 0;
@@ -71,11 +120,15 @@ CGUIWindow::CGUIWindow(int id, const std::string &xmlFile)
   m_windowXMLRootElement = NULL;
   m_menuControlID = 0;
   m_menuLastFocusedControlID = 0;
+  m_controlsTemplateWidth = 0;
+  m_controlsTemplateHeight = 0;
+  m_controlsClonable = false;
 }
 
 CGUIWindow::~CGUIWindow(void)
 {
   delete m_windowXMLRootElement;
+  ClearControlsTemplate();
 }
 
 bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
@@ -110,6 +163,22 @@ bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
   // Find appropriate skin folder + resolution to load from
   std::string strPath;
   std::string strLowerPath;
+  GetSkinPaths(strFileName, bContainsPath, strPath, strLowerPath);
+
+  bool ret = LoadXML(strPath, strLowerPath);
+
+#ifdef _DEBUG
+  int64_t end, freq;
+  end = CurrentHostCounter();
+  freq = CurrentHostFrequency();
+  CLog::Log(LOGDEBUG,"Load %s: %.2fms", GetProperty("xmlfile").c_str(), 1000.f * (end - start) / freq);
+#endif
+  return ret;
+}
+
+void CGUIWindow::GetSkinPaths(const std::string &strFileName, bool bContainsPath, std::string &strPath, std::string &strLowerPath)
+{
+  strLowerPath.clear();
   if (bContainsPath)
     strPath = strFileName;
   else
@@ -120,16 +189,41 @@ bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
     strLowerPath =  g_SkinInfo->GetSkinPath(strFileNameLower, &m_coordsRes);
     strPath = g_SkinInfo->GetSkinPath(strFileName, &m_coordsRes);
   }
+}
 
-  bool ret = LoadXML(strPath, strLowerPath);
+bool CGUIWindow::GetXMLPaths(std::string &strPath, std::string &strLowerPath)
+{
+  std::string xmlFile = GetProperty("xmlfile").asString();
+  if (xmlFile.empty() || g_SkinInfo == NULL)
+    return false;
 
-#ifdef _DEBUG
-  int64_t end, freq;
-  end = CurrentHostCounter();
-  freq = CurrentHostFrequency();
-  CLog::Log(LOGDEBUG,"Load %s: %.2fms", GetProperty("xmlfile").c_str(), 1000.f * (end - start) / freq);
-#endif
-  return ret;
+  bool bHasPath = xmlFile.find("\\") != std::string::npos || xmlFile.find("/") != std::string::npos;
+  GetSkinPaths(xmlFile, bHasPath, strPath, strLowerPath);
+  return true;
+}
+
+void CGUIWindow::Preload(TiXmlElement *root, const std::string &strPath)
+{
+  if (!NeedsPreload())
+  {
+    delete root;
+    return;
+  }
+
+  m_windowXMLRootElement = root;
+  m_windowXMLFile = strPath;
+  g_SkinInfo->ClearResolvedWindow(m_windowXMLFile);
+
+  if (Load(m_windowXMLRootElement) && m_loadType == LOAD_EVERY_TIME)
+    ClearAll();
+}
+
+void CGUIWindow::ClearControlsTemplate()
+{
+  for (std::vector<CGUIControl*>::iterator it = m_controlsTemplate.begin(); it != m_controlsTemplate.end(); ++it)
+    delete *it;
+  m_controlsTemplate.clear();
+  m_controlsTemplateConditions.clear();
 }
 
 bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLowerPath)
@@ -147,6 +241,9 @@ bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLower
       return false;
     }
     m_windowXMLRootElement = (TiXmlElement*)xmlDoc.RootElement()->Clone();
+    // the file may have changed since its includes were resolved
+    m_windowXMLFile = strPath;
+    g_SkinInfo->ClearResolvedWindow(m_windowXMLFile);
   }
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
@@ -165,16 +262,38 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
     return false;
   }
 
-  // we must create copy of root element as we will manipulate it when resolving includes
-  // and we don't want original root element to change
-  pRootElement = (TiXmlElement*)pRootElement->Clone();
-
   // set the scaling resolution so that any control creation or initialisation can
   // be done with respect to the correct aspect ratio
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
-  // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  // Resolve any includes that may be present and save conditions used to do it.
+  // We must create copy of root element as we will manipulate it when resolving includes
+  // and we don't want original root element to change
+  int64_t start = CurrentHostCounter();
+  const bool fromFile = pRootElement == m_windowXMLRootElement && !m_windowXMLFile.empty();
+  if (fromFile)
+    pRootElement = g_SkinInfo->ResolveWindowIncludes(m_windowXMLFile, pRootElement, m_xmlIncludeConditions);
+  else
+  {
+    pRootElement = (TiXmlElement*)pRootElement->Clone();
+    g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  }
+  CLog::Log(LOGDEBUG, "Resolved includes of %s in %.2fms", GetProperty("xmlfile").c_str(),
+            1000.f * (CurrentHostCounter() - start) / CurrentHostFrequency());
+
+  // windows that are loaded every time they're opened keep a copy of their controls, which
+  // stays valid for as long as the includes are resolved the same way
+  const bool useTemplate = fromFile && m_loadType == LOAD_EVERY_TIME;
+  if (!m_controlsTemplate.empty() && (!useTemplate || m_controlsTemplateConditions != m_xmlIncludeConditions))
+    ClearControlsTemplate();
+  const bool fromTemplate = !m_controlsTemplate.empty();
+  m_controlsClonable = useTemplate && !fromTemplate;
+
+  // start decoding the window's bundled textures while the controls are being created
+  std::set<std::string> textures;
+  GetTextures(pRootElement, textures);
+  g_TextureManager.PrefetchTextures(std::vector<std::string>(textures.begin(), textures.end()));
+
   // now load in the skin file
   SetDefaults();
 
@@ -256,7 +375,7 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
       float stereo = (float)atof(pChild->FirstChild()->Value());;
       m_stereo = std::max(-1.f, std::min(1.f, stereo));
     }
-    else if (strValue == "controls")
+    else if (strValue == "controls" && !fromTemplate)
     {
       TiXmlElement *pControl = pChild->FirstChildElement();
       while (pControl)
@@ -271,6 +390,24 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
 
     pChild = pChild->NextSiblingElement();
   }
+
+  if (fromTemplate)
+  {
+    for (std::vector<CGUIControl*>::const_iterator it = m_controlsTemplate.begin(); it != m_controlsTemplate.end(); ++it)
+      AddControl((*it)->Clone());
+    m_width = m_controlsTemplateWidth;
+    m_height = m_controlsTemplateHeight;
+  }
+  else if (m_controlsClonable)
+  {
+    for (ciControls it = m_children.begin(); it != m_children.end(); ++it)
+      m_controlsTemplate.push_back((*it)->Clone());
+    m_controlsTemplateConditions = m_xmlIncludeConditions;
+    m_controlsTemplateWidth = m_width;
+    m_controlsTemplateHeight = m_height;
+  }
+  m_controlsClonable = false;
+
   LoadAdditionalTags(pRootElement);
 
   m_windowLoaded = true;
@@ -287,6 +424,9 @@ void CGUIWindow::LoadControl(TiXmlElement* pControl, CGUIControlGroup *pGroup, c
   CGUIControl* pGUIControl = factory.Create(GetID(), rect, pControl);
   if (pGUIControl)
   {
+    if (!IsClonable(pGUIControl->GetControlType()))
+      m_controlsClonable = false;
+
     float maxX = pGUIControl->GetXPosition() + pGUIControl->GetWidth();
     if (maxX > m_width)
     {
@@ -585,8 +725,12 @@ bool CGUIWindow::OnMessage(CGUIMessage& message)
   case GUI_MSG_WINDOW_INIT:
     {
       CLog::Log(LOGDEBUG, "------ Window Init (%s) ------", GetProperty("xmlfile").c_str());
+      int64_t start = CurrentHostCounter();
       if (m_dynamicResourceAlloc || !m_bAllocated) AllocResources();
       OnInitWindow();
+      if (CGUIControlProfiler::IsRunning())
+        CGUIControlProfiler::Instance().AddWindowActivation(GetID(), GetProperty("xmlfile").asString(),
+                                                            CurrentHostCounter() - start);
       return true;
     }
     break;
@@ -810,7 +954,9 @@ void CGUIWindow::FreeResources(bool forceUnload /*= FALSE */)
   {
     delete m_windowXMLRootElement;
     m_windowXMLRootElement = NULL;
+    m_windowXMLFile.clear();
     m_xmlIncludeConditions.clear();
+    ClearControlsTemplate();
   }
 }
 
@@ -94,6 +94,27 @@ public:
   bool Initialize();  // loads the window
   bool Load(const std::string& strFileName, bool bContainsPath = false);
 
+  /*! \brief Get the paths the XML of the window is loaded from
+   Also sets the resolution the window coordinates are in.
+   \param strPath [out] the path of the XML file
+   \param strLowerPath [out] the path of the XML file in lower case, to try if the former doesn't exist
+   \return false if the window isn't loaded from an XML file.
+   */
+  bool GetXMLPaths(std::string &strPath, std::string &strLowerPath);
+
+  /*! \brief Load the window from XML that was read ahead of time
+   Windows that are loaded every time they're opened are unloaded again right away, keeping the
+   copy of their controls that is cloned when they're opened. Windows that are loaded already are
+   left alone.
+   \param root the window element, owned by the window afterwards
+   \param strPath the file the window element was read from
+   */
+  void Preload(TiXmlElement *root, const std::string &strPath);
+
+  /*! \brief Whether the XML of the window hasn't been read yet
+   */
+  bool NeedsPreload() const { return !m_windowLoaded && !m_windowXMLRootElement && !IsActive(); };
+
   void CenterWindow();
 
   virtual void DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions);
@@ -274,6 +295,7 @@ protected:
   CGUIAction m_unloadActions;
 
   TiXmlElement* m_windowXMLRootElement;
+  std::string m_windowXMLFile; ///< \brief file m_windowXMLRootElement was loaded from, the key of its resolved includes
 
   bool m_manualRunActions;
 
@@ -283,8 +305,17 @@ protected:
   int m_menuLastFocusedControlID;
 
 private:
+  void GetSkinPaths(const std::string &strFileName, bool bContainsPath, std::string &strPath, std::string &strLowerPath);
+  void ClearControlsTemplate();
+
   std::map<std::string, CVariant, icompare> m_mapProperties;
   std::map<INFO::InfoPtr, bool> m_xmlIncludeConditions; ///< \brief used to store conditions used to resolve includes for this window
+
+  std::vector<CGUIControl*> m_controlsTemplate; ///< \brief copies of the controls loaded from XML, cloned instead of loading them again
+  std::map<INFO::InfoPtr, bool> m_controlsTemplateConditions; ///< \brief include conditions the template was loaded with
+  float m_controlsTemplateWidth;
+  float m_controlsTemplateHeight;
+  bool m_controlsClonable; ///< \brief whether all controls loaded so far can be cloned faithfully
 };
 
 #endif
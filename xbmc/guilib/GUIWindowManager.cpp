@@ -34,7 +34,12 @@
 #include "GUITexture.h"
 #include "utils/Variant.h"
 #include "input/Key.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/XBMCTinyXML.h"
+#include "Util.h"
 
 #include "windows/GUIWindowHome.h"
 #include "events/windows/GUIWindowEventLog.h"
@@ -146,11 +151,57 @@ using namespace PVR;
 using namespace PERIPHERALS;
 using namespace KODI::MESSAGING;
 
+// windows that are commonly opened soon after the skin is loaded
+static const int preloadWindows[] = { WINDOW_HOME,
+                                      WINDOW_VIDEO_NAV,
+                                      WINDOW_MUSIC_NAV,
+                                      WINDOW_SETTINGS_MENU,
+                                      WINDOW_DIALOG_CONTEXT_MENU,
+                                      WINDOW_DIALOG_VIDEO_INFO,
+                                      WINDOW_FULLSCREEN_VIDEO,
+                                      WINDOW_DIALOG_VIDEO_OSD,
+                                      WINDOW_DIALOG_SEEK_BAR };
+
+class CWindowPreloadJob : public CJob
+{
+public:
+  CWindowPreloadJob(int id, const std::string &path, const std::string &lowerPath, unsigned int generation)
+    : m_id(id), m_path(path), m_lowerPath(lowerPath), m_generation(generation), m_root(NULL)
+  { }
+
+  virtual ~CWindowPreloadJob()
+  {
+    delete m_root;
+  }
+
+  virtual const char *GetType() const { return "windowpreload"; }
+
+  virtual bool DoWork()
+  {
+    // same as CGUIWindow::LoadXML
+    CXBMCTinyXML xmlDoc;
+    std::string pathLower = m_path;
+    StringUtils::ToLower(pathLower);
+    if (!xmlDoc.LoadFile(m_path) && !xmlDoc.LoadFile(pathLower) && !xmlDoc.LoadFile(m_lowerPath))
+      return false;
+
+    m_root = static_cast<TiXmlElement*>(xmlDoc.RootElement()->Clone());
+    return true;
+  }
+
+  int m_id;
+  std::string m_path;
+  std::string m_lowerPath;
+  unsigned int m_generation;
+  TiXmlElement *m_root;
+};
+
 CGUIWindowManager::CGUIWindowManager(void)
 {
   m_pCallback = NULL;
   m_iNested = 0;
   m_initialized = false;
+  m_preloadGeneration = 0;
 }
 
 CGUIWindowManager::~CGUIWindowManager(void)
@@ -164,6 +215,7 @@ void CGUIWindowManager::Initialize()
   m_initialized = true;
 
   LoadNotOnDemandWindows();
+  PreloadWindows();
 
   CApplicationMessenger::GetInstance().RegisterReceiver(this);
 }
@@ -978,6 +1030,8 @@ void CGUIWindowManager::Process(unsigned int currentTime)
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
 
+  ProcessPreloadedWindows();
+
   CDirtyRegionList dirtyregions;
 
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
@@ -1193,6 +1247,7 @@ void CGUIWindowManager::DeInitialize()
     pWindow->FreeResources(true);
   }
   UnloadNotOnDemandWindows();
+  ClearPreloadedWindows();
 
   m_vecMsgTargets.erase( m_vecMsgTargets.begin(), m_vecMsgTargets.end() );
 
@@ -1456,6 +1511,82 @@ void CGUIWindowManager::LoadNotOnDemandWindows()
   }
 }
 
+void CGUIWindowManager::PreloadWindows()
+{
+  if (!g_advancedSettings.m_guiPreloadWindows)
+    return;
+
+  CSingleLock lock(g_graphicsContext);
+  unsigned int generation;
+  {
+    CSingleLock lock(m_critSection);
+    generation = m_preloadGeneration;
+  }
+
+  for (unsigned int i = 0; i < ARRAY_SIZE(preloadWindows); i++)
+  {
+    CGUIWindow *pWindow = GetWindow(preloadWindows[i]);
+    std::string path, lowerPath;
+    if (pWindow && pWindow->NeedsPreload() && pWindow->GetXMLPaths(path, lowerPath))
+      CJobManager::GetInstance().AddJob(new CWindowPreloadJob(preloadWindows[i], path, lowerPath, generation), this);
+  }
+}
+
+void CGUIWindowManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CWindowPreloadJob *preloadJob = static_cast<CWindowPreloadJob*>(job);
+  if (!success)
+  {
+    CLog::Log(LOGDEBUG, "CGUIWindowManager: unable to preload %s", preloadJob->m_path.c_str());
+    return;
+  }
+
+  CSingleLock lock(m_critSection);
+  if (preloadJob->m_generation != m_preloadGeneration)
+    return;
+
+  // the window is loaded from it on the GUI thread
+  PreloadedWindow window;
+  window.id = preloadJob->m_id;
+  window.path = preloadJob->m_path;
+  window.root = preloadJob->m_root;
+  preloadJob->m_root = NULL;
+  m_preloadedWindows.push_back(window);
+}
+
+void CGUIWindowManager::ProcessPreloadedWindows()
+{
+  PreloadedWindow window;
+  {
+    CSingleLock lock(m_critSection);
+    if (m_preloadedWindows.empty())
+      return;
+    window = m_preloadedWindows.front();
+    m_preloadedWindows.erase(m_preloadedWindows.begin());
+  }
+
+  // one window per frame, building the controls takes a while
+  CGUIWindow *pWindow = GetWindow(window.id);
+  if (pWindow)
+  {
+    int64_t start = CurrentHostCounter();
+    pWindow->Preload(window.root, window.path);
+    CLog::Log(LOGDEBUG, "CGUIWindowManager: preloaded %s in %.2fms", window.path.c_str(),
+              1000.f * (CurrentHostCounter() - start) / CurrentHostFrequency());
+  }
+  else
+    delete window.root;
+}
+
+void CGUIWindowManager::ClearPreloadedWindows()
+{
+  CSingleLock lock(m_critSection);
+  for (std::vector<PreloadedWindow>::iterator it = m_preloadedWindows.begin(); it != m_preloadedWindows.end(); ++it)
+    delete it->root;
+  m_preloadedWindows.clear();
+  m_preloadGeneration++;
+}
+
 void CGUIWindowManager::UnloadNotOnDemandWindows()
 {
   CSingleLock lock(g_graphicsContext);
@@ -38,6 +38,7 @@
 #include "IWindowManagerCallback.h"
 #include "messaging/IMessageTarget.h"
 #include "utils/GlobalsHandling.h"
+#include "utils/Job.h"
 
 class CGUIDialog;
 enum class DialogModalityType;
@@ -56,7 +57,7 @@ namespace KODI
  \ingroup winman
  \brief
  */
-class CGUIWindowManager : public KODI::MESSAGING::IMessageTarget
+class CGUIWindowManager : public KODI::MESSAGING::IMessageTarget, public IJobCallback
 {
 public:
   CGUIWindowManager(void);
@@ -82,6 +83,8 @@ public:
   virtual void OnApplicationMessage(KODI::MESSAGING::ThreadMessage* pMsg) override;
   virtual int GetMessageMask() override;
 
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job) override;
+
   // OnAction() runs through our active dialogs and windows and sends the message
   // off to the callbacks (application, python, playlist player) and to the
   // currently focused window(s).  Returns true only if the message is handled.
@@ -188,6 +191,13 @@ private:
 
   void LoadNotOnDemandWindows();
   void UnloadNotOnDemandWindows();
+
+  /*! \brief Read the XML of the windows that are likely to be opened soon on worker threads
+   The windows are loaded from it by Process, one at a time.
+   */
+  void PreloadWindows();
+  void ProcessPreloadedWindows();
+  void ClearPreloadedWindows();
   void AddToWindowHistory(int newWindowID);
   void ClearWindowHistory();
   void CloseWindowSync(CGUIWindow *window, int nextWindowID = 0);
@@ -226,6 +236,15 @@ private:
 
   CDirtyRegionTracker m_tracker;
 
+  struct PreloadedWindow
+  {
+    int id;
+    std::string path;
+    TiXmlElement *root;
+  };
+  std::vector<PreloadedWindow> m_preloadedWindows; ///< protected by m_critSection
+  unsigned int m_preloadGeneration; ///< preloads of earlier generations belong to an unloaded skin
+
 private:
   class CGUIWindowManagerIdCache
   {
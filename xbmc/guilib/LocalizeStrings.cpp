@@ -20,9 +20,15 @@
 
 #include "system.h"
 #include "LocalizeStrings.h"
+
+#include <cstddef>
+#include <cstring>
+
 #include "addons/LanguageResource.h"
 #include "utils/CharsetConverter.h"
 #include "utils/log.h"
+#include "utils/md5.h"
+#include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/URIUtils.h"
 #include "utils/POUtils.h"
@@ -30,6 +36,160 @@
 #include "threads/SingleLock.h"
 #include "utils/StringUtils.h"
 
+#define STRINGS_CACHE_PATH   "special://temp/strings/"
+#define STRINGS_CACHE_MAGIC  "KST1"
+// string ids are allocated in blocks with gaps in between, real string files
+// span at most ~11 ids per string, anything much sparser is a corrupt table
+#define STRINGS_MAX_SPAN(count) (static_cast<uint64_t>(count) * 16 + 65536)
+
+namespace
+{
+  template<typename T>
+  void Append(std::string &buffer, T value)
+  {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void AppendString(std::string &buffer, const std::string &value)
+  {
+    Append(buffer, static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+  }
+
+  template<typename T>
+  bool Extract(const char *&data, const char *end, T &value)
+  {
+    if (end - data < static_cast<ptrdiff_t>(sizeof(value)))
+      return false;
+
+    memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+  }
+
+  bool ExtractString(const char *&data, const char *end, std::string &value)
+  {
+    uint32_t size;
+    if (!Extract(data, end, size) || end - data < static_cast<ptrdiff_t>(size))
+      return false;
+
+    value.assign(data, size);
+    data += size;
+    return true;
+  }
+}
+
+void CStringTable::Compile(const std::map<uint32_t, LocStr> &strings)
+{
+  Clear();
+  if (strings.empty())
+    return;
+
+  // a stray id far away from the others would make the index huge, drop the
+  // ids at whichever end is farther away from its neighbour until it's small enough
+  std::map<uint32_t, LocStr>::const_iterator first = strings.begin();
+  std::map<uint32_t, LocStr>::const_iterator last = --strings.end();
+  size_t count = strings.size();
+  while (static_cast<uint64_t>(last->first) - first->first + 1 > STRINGS_MAX_SPAN(count))
+  {
+    std::map<uint32_t, LocStr>::const_iterator second = first, secondLast = last;
+    ++second;
+    --secondLast;
+    if (second->first - first->first > last->first - secondLast->first)
+      first = second;
+    else
+      last = secondLast;
+    count--;
+  }
+  if (count < strings.size())
+    CLog::Log(LOGWARNING, "%s: dropped %u strings with ids outside of %u-%u", __FUNCTION__,
+              static_cast<unsigned int>(strings.size() - count), first->first, last->first);
+
+  m_firstId = first->first;
+  m_index.resize(last->first - m_firstId + 1, 0);
+  m_values.reserve(count);
+  for (++last; first != last; ++first)
+  {
+    m_values.push_back(first->second.strTranslated);
+    m_index[first->first - m_firstId] = m_values.size();
+  }
+}
+
+void CStringTable::Serialize(std::string &buffer) const
+{
+  // ids and lengths of the strings followed by the strings themselves
+  Append(buffer, static_cast<uint32_t>(m_values.size()));
+  for (size_t i = 0; i < m_index.size(); i++)
+  {
+    if (m_index[i] == 0)
+      continue;
+    Append(buffer, static_cast<uint32_t>(m_firstId + i));
+    Append(buffer, static_cast<uint32_t>(m_values[m_index[i] - 1].size()));
+  }
+  for (std::vector<std::string>::const_iterator it = m_values.begin(); it != m_values.end(); ++it)
+    buffer.append(*it);
+}
+
+bool CStringTable::Deserialize(const char *&data, const char *end)
+{
+  Clear();
+
+  uint32_t count;
+  if (!Extract(data, end, count) || static_cast<size_t>(end - data) / (2 * sizeof(uint32_t)) < count)
+    return false;
+
+  const char *lengths = data;
+  const char *blob = data + count * 2 * sizeof(uint32_t);
+  uint32_t firstId = 0, lastId = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t id, length;
+    Extract(data, blob, id);
+    Extract(data, blob, length);
+    if ((i > 0 && id <= lastId) || end - blob < static_cast<ptrdiff_t>(length))
+    {
+      Clear();
+      return false;
+    }
+    if (i == 0)
+    {
+      firstId = id;
+      m_firstId = id;
+    }
+    lastId = id;
+    m_values.push_back(std::string(blob, length));
+    blob += length;
+  }
+
+  if (count > 0)
+  {
+    if (static_cast<uint64_t>(lastId) - firstId + 1 > STRINGS_MAX_SPAN(count))
+    {
+      Clear();
+      return false;
+    }
+
+    m_index.resize(lastId - firstId + 1, 0);
+    data = lengths;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t id, length;
+      Extract(data, blob, id);
+      Extract(data, blob, length);
+      m_index[id - firstId] = i + 1;
+    }
+  }
+  data = blob;
+  return true;
+}
+
+void CStringTable::Clear()
+{
+  m_firstId = 0;
+  m_index.clear();
+  m_values.clear();
+}
+
 CLocalizeStrings::CLocalizeStrings(void)
 {
 
@@ -53,23 +213,159 @@ std::string CLocalizeStrings::ToUTF8(const std::string& strEncoding, const std::
 void CLocalizeStrings::ClearSkinStrings()
 {
   // clear the skin strings
-  Clear(31000, 31999);
+  m_skinTable.Clear();
 }
 
 bool CLocalizeStrings::LoadSkinStrings(const std::string& path, const std::string& language)
 {
+  CSingleLock lock(m_critSection);
   ClearSkinStrings();
   // load the skin strings in.
+  return LoadTable(path, language, m_skinTable, true);
+}
+
+bool CLocalizeStrings::GetLanguageDirectory(const std::string &pathname_in, const std::string &language,
+                                            std::string &pathname)
+{
+  pathname = CSpecialProtocol::TranslatePathConvertCase(pathname_in + language);
+  if (XFILE::CDirectory::Exists(pathname))
+    return true;
+
+  // check if there's a language addon using the old language naming convention
+  std::string lang;
+  if (ADDON::CLanguageResource::FindLegacyLanguage(language, lang))
+  {
+    pathname = CSpecialProtocol::TranslatePathConvertCase(pathname_in + lang);
+    if (XFILE::CDirectory::Exists(pathname))
+      return true;
+  }
+  return false;
+}
+
+std::string CLocalizeStrings::GetSourceStamp(const std::string &pathname, const std::string &language)
+{
+  std::string stamp;
+  std::string directory;
+  if (GetLanguageDirectory(pathname, language, directory))
+  {
+    static const char *files[] = { "strings.po", "strings.xml" };
+    for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+      std::string file = URIUtils::AddFileToFolder(directory, files[i]);
+      struct __stat64 buffer;
+      if (XFILE::CFile::Stat(file, &buffer) == 0)
+        stamp += StringUtils::Format("%s:%lld:%lld;", file.c_str(),
+                                     static_cast<long long>(buffer.st_mtime),
+                                     static_cast<long long>(buffer.st_size));
+    }
+  }
+
+  if (!StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT))
+    stamp += GetSourceStamp(pathname, LANGUAGE_DEFAULT);
+
+  return stamp;
+}
+
+bool CLocalizeStrings::LoadTable(const std::string &pathname, const std::string &language,
+                                 CStringTable &table, bool skin)
+{
+  const std::string stamp = GetSourceStamp(pathname, language);
+  if (stamp.empty())
+  {
+    CLog::Log(LOGDEBUG, "LocalizeStrings: no strings file exist for %s at %s",
+              language.c_str(), pathname.c_str());
+    return false;
+  }
+
+  // the compiled table is valid as long as the strings files it was compiled from didn't change
+  XBMC::XBMC_MD5 md5;
+  md5.append(pathname + "|" + language + (skin ? "|skin" : "|core"));
+  const std::string cacheFile = STRINGS_CACHE_PATH + md5.getDigest() + ".dat";
+
+  XFILE::auto_buffer cache;
+  if (XFILE::CFile::Exists(cacheFile) && XFILE::CFile().LoadFile(cacheFile, cache) > 0)
+  {
+    const char *data = cache.get();
+    const char *end = data + cache.size();
+    std::string magic, cachedStamp;
+    if (ExtractString(data, end, magic) && magic == STRINGS_CACHE_MAGIC &&
+        ExtractString(data, end, cachedStamp) && cachedStamp == stamp &&
+        table.Deserialize(data, end) && data == end)
+      return true;
+
+    CLog::Log(LOGDEBUG, "LocalizeStrings: compiled strings %s are outdated", cacheFile.c_str());
+    table.Clear();
+  }
+
   std::string encoding;
-  if (!LoadStr2Mem(path, language, encoding))
+  bool bLoadFallback = !StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT);
+
+  m_strings.clear();
+  if (!LoadStr2Mem(pathname, language, encoding))
   {
-    if (StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT)) // no fallback, nothing to do
+    // try loading the fallback
+    if (!bLoadFallback || !LoadStr2Mem(pathname, LANGUAGE_DEFAULT, encoding))
       return false;
+
+    bLoadFallback = false;
   }
 
-  // load the fallback
-  if (!StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT))
-    LoadStr2Mem(path, LANGUAGE_DEFAULT, encoding);
+  if (bLoadFallback)
+    LoadStr2Mem(pathname, LANGUAGE_DEFAULT, encoding);
+
+  if (!skin)
+  {
+    // fill in the constant strings
+    m_strings[20022].strTranslated = "";
+    m_strings[20027].strTranslated = "°F";
+    m_strings[20028].strTranslated = "K";
+    m_strings[20029].strTranslated = "°C";
+    m_strings[20030].strTranslated = "°Ré";
+    m_strings[20031].strTranslated = "°Ra";
+    m_strings[20032].strTranslated = "°Rø";
+    m_strings[20033].strTranslated = "°De";
+    m_strings[20034].strTranslated = "°N";
+
+    m_strings[20200].strTranslated = "km/h";
+    m_strings[20201].strTranslated = "m/min";
+    m_strings[20202].strTranslated = "m/s";
+    m_strings[20203].strTranslated = "ft/h";
+    m_strings[20204].strTranslated = "ft/min";
+    m_strings[20205].strTranslated = "ft/s";
+    m_strings[20206].strTranslated = "mph";
+    m_strings[20207].strTranslated = "kts";
+    m_strings[20208].strTranslated = "Beaufort";
+    m_strings[20209].strTranslated = "inch/s";
+    m_strings[20210].strTranslated = "yard/s";
+    m_strings[20211].strTranslated = "Furlong/Fortnight";
+  }
+
+  table.Compile(m_strings);
+  m_strings.clear();
+
+  // write to a temporary file first, so a partly written cache is never read
+  std::string buffer;
+  AppendString(buffer, STRINGS_CACHE_MAGIC);
+  AppendString(buffer, stamp);
+  table.Serialize(buffer);
+
+  const std::string tempFile = cacheFile + ".tmp";
+  XFILE::CFile file;
+  if (!XFILE::CDirectory::Exists(STRINGS_CACHE_PATH))
+    XFILE::CDirectory::Create(STRINGS_CACHE_PATH);
+  if (file.OpenForWrite(tempFile, true))
+  {
+    const bool written = file.Write(buffer.c_str(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+    file.Close();
+    // renaming doesn't replace an existing file everywhere
+    if (written && XFILE::CFile::Exists(cacheFile))
+      XFILE::CFile::Delete(cacheFile);
+    if (!written || !XFILE::CFile::Rename(tempFile, cacheFile))
+    {
+      CLog::Log(LOGWARNING, "LocalizeStrings: failed to write compiled strings %s", cacheFile.c_str());
+      XFILE::CFile::Delete(tempFile);
+    }
+  }
 
   return true;
 }
@@ -77,25 +373,13 @@ bool CLocalizeStrings::LoadSkinStrings(const std::string& path, const std::strin
 bool CLocalizeStrings::LoadStr2Mem(const std::string &pathname_in, const std::string &language,
                                    std::string &encoding, uint32_t offset /* = 0 */)
 {
-  std::string pathname = CSpecialProtocol::TranslatePathConvertCase(pathname_in + language);
-  if (!XFILE::CDirectory::Exists(pathname))
+  std::string pathname;
+  if (!GetLanguageDirectory(pathname_in, language, pathname))
   {
-    bool exists = false;
-    std::string lang;
-    // check if there's a language addon using the old language naming convention
-    if (ADDON::CLanguageResource::FindLegacyLanguage(language, lang))
-    {
-      pathname = CSpecialProtocol::TranslatePathConvertCase(pathname_in + lang);
-      exists = XFILE::CDirectory::Exists(pathname);
-    }
-
-    if (!exists)
-    {
-      CLog::Log(LOGDEBUG,
-                "LocalizeStrings: no translation available in currently set gui language, at path %s",
-                pathname.c_str());
-      return false;
-    }
+    CLog::Log(LOGDEBUG,
+              "LocalizeStrings: no translation available in currently set gui language, at path %s",
+              pathname.c_str());
+    return false;
   }
 
   if (LoadPO(URIUtils::AddFileToFolder(pathname, "strings.po"), encoding, offset,
@@ -197,74 +481,25 @@ bool CLocalizeStrings::LoadXML(const std::string &filename, std::string &encodin
 
 bool CLocalizeStrings::Load(const std::string& strPathName, const std::string& strLanguage)
 {
-  bool bLoadFallback = !StringUtils::EqualsNoCase(strLanguage, LANGUAGE_DEFAULT);
-
-  std::string encoding;
   CSingleLock lock(m_critSection);
   Clear();
 
-  if (!LoadStr2Mem(strPathName, strLanguage, encoding))
-  {
-    // try loading the fallback
-    if (!bLoadFallback || !LoadStr2Mem(strPathName, LANGUAGE_DEFAULT, encoding))
-      return false;
-
-    bLoadFallback = false;
-  }
-
-  if (bLoadFallback)
-    LoadStr2Mem(strPathName, LANGUAGE_DEFAULT, encoding);
-
-  // fill in the constant strings
-  m_strings[20022].strTranslated = "";
-  m_strings[20027].strTranslated = "°F";
-  m_strings[20028].strTranslated = "K";
-  m_strings[20029].strTranslated = "°C";
-  m_strings[20030].strTranslated = "°Ré";
-  m_strings[20031].strTranslated = "°Ra";
-  m_strings[20032].strTranslated = "°Rø";
-  m_strings[20033].strTranslated = "°De";
-  m_strings[20034].strTranslated = "°N";
-
-  m_strings[20200].strTranslated = "km/h";
-  m_strings[20201].strTranslated = "m/min";
-  m_strings[20202].strTranslated = "m/s";
-  m_strings[20203].strTranslated = "ft/h";
-  m_strings[20204].strTranslated = "ft/min";
-  m_strings[20205].strTranslated = "ft/s";
-  m_strings[20206].strTranslated = "mph";
-  m_strings[20207].strTranslated = "kts";
-  m_strings[20208].strTranslated = "Beaufort";
-  m_strings[20209].strTranslated = "inch/s";
-  m_strings[20210].strTranslated = "yard/s";
-  m_strings[20211].strTranslated = "Furlong/Fortnight";
-
-  return true;
+  return LoadTable(strPathName, strLanguage, m_table, false);
 }
 
 const std::string& CLocalizeStrings::Get(uint32_t dwCode) const
 {
-  ciStrings i = m_strings.find(dwCode);
-  if (i == m_strings.end())
-  {
+  const std::string *str = m_table.Get(dwCode);
+  if (str == NULL)
+    str = m_skinTable.Get(dwCode);
+  if (str == NULL)
     return StringUtils::Empty;
-  }
-  return i->second.strTranslated;
+  return *str;
 }
 
 void CLocalizeStrings::Clear()
 {
   m_strings.clear();
-}
-
-void CLocalizeStrings::Clear(uint32_t start, uint32_t end)
-{
-  iStrings it = m_strings.begin();
-  while (it != m_strings.end())
-  {
-    if (it->first >= start && it->first <= end)
-      m_strings.erase(it++);
-    else
-      ++it;
-  }
+  m_table.Clear();
+  m_skinTable.Clear();
 }
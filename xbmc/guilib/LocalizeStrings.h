@@ -32,6 +32,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 /*!
@@ -45,6 +46,44 @@ struct LocStr
   std::string strOriginal;   // the original English string the translation is based on
 };
 
+/*!
+ \ingroup strings
+ \brief The strings of a language compiled into a table indexed by id.
+
+ The translated strings are kept in a contiguous array, with an index
+ covering the range of ids that maps an id to its position in the array.
+ */
+class CStringTable
+{
+public:
+  CStringTable() : m_firstId(0) {}
+
+  /*! \brief Build the table from parsed strings, the original strings are left out.
+   */
+  void Compile(const std::map<uint32_t, LocStr> &strings);
+
+  /*! \brief Store the table in a buffer that can be read back with Deserialize.
+   */
+  void Serialize(std::string &buffer) const;
+  bool Deserialize(const char *&data, const char *end);
+
+  const std::string* Get(uint32_t id) const
+  {
+    // ids below the first one wrap around
+    const uint32_t pos = id - m_firstId;
+    if (pos >= m_index.size() || m_index[pos] == 0)
+      return NULL;
+    return &m_values[m_index[pos] - 1];
+  }
+
+  void Clear();
+
+private:
+  uint32_t m_firstId;
+  std::vector<uint32_t> m_index;     ///< position in m_values + 1 of id - m_firstId, 0 if there's no string
+  std::vector<std::string> m_values;
+};
+
 // The default fallback language is fixed to be English
 const std::string LANGUAGE_DEFAULT = "resource.language.en_gb";
 const std::string LANGUAGE_OLD_DEFAULT = "English";
@@ -61,7 +100,15 @@ public:
   void Clear();
 
 protected:
-  void Clear(uint32_t start, uint32_t end);
+  /*! \brief Loads the strings of a language and the fallback language into a table.
+   The table is taken from the cache if the strings files didn't change since it was compiled.
+   \param pathname The directory name, where we look for the language directories.
+   \param language We load the strings for this language. Fallback language is always English.
+   \param table [out] the strings.
+   \param skin Whether the strings are skin strings, only other strings get the constant strings.
+   \return false if no strings file was loaded.
+   */
+  bool LoadTable(const std::string &pathname, const std::string &language, CStringTable &table, bool skin);
 
   /*! \brief Loads language ids and strings to memory map m_strings.
    * It tries to load a strings.po file first. If doesn't exist, it loads a strings.xml file instead.
@@ -95,10 +142,16 @@ protected:
   bool LoadXML(const std::string &filename, std::string &encoding, uint32_t offset = 0);
 
   static std::string ToUTF8(const std::string &encoding, const std::string &str);
-  std::map<uint32_t, LocStr> m_strings;
+  static bool GetLanguageDirectory(const std::string &pathname, const std::string &language, std::string &directory);
+  static std::string GetSourceStamp(const std::string &pathname, const std::string &language);
+
+  std::map<uint32_t, LocStr> m_strings; ///< the strings being loaded, until they are compiled
   typedef std::map<uint32_t, LocStr>::const_iterator ciStrings;
   typedef std::map<uint32_t, LocStr>::iterator       iStrings;
 
+  CStringTable m_table;
+  CStringTable m_skinTable;
+
   CCriticalSection m_critSection;
 };
 
@@ -103,6 +103,13 @@ int CTextureBundle::LoadAnim(const std::string& Filename, CBaseTexture*** ppText
   }
 }
 
+void CTextureBundle::PrefetchTextures(const std::vector<std::string>& textures)
+{
+  // only XBT bundles support decoding in the background
+  if (m_useXBT)
+    m_tbXBT.PrefetchTextures(textures);
+}
+
 void CTextureBundle::Cleanup()
 {
   m_tbXBT.Cleanup();
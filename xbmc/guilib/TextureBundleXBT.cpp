@@ -18,6 +18,9 @@
  *
  */
 
+#include <list>
+#include <set>
+
 #include "squish.h"
 #include "system.h"
 #include "TextureBundleXBT.h"
@@ -28,6 +31,9 @@
 #include "settings/Settings.h"
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/XbtManager.h"
+#include "threads/SingleLock.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
 #include "XBTF.h"
@@ -37,6 +43,128 @@
 #pragma comment(lib,"liblzo2.lib")
 #endif
 
+// upper limit for the amount of memory used by prefetched but not yet loaded frames
+#define XBT_PREFETCH_MAX_SIZE (64 * 1024 * 1024)
+
+// Frames that have been decompressed in advance, keyed by their offset within the bundle.
+// The set of frames is shared with the decoding jobs so that it outlives a bundle reload.
+class CXBTFDecodedFrames
+{
+public:
+  CXBTFDecodedFrames() : m_size(0) { }
+
+  ~CXBTFDecodedFrames()
+  {
+    for (std::map<uint64_t, DecodedFrame>::iterator it = m_frames.begin(); it != m_frames.end(); ++it)
+      delete[] it->second.buffer;
+  }
+
+  bool MarkPending(uint64_t offset)
+  {
+    CSingleLock lock(m_section);
+    if (m_frames.find(offset) != m_frames.end())
+      return false;
+
+    return m_pending.insert(offset).second;
+  }
+
+  void Store(uint64_t offset, uint8_t* buffer, size_t size)
+  {
+    CSingleLock lock(m_section);
+    // the frame may have been loaded in the meantime or may not fit at all
+    if (m_pending.erase(offset) == 0 || size > XBT_PREFETCH_MAX_SIZE)
+    {
+      delete[] buffer;
+      return;
+    }
+
+    // make room by dropping the frames that were prefetched the longest time ago,
+    // they were likely prefetched for a window that isn't going to be shown
+    while (m_size + size > XBT_PREFETCH_MAX_SIZE && !m_lru.empty())
+    {
+      std::map<uint64_t, DecodedFrame>::iterator oldest = m_frames.find(m_lru.back());
+      delete[] oldest->second.buffer;
+      m_size -= oldest->second.size;
+      m_frames.erase(oldest);
+      m_lru.pop_back();
+    }
+
+    m_lru.push_front(offset);
+    DecodedFrame frame = { buffer, size, m_lru.begin() };
+    m_frames.insert(std::make_pair(offset, frame));
+    m_size += size;
+  }
+
+  uint8_t* Take(uint64_t offset)
+  {
+    CSingleLock lock(m_section);
+    m_pending.erase(offset);
+
+    std::map<uint64_t, DecodedFrame>::iterator it = m_frames.find(offset);
+    if (it == m_frames.end())
+      return nullptr;
+
+    uint8_t* buffer = it->second.buffer;
+    m_size -= it->second.size;
+    m_lru.erase(it->second.age);
+    m_frames.erase(it);
+
+    return buffer;
+  }
+
+private:
+  struct DecodedFrame
+  {
+    uint8_t* buffer;
+    size_t size;
+    std::list<uint64_t>::iterator age;
+  };
+
+  CCriticalSection m_section;
+  std::set<uint64_t> m_pending;
+  std::map<uint64_t, DecodedFrame> m_frames;
+  std::list<uint64_t> m_lru; ///< offsets of the decoded frames, most recently stored first
+  size_t m_size;
+};
+
+class CXBTFDecodeJob : public CJob
+{
+public:
+  CXBTFDecodeJob(const CXBTFReaderPtr& reader, const std::shared_ptr<CXBTFDecodedFrames>& decodedFrames, const std::vector<CXBTFFrame>& frames)
+    : m_reader(reader),
+      m_mapping(reader->GetMapping()),
+      m_decodedFrames(decodedFrames),
+      m_frames(frames)
+  { }
+
+  virtual const char *GetType() const { return "xbtdecode"; }
+
+  virtual bool DoWork()
+  {
+    for (std::vector<CXBTFFrame>::const_iterator frame = m_frames.begin(); frame != m_frames.end(); ++frame)
+    {
+      // hold on to the mapping so that a skin reload doesn't pull it away from under us
+      uint8_t* buffer;
+      if (m_mapping != nullptr)
+        buffer = CTextureBundleXBT::DecompressFrame(m_mapping.get() + frame->GetOffset(), *frame);
+      else
+        buffer = CTextureBundleXBT::UnpackFrame(*m_reader, *frame);
+      if (buffer == nullptr)
+        return false;
+
+      m_decodedFrames->Store(frame->GetOffset(), buffer, static_cast<size_t>(frame->GetUnpackedSize()));
+    }
+
+    return true;
+  }
+
+private:
+  CXBTFReaderPtr m_reader;
+  std::shared_ptr<const uint8_t> m_mapping;
+  std::shared_ptr<CXBTFDecodedFrames> m_decodedFrames;
+  std::vector<CXBTFFrame> m_frames;
+};
+
 CTextureBundleXBT::CTextureBundleXBT(void)
 {
   m_themeBundle = false;
@@ -85,6 +213,7 @@ bool CTextureBundleXBT::OpenBundle()
   CLog::Log(LOGDEBUG, "%s - Opened bundle %s", __FUNCTION__, m_path.c_str());
 
   m_TimeStamp = m_XBTFReader->GetLastModificationTimestamp();
+  m_decodedFrames = std::make_shared<CXBTFDecodedFrames>();
 
   if (lzo_init() != LZO_E_OK)
   {
@@ -189,45 +318,57 @@ int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppT
   return nTextures;
 }
 
-bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
+void CTextureBundleXBT::PrefetchTextures(const std::vector<std::string>& textures)
 {
-  // found texture - allocate the necessary buffers
-  squish::u8 *buffer = new squish::u8[(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
-  {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
-    return false;
-  }
+  if (m_XBTFReader == nullptr || !m_XBTFReader->IsOpen() || m_decodedFrames == nullptr)
+    return;
 
-  // load the compressed texture
-  if (!m_XBTFReader->Load(frame, buffer))
+  for (std::vector<std::string>::const_iterator it = textures.begin(); it != textures.end(); ++it)
   {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
-    return false;
+    CXBTFFile file;
+    if (!m_XBTFReader->Get(Normalize(*it), file))
+      continue;
+
+    // only packed frames are worth decoding ahead of time, stored
+    // frames are used straight from the bundle
+    std::vector<CXBTFFrame> frames;
+    for (std::vector<CXBTFFrame>::const_iterator frame = file.GetFrames().begin(); frame != file.GetFrames().end(); ++frame)
+    {
+      if (!frame->IsPacked() || (m_XBTFReader->IsMapped() && m_XBTFReader->GetFrameData(*frame) == nullptr))
+        continue;
+
+      if (m_decodedFrames->MarkPending(frame->GetOffset()))
+        frames.push_back(*frame);
+    }
+
+    if (!frames.empty())
+      CJobManager::GetInstance().AddJob(new CXBTFDecodeJob(m_XBTFReader, m_decodedFrames, frames), nullptr, CJob::PRIORITY_NORMAL);
   }
+}
+
+bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
+{
+  uint8_t* buffer = nullptr;
+  if (m_decodedFrames != nullptr)
+    buffer = m_decodedFrames->Take(frame.GetOffset());
 
-  // check if it's packed with lzo
-  if (frame.IsPacked())
-  { // unpack
-    squish::u8 *unpacked = new squish::u8[(size_t)frame.GetUnpackedSize()];
-    if (unpacked == NULL)
+  if (buffer == nullptr)
+  {
+    // stored frames can be used in place if the bundle is memory-mapped
+    const uint8_t* data = m_XBTFReader->GetFrameData(frame);
+    if (data != nullptr && !frame.IsPacked())
     {
-      CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
-      delete[] buffer;
-      return false;
+      *ppTexture = new CTexture();
+      (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), const_cast<uint8_t*>(data));
+      return true;
     }
-    lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
-        s != frame.GetUnpackedSize())
+
+    buffer = UnpackFrame(*m_XBTFReader, frame);
+    if (buffer == nullptr)
     {
-      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
-      delete[] buffer;
-      delete[] unpacked;
+      CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
       return false;
     }
-    delete[] buffer;
-    buffer = unpacked;
   }
 
   // create an xbmc texture
@@ -244,6 +385,7 @@ void CTextureBundleXBT::Cleanup()
   if (m_XBTFReader != nullptr && m_XBTFReader->IsOpen())
   {
     XFILE::CXbtManager::GetInstance().Release(CURL(m_path));
+    m_decodedFrames.reset();
     CLog::Log(LOGDEBUG, "%s - Closed %sbundle", __FUNCTION__, m_themeBundle ? "theme " : "");
   }
 }
@@ -268,6 +410,11 @@ std::string CTextureBundleXBT::Normalize(const std::string &name)
 
 uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
 {
+  // packed frames can be decompressed straight from the memory-mapped bundle
+  const uint8_t* mappedData = reader.GetFrameData(frame);
+  if (mappedData != nullptr && frame.IsPacked())
+    return DecompressFrame(mappedData, frame);
+
   uint8_t* packedBuffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
   if (packedBuffer == nullptr)
   {
@@ -287,11 +434,18 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   if (!frame.IsPacked())
     return packedBuffer;
 
+  uint8_t* unpackedBuffer = DecompressFrame(packedBuffer, frame);
+  delete[] packedBuffer;
+
+  return unpackedBuffer;
+}
+
+uint8_t* CTextureBundleXBT::DecompressFrame(const uint8_t* packedBuffer, const CXBTFFrame& frame)
+{
   uint8_t* unpackedBuffer = new uint8_t[static_cast<size_t>(frame.GetUnpackedSize())];
   if (unpackedBuffer == nullptr)
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" unpacked bytes", frame.GetPackedSize());
-    delete[] packedBuffer;
     return nullptr;
   }
 
@@ -299,7 +453,6 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   if (lzo_init() != LZO_E_OK)
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to initialize lzo");
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
@@ -308,12 +461,9 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   if (lzo1x_decompress_safe(packedBuffer, static_cast<lzo_uint>(frame.GetPackedSize()), unpackedBuffer, &size, nullptr) != LZO_E_OK || size != frame.GetUnpackedSize())
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to decompress frame with %" PRIu64" unpacked bytes to %" PRIu64" bytes", frame.GetPackedSize(), frame.GetUnpackedSize());
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
 
-  delete[] packedBuffer;
-
   return unpackedBuffer;
 }
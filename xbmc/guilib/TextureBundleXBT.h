@@ -21,10 +21,12 @@
  */
 
 #include <map>
+#include <memory>
 #include <string>
 #include "XBTFReader.h"
 
 class CBaseTexture;
+class CXBTFDecodedFrames;
 
 class CTextureBundleXBT
 {
@@ -44,7 +46,16 @@ public:
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures,
                 int &width, int &height, int& nLoops, int** ppDelays);
 
+  /*!
+   \brief Decompress the packed frames of the given textures in the background.
+   The decompressed frames are kept until they are picked up by LoadTexture() or LoadAnim(),
+   or until they have to make room for more recently prefetched frames.
+   \param textures the (normalized) names of the textures that are likely to be loaded next
+   */
+  void PrefetchTextures(const std::vector<std::string>& textures);
+
   static uint8_t* UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame);
+  static uint8_t* DecompressFrame(const uint8_t* packedBuffer, const CXBTFFrame& frame);
 
 private:
   bool OpenBundle();
@@ -55,6 +66,7 @@ private:
   bool m_themeBundle;
   std::string m_path;
   CXBTFReaderPtr m_XBTFReader;
+  std::shared_ptr<CXBTFDecodedFrames> m_decodedFrames;
 };
 
 
@@ -629,3 +629,36 @@ void CGUITextureManager::GetBundledTexturesFromPath(const std::string& texturePa
   if (items.empty())
     m_TexBundle[1].GetTexturesFromPath(texturePath, items);
 }
+
+void CGUITextureManager::PrefetchTextures(const std::vector<std::string>& textureNames)
+{
+  std::vector<std::string> bundled[2];
+  for (std::vector<std::string>::const_iterator it = textureNames.begin(); it != textureNames.end(); ++it)
+  {
+    if (!CanLoad(*it))
+      continue;
+
+    bool loaded = false;
+    for (ivecTextures i = m_vecTextures.begin(); i != m_vecTextures.end() && !loaded; ++i)
+      loaded = (*i)->GetName() == *it;
+    if (loaded)
+      continue;
+
+    // the theme bundle takes precedence just like in HasTexture()
+    std::string bundledName = CTextureBundle::Normalize(*it);
+    for (int i = 0; i < 2; i++)
+    {
+      if (m_TexBundle[i].HasFile(bundledName))
+      {
+        bundled[i].push_back(bundledName);
+        break;
+      }
+    }
+  }
+
+  for (int i = 0; i < 2; i++)
+  {
+    if (!bundled[i].empty())
+      m_TexBundle[i].PrefetchTextures(bundled[i]);
+  }
+}
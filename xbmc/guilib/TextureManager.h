@@ -117,6 +117,7 @@ public:
   void Flush();
   std::string GetTexturePath(const std::string& textureName, bool directory = false);
   void GetBundledTexturesFromPath(const std::string& texturePath, std::vector<std::string> &items);
+  void PrefetchTextures(const std::vector<std::string>& textureNames); ///< Start decoding bundled textures that are about to be loaded
 
   void AddTexturePath(const std::string &texturePath);    ///< Add a new path to the paths to check when loading media
   void SetTexturePath(const std::string &texturePath);    ///< Set a single path as the path to check when loading media (clear then add)
@@ -22,9 +22,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#if defined(TARGET_POSIX)
+#include <sys/mman.h>
+#endif
 
 #include "XBTFReader.h"
 #include "guilib/XBTF.h"
+#include "threads/SingleLock.h"
 #include "utils/EndianSwap.h"
 
 #ifdef TARGET_WINDOWS
@@ -68,7 +72,9 @@ static bool ReadUInt64(FILE* file, uint64_t& value)
 CXBTFReader::CXBTFReader()
   : CXBTFBase(),
     m_path(),
-    m_file(nullptr)
+    m_file(nullptr),
+    m_mappedData(),
+    m_mappedSize(0)
 { }
 
 CXBTFReader::~CXBTFReader()
@@ -176,6 +182,10 @@ bool CXBTFReader::Open(const std::string& path)
   if (pos != GetHeaderSize())
     return false;
 
+  // try to map the whole bundle so that frames can be accessed in place.
+  // if that fails we fall back to reading every frame from the file.
+  Map();
+
   return true;
 }
 
@@ -186,6 +196,10 @@ bool CXBTFReader::IsOpen() const
 
 void CXBTFReader::Close()
 {
+  Unmap();
+
+  // decoding jobs may still be reading frames from the file
+  CSingleLock lock(m_fileSection);
   if (m_file != nullptr)
   {
     fclose(m_file);
@@ -213,6 +227,19 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
   if (m_file == nullptr)
     return false;
 
+  const uint8_t* data = GetFrameData(frame);
+  if (data != nullptr)
+  {
+    memcpy(buffer, data, static_cast<size_t>(frame.GetPackedSize()));
+    return true;
+  }
+
+  // the file position is shared so seeking and reading must not be interleaved,
+  // and the file may have been closed while decoding in the background
+  CSingleLock lock(m_fileSection);
+  if (m_file == nullptr)
+    return false;
+
 #if defined(TARGET_DARWIN) || defined(TARGET_FREEBSD) || defined(TARGET_ANDROID)
   if (fseeko(m_file, static_cast<off_t>(frame.GetOffset()), SEEK_SET) == -1)
 #else
@@ -225,3 +252,45 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
 
   return true;
 }
+
+const uint8_t* CXBTFReader::GetFrameData(const CXBTFFrame& frame) const
+{
+  if (m_mappedData == nullptr)
+    return nullptr;
+
+  if (frame.GetOffset() > m_mappedSize || frame.GetPackedSize() > m_mappedSize - frame.GetOffset())
+    return nullptr;
+
+  return m_mappedData.get() + frame.GetOffset();
+}
+
+bool CXBTFReader::Map()
+{
+#if defined(TARGET_POSIX)
+  if (m_file == nullptr || m_mappedData != nullptr)
+    return false;
+
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == -1 || fileStat.st_size <= 0)
+    return false;
+
+  void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fileno(m_file), 0);
+  if (data == MAP_FAILED)
+    return false;
+
+  // the mapping is released once the reader and all users of GetMapping() are done with it
+  size_t size = static_cast<size_t>(fileStat.st_size);
+  m_mappedData.reset(static_cast<const uint8_t*>(data), [size](const uint8_t* mappedData) { munmap(const_cast<uint8_t*>(mappedData), size); });
+  m_mappedSize = static_cast<uint64_t>(fileStat.st_size);
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CXBTFReader::Unmap()
+{
+  m_mappedData.reset();
+  m_mappedSize = 0;
+}
@@ -26,6 +26,7 @@
 #include <stdint.h>
 
 #include "XBTF.h"
+#include "threads/CriticalSection.h"
 
 class CXBTFReader : public CXBTFBase
 {
@@ -41,9 +42,31 @@ public:
 
   bool Load(const CXBTFFrame& frame, unsigned char* buffer) const;
 
+  /*!
+   \brief Get a pointer to the (packed) data of the given frame inside the memory-mapped bundle.
+   The returned data stays valid as long as the reader is open.
+   \param frame the frame to retrieve the data for
+   \return pointer to the frame's data or nullptr if the bundle isn't memory-mapped
+   */
+  const uint8_t* GetFrameData(const CXBTFFrame& frame) const;
+
+  /*!
+   \brief Get a reference to the memory-mapped bundle which keeps the mapping alive even after the reader has been closed.
+   \return the start of the mapped bundle or an empty pointer if the bundle isn't memory-mapped
+   */
+  std::shared_ptr<const uint8_t> GetMapping() const { return m_mappedData; }
+
+  bool IsMapped() const { return m_mappedData != nullptr; }
+
 private:
+  bool Map();
+  void Unmap();
+
   std::string m_path;
   FILE* m_file;
+  std::shared_ptr<const uint8_t> m_mappedData;
+  uint64_t m_mappedSize;
+  mutable CCriticalSection m_fileSection;
 };
 
 typedef std::shared_ptr<CXBTFReader> CXBTFReaderPtr;
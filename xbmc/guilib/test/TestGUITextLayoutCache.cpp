@@ -0,0 +1,152 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUITextLayoutCache.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+  // fonts are only compared, never dereferenced
+  const CGUIFont *FakeFont(uintptr_t id)
+  {
+    return reinterpret_cast<const CGUIFont*>(id);
+  }
+
+  CGUITextLayoutCache::Key MakeKey(const std::wstring &text)
+  {
+    CGUITextLayoutCache::Key key;
+    key.text = text;
+    key.font = FakeFont(1);
+    key.wrapWidth = 0;
+    key.maxHeight = 0;
+    key.textColor = 0;
+    key.forceLTRReadingOrder = false;
+    key.scaleX = 1.0f;
+    key.scaleY = 1.0f;
+    return key;
+  }
+
+  CGUITextLayoutCache::LayoutPtr MakeLayout(const vecText &text)
+  {
+    std::shared_ptr<CGUITextLayoutCache::Layout> layout(new CGUITextLayoutCache::Layout);
+    layout->lines.push_back(CGUIString(text.begin(), text.end(), false));
+    layout->colors.push_back(0xffffffff);
+    layout->width = 100.0f;
+    layout->height = 20.0f;
+    return layout;
+  }
+}
+
+class TestGUITextLayoutCache : public testing::Test
+{
+protected:
+  TestGUITextLayoutCache()
+  {
+    m_text.push_back('a');
+    m_text.push_back('b');
+    CGUITextLayoutCache::GetInstance().Flush();
+  }
+
+  ~TestGUITextLayoutCache()
+  {
+    CGUITextLayoutCache::GetInstance().Flush();
+  }
+
+  vecText m_text;
+};
+
+TEST_F(TestGUITextLayoutCache, GetAfterAdd)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::GetInstance();
+  CGUITextLayoutCache::Key key = MakeKey(L"ab");
+  EXPECT_TRUE(cache.Get(key) == nullptr);
+
+  cache.Add(key, MakeLayout(m_text));
+  CGUITextLayoutCache::LayoutPtr layout = cache.Get(MakeKey(L"ab"));
+  ASSERT_TRUE(layout != nullptr);
+  ASSERT_EQ(1U, layout->lines.size());
+  EXPECT_EQ(m_text, layout->lines[0].m_text);
+  EXPECT_FALSE(layout->lines[0].m_carriageReturn);
+  EXPECT_EQ(100.0f, layout->width);
+  EXPECT_EQ(20.0f, layout->height);
+
+  // adding the same key again keeps the first layout
+  cache.Add(key, MakeLayout(vecText()));
+  EXPECT_EQ(layout, cache.Get(key));
+}
+
+TEST_F(TestGUITextLayoutCache, KeyInequality)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::GetInstance();
+  cache.Add(MakeKey(L"ab"), MakeLayout(m_text));
+
+  CGUITextLayoutCache::Key key = MakeKey(L"ab");
+  key.scaleX = 1.5f;
+  EXPECT_TRUE(cache.Get(key) == nullptr);
+
+  key = MakeKey(L"ab");
+  key.scaleY = 1.5f;
+  EXPECT_TRUE(cache.Get(key) == nullptr);
+
+  key = MakeKey(L"ab");
+  key.wrapWidth = 200.0f;
+  EXPECT_TRUE(cache.Get(key) == nullptr);
+
+  key = MakeKey(L"ab");
+  key.textColor = 0xff00ff00;
+  EXPECT_TRUE(cache.Get(key) == nullptr);
+
+  key = MakeKey(L"ab");
+  key.font = FakeFont(2);
+  EXPECT_TRUE(cache.Get(key) == nullptr);
+
+  EXPECT_TRUE(cache.Get(MakeKey(L"ab")) != nullptr);
+}
+
+TEST_F(TestGUITextLayoutCache, Eviction)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::GetInstance();
+  for (int i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++)
+    cache.Add(MakeKey(std::to_wstring(i)), MakeLayout(m_text));
+
+  // using the oldest entry makes the second oldest the least recently used
+  EXPECT_TRUE(cache.Get(MakeKey(L"0")) != nullptr);
+  cache.Add(MakeKey(L"new"), MakeLayout(m_text));
+
+  EXPECT_TRUE(cache.Get(MakeKey(L"0")) != nullptr);
+  EXPECT_TRUE(cache.Get(MakeKey(L"1")) == nullptr);
+  EXPECT_TRUE(cache.Get(MakeKey(L"2")) != nullptr);
+  EXPECT_TRUE(cache.Get(MakeKey(L"new")) != nullptr);
+}
+
+TEST_F(TestGUITextLayoutCache, Flush)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::GetInstance();
+  cache.Add(MakeKey(L"ab"), MakeLayout(m_text));
+  cache.Add(MakeKey(L"cd"), MakeLayout(m_text));
+  cache.Flush();
+  EXPECT_TRUE(cache.Get(MakeKey(L"ab")) == nullptr);
+  EXPECT_TRUE(cache.Get(MakeKey(L"cd")) == nullptr);
+
+  // the cache is usable after flushing
+  cache.Add(MakeKey(L"ab"), MakeLayout(m_text));
+  EXPECT_TRUE(cache.Get(MakeKey(L"ab")) != nullptr);
+}
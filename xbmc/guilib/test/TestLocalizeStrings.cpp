@@ -0,0 +1,160 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/LocalizeStrings.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+  void AddString(std::map<uint32_t, LocStr> &strings, uint32_t id, const std::string &text)
+  {
+    LocStr str;
+    str.strTranslated = text;
+    strings[id] = str;
+  }
+
+  void Patch(std::string &buffer, size_t offset, uint32_t value)
+  {
+    memcpy(&buffer[offset], &value, sizeof(value));
+  }
+}
+
+class TestStringTable : public testing::Test
+{
+protected:
+  TestStringTable()
+  {
+    AddString(m_strings, 20, "first");
+    AddString(m_strings, 21, "");
+    AddString(m_strings, 500, "after a gap");
+    AddString(m_strings, 31000, "skin string");
+    m_table.Compile(m_strings);
+    m_table.Serialize(m_buffer);
+  }
+
+  std::map<uint32_t, LocStr> m_strings;
+  CStringTable m_table;
+  std::string m_buffer;
+};
+
+TEST_F(TestStringTable, Compile)
+{
+  ASSERT_TRUE(m_table.Get(20) != NULL);
+  EXPECT_EQ("first", *m_table.Get(20));
+  ASSERT_TRUE(m_table.Get(21) != NULL);
+  EXPECT_EQ("", *m_table.Get(21));
+  EXPECT_TRUE(m_table.Get(19) == NULL);
+  EXPECT_TRUE(m_table.Get(22) == NULL);
+  EXPECT_TRUE(m_table.Get(31001) == NULL);
+  EXPECT_TRUE(m_table.Get(0) == NULL);
+}
+
+TEST_F(TestStringTable, RoundTrip)
+{
+  CStringTable table;
+  const char *data = m_buffer.c_str();
+  const char *end = data + m_buffer.size();
+  ASSERT_TRUE(table.Deserialize(data, end));
+  EXPECT_EQ(end, data);
+
+  for (std::map<uint32_t, LocStr>::const_iterator it = m_strings.begin(); it != m_strings.end(); ++it)
+  {
+    ASSERT_TRUE(table.Get(it->first) != NULL);
+    EXPECT_EQ(it->second.strTranslated, *table.Get(it->first));
+  }
+  EXPECT_TRUE(table.Get(19) == NULL);
+  EXPECT_TRUE(table.Get(499) == NULL);
+  EXPECT_TRUE(table.Get(31001) == NULL);
+
+  // serializing again gives the same buffer
+  std::string buffer;
+  table.Serialize(buffer);
+  EXPECT_EQ(m_buffer, buffer);
+}
+
+TEST_F(TestStringTable, RoundTripEmpty)
+{
+  CStringTable empty;
+  std::string buffer;
+  empty.Serialize(buffer);
+
+  CStringTable table;
+  const char *data = buffer.c_str();
+  ASSERT_TRUE(table.Deserialize(data, buffer.c_str() + buffer.size()));
+  EXPECT_TRUE(table.Get(0) == NULL);
+}
+
+TEST_F(TestStringTable, Truncated)
+{
+  for (size_t size = 0; size < m_buffer.size(); size++)
+  {
+    CStringTable table;
+    const char *data = m_buffer.c_str();
+    EXPECT_FALSE(table.Deserialize(data, data + size)) << "size " << size;
+    EXPECT_TRUE(table.Get(20) == NULL);
+  }
+}
+
+TEST_F(TestStringTable, UnorderedIds)
+{
+  // swap the ids of the first two strings
+  Patch(m_buffer, sizeof(uint32_t), 21);
+  Patch(m_buffer, 3 * sizeof(uint32_t), 20);
+
+  CStringTable table;
+  const char *data = m_buffer.c_str();
+  EXPECT_FALSE(table.Deserialize(data, data + m_buffer.size()));
+}
+
+TEST_F(TestStringTable, HugeIdSpan)
+{
+  // a corrupt last id must not make the index cover billions of ids
+  Patch(m_buffer, 7 * sizeof(uint32_t), 0xfffffff0);
+
+  CStringTable table;
+  const char *data = m_buffer.c_str();
+  EXPECT_FALSE(table.Deserialize(data, data + m_buffer.size()));
+  EXPECT_TRUE(table.Get(20) == NULL);
+}
+
+TEST_F(TestStringTable, StrayId)
+{
+  // a stray id is dropped instead of making the index cover billions of ids
+  AddString(m_strings, 0xfffffff0, "stray");
+  CStringTable table;
+  table.Compile(m_strings);
+  EXPECT_TRUE(table.Get(0xfffffff0) == NULL);
+  ASSERT_TRUE(table.Get(31000) != NULL);
+  EXPECT_EQ("skin string", *table.Get(31000));
+  ASSERT_TRUE(table.Get(20) != NULL);
+  EXPECT_EQ("first", *table.Get(20));
+
+  // the compiled table can be read back
+  std::string buffer;
+  table.Serialize(buffer);
+  CStringTable copy;
+  const char *data = buffer.c_str();
+  ASSERT_TRUE(copy.Deserialize(data, data + buffer.size()));
+  ASSERT_TRUE(copy.Get(500) != NULL);
+  EXPECT_EQ("after a gap", *copy.Get(500));
+}
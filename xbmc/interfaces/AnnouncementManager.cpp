@@ -20,7 +20,11 @@
 
 #include "AnnouncementManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include <algorithm>
 #include <stdio.h>
+#include <string.h>
+#include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
@@ -36,6 +40,9 @@
 using namespace ANNOUNCEMENT;
 
 CAnnouncementManager::CAnnouncementManager()
+  : CThread("Announce"),
+    m_sequence(0),
+    m_deinitialized(false)
 { }
 
 CAnnouncementManager::~CAnnouncementManager()
@@ -51,6 +58,17 @@ CAnnouncementManager& CAnnouncementManager::GetInstance()
 
 void CAnnouncementManager::Deinitialize()
 {
+  {
+    CSingleLock lock (m_queueSection);
+    m_deinitialized = true;
+  }
+  StopThread();
+
+  CAnnounceData announcement;
+  unsigned int wait;
+  while (GetNext(announcement, true, wait))
+    Dispatch(announcement);
+
   CSingleLock lock (m_critSection);
   m_announcers.clear();
 }
@@ -69,15 +87,33 @@ void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
   if (!listener)
     return;
 
-  CSingleLock lock (m_critSection);
-  for (unsigned int i = 0; i < m_announcers.size(); i++)
   {
-    if (m_announcers[i] == listener)
+    CSingleLock lock (m_critSection);
+    for (unsigned int i = 0; i < m_announcers.size(); i++)
     {
-      m_announcers.erase(m_announcers.begin() + i);
-      return;
+      if (m_announcers[i] == listener)
+      {
+        m_announcers.erase(m_announcers.begin() + i);
+        break;
+      }
     }
   }
+
+  // the listener may still be called by announcements being delivered on other threads,
+  // wait for them (the current thread may be delivering one, e.g. to the listener itself)
+  CSingleLock lock (m_critSection);
+  while (IsDeliveringOnOtherThread())
+    m_delivered.wait(lock);
+}
+
+bool CAnnouncementManager::IsDeliveringOnOtherThread() const
+{
+  for (std::vector<ThreadIdentifier>::const_iterator it = m_delivering.begin(); it != m_delivering.end(); ++it)
+  {
+    if (!CThread::IsCurrentThread(*it))
+      return true;
+  }
+  return false;
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message)
@@ -88,14 +124,7 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data)
 {
-  CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
-
-  CSingleLock lock (m_critSection);
-
-  // Make a copy of announers. They may be removed or even remove themselves during execution of IAnnouncer::Announce()!
-  std::vector<IAnnouncer *> announcers(m_announcers); 
-  for (unsigned int i = 0; i < announcers.size(); i++)
-    announcers[i]->Announce(flag, sender, message, data);
+  Queue(flag, sender, message, CFileItemPtr(), data);
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
@@ -106,12 +135,216 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data)
 {
-  if (!item.get())
+  // the item is prepared on the dispatcher thread, so it mustn't change in the meantime
+  Queue(flag, sender, message, item.get() ? CFileItemPtr(new CFileItem(*item)) : item, data);
+}
+
+void CAnnouncementManager::Process()
+{
+  while (!m_bStop)
+  {
+    unsigned int wait;
+    CAnnounceData announcement;
+    if (GetNext(announcement, false, wait))
+    {
+      Dispatch(announcement);
+      continue;
+    }
+
+    AbortableWait(m_queueEvent, wait);
+  }
+}
+
+void CAnnouncementManager::Queue(AnnouncementFlag flag, const char *sender, const char *message, const CFileItemPtr &item, const CVariant &data)
+{
+  if (flag == System)
+  {
+    // announcers may need to act on these before we e.g. suspend or quit,
+    // so dispatch them right away
+    CAnnounceData announcement;
+    announcement.flag = flag;
+    announcement.sender = sender;
+    announcement.message = message;
+    announcement.item = item;
+    announcement.data = data;
+    Dispatch(announcement);
+    return;
+  }
+
+  std::string key;
+  if (flag == VideoLibrary || flag == AudioLibrary)
+  {
+    key = GetItemKey(item, data);
+    if (!key.empty())
+      key = StringUtils::Format("%s/%s", AnnouncementFlagToString(flag), key.c_str());
+  }
+
+  CSingleLock lock (m_queueSection);
+  if (m_deinitialized)
+    return;
+
+  if (!key.empty())
+  {
+    // an update is merged into an update of the same item which is still waiting,
+    // unless something else happened to the item in between
+    std::map<std::string, AnnounceQueue::iterator>::iterator last = m_lastQueued.find(key);
+    if (last != m_lastQueued.end() && last->second->message == "OnUpdate" && strcmp(message, "OnUpdate") == 0)
+    {
+      last->second->sender = sender;
+      last->second->item = item;
+      MergeData(last->second->data, data);
+      return;
+    }
+  }
+
+  CAnnounceData announcement;
+  announcement.flag = flag;
+  announcement.sender = sender;
+  announcement.message = message;
+  announcement.item = item;
+  announcement.data = data;
+  announcement.key = key;
+  announcement.time = XbmcThreads::SystemClockMillis();
+  announcement.sequence = m_sequence++;
+  // library announcements keep their order among themselves, as the ones held back
+  // mustn't be overtaken by e.g. the end of the scan that caused them
+  AnnounceQueue &queue = (flag == VideoLibrary || flag == AudioLibrary) ? m_libraryQueue : m_queue;
+  queue.push_back(announcement);
+  if (!key.empty())
+    m_lastQueued[key] = --queue.end();
+
+  if (!IsRunning())
+    Create();
+  m_queueEvent.Set();
+}
+
+bool CAnnouncementManager::GetNext(CAnnounceData &announcement, bool all, unsigned int &wait)
+{
+  CSingleLock lock (m_queueSection);
+  wait = 1000;
+
+  // library updates may be held back for a while so more of them get coalesced,
+  // the other announcements are dispatched in the meantime
+  bool libraryDue = false;
+  if (!m_libraryQueue.empty())
   {
-    Announce(flag, sender, message, data);
+    const CAnnounceData &oldest = m_libraryQueue.front();
+    unsigned int delay = g_advancedSettings.m_jsonLibraryAnnouncementDelay;
+    unsigned int age = XbmcThreads::SystemClockMillis() - oldest.time;
+    if (all || delay == 0 || oldest.key.empty() || age >= delay)
+      libraryDue = true;
+    else
+      wait = delay - age;
+  }
+
+  // otherwise announcements are dispatched in the order they were queued
+  AnnounceQueue *queue;
+  if (libraryDue && (m_queue.empty() || m_libraryQueue.front().sequence < m_queue.front().sequence))
+    queue = &m_libraryQueue;
+  else if (!m_queue.empty())
+    queue = &m_queue;
+  else
+    return false;
+
+  AnnounceQueue::iterator next = queue->begin();
+  if (!next->key.empty())
+  {
+    std::map<std::string, AnnounceQueue::iterator>::iterator last = m_lastQueued.find(next->key);
+    if (last != m_lastQueued.end() && last->second == next)
+      m_lastQueued.erase(last);
+  }
+
+  announcement = *next;
+  queue->pop_front();
+  return true;
+}
+
+void CAnnouncementManager::MergeData(CVariant &data, const CVariant &update)
+{
+  // fields of the earlier update (e.g. "added") are kept unless they're updated
+  if (!data.isObject() || !update.isObject())
+  {
+    if (!update.isNull())
+      data = update;
+    return;
+  }
+
+  for (CVariant::const_iterator_map it = update.begin_map(); it != update.end_map(); ++it)
+    data[it->first] = it->second;
+}
+
+void CAnnouncementManager::Dispatch(const CAnnounceData &announcement)
+{
+  // don't bother preparing announcements nobody is interested in
+  bool wanted = false;
+  {
+    CSingleLock lock (m_critSection);
+    for (unsigned int i = 0; i < m_announcers.size() && !wanted; i++)
+      wanted = (m_announcers[i]->GetAnnouncementFlags() & announcement.flag) != 0;
+  }
+  if (!wanted)
     return;
+
+  if (announcement.item.get())
+    DoAnnounce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.item, announcement.data);
+  else
+    DoAnnounce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.data);
+}
+
+void CAnnouncementManager::DoAnnounce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
+
+  // Make a copy of announers. They may be removed or even remove themselves during execution of IAnnouncer::Announce()!
+  // No lock is held while they're called, RemoveAnnouncer() waits for the delivery instead.
+  std::vector<IAnnouncer *> announcers;
+  {
+    CSingleLock lock (m_critSection);
+    announcers = m_announcers;
+    m_delivering.push_back(CThread::GetCurrentThreadId());
+  }
+  for (unsigned int i = 0; i < announcers.size(); i++)
+  {
+    // skip announcers removed by the ones called before them
+    {
+      CSingleLock lock (m_critSection);
+      if (std::find(m_announcers.begin(), m_announcers.end(), announcers[i]) == m_announcers.end())
+        continue;
+    }
+    if (announcers[i]->GetAnnouncementFlags() & flag)
+      announcers[i]->Announce(flag, sender, message, data);
   }
 
+  CSingleLock lock (m_critSection);
+  for (std::vector<ThreadIdentifier>::iterator it = m_delivering.begin(); it != m_delivering.end(); ++it)
+  {
+    if (CThread::IsCurrentThread(*it))
+    {
+      m_delivering.erase(it);
+      break;
+    }
+  }
+  m_delivered.notifyAll();
+}
+
+std::string CAnnouncementManager::GetItemKey(const CFileItemPtr &item, const CVariant &data)
+{
+  if (item.get())
+  {
+    if (item->HasVideoInfoTag() && item->GetVideoInfoTag()->m_iDbId > 0)
+      return StringUtils::Format("%s/%d", item->GetVideoInfoTag()->m_type.c_str(), item->GetVideoInfoTag()->m_iDbId);
+    if (item->HasMusicInfoTag() && item->GetMusicInfoTag()->GetDatabaseId() > 0)
+      return StringUtils::Format("%s/%d", item->GetMusicInfoTag()->GetType().c_str(), item->GetMusicInfoTag()->GetDatabaseId());
+    return "";
+  }
+
+  if (data.isObject() && data.isMember("type") && data.isMember("id"))
+    return StringUtils::Format("%s/%" PRId64, data["type"].asString().c_str(), data["id"].asInteger());
+  return "";
+}
+
+void CAnnouncementManager::DoAnnounce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, const CVariant &data)
+{
   // Extract db id of item
   CVariant object = data.isNull() || data.isObject() ? data : CVariant::VariantTypeObject;
   std::string type;
@@ -248,5 +481,5 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
   if (id > 0)
     object["item"]["id"] = id;
 
-  Announce(flag, sender, message, object);
+  DoAnnounce(flag, sender, message, object);
 }
@@ -18,24 +18,43 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <list>
+#include <map>
+#include <string>
 #include <vector>
 
 #include "IAnnouncer.h"
 #include "FileItem.h"
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
 #include "utils/GlobalsHandling.h"
-
-class CVariant;
+#include "utils/Variant.h"
 
 namespace ANNOUNCEMENT
 {
-  class CAnnouncementManager
+  /*!
+   \brief Passes announcements on to all registered announcers.
+
+   Announcements are queued and dispatched by a separate thread so the announcing
+   thread never waits for the announcers. An update of a library item replaces
+   an update of the same item still waiting in the queue, keeping the fields of
+   the earlier update. Library announcements may be held back for a while to
+   coalesce more updates, other announcements overtake them in the meantime.
+   System announcements are dispatched synchronously as
+   their announcers may need to act before the announcing thread continues.
+   */
+  class CAnnouncementManager : private CThread
   {
   public:
     virtual ~CAnnouncementManager();
 
     static CAnnouncementManager& GetInstance();
 
+    /*!
+     \brief Dispatch all queued announcements and stop the dispatcher thread.
+     */
     void Deinitialize();
 
     void AddAnnouncer(IAnnouncer *listener);
@@ -45,12 +64,54 @@ namespace ANNOUNCEMENT
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
+
+  protected:
+    virtual void Process();
+
   private:
     CAnnouncementManager();
     CAnnouncementManager(const CAnnouncementManager&);
     CAnnouncementManager const& operator=(CAnnouncementManager const&);
 
-    CCriticalSection m_critSection;
+    struct CAnnounceData
+    {
+      AnnouncementFlag flag;
+      std::string sender;
+      std::string message;
+      CFileItemPtr item;
+      CVariant data;
+      std::string key;      ///< identifies the library item an update is about
+      unsigned int time;    ///< when the announcement was queued
+      uint64_t sequence;    ///< order in which the announcements were queued
+    };
+    typedef std::list<CAnnounceData> AnnounceQueue;
+
+    void Queue(AnnouncementFlag flag, const char *sender, const char *message, const CFileItemPtr &item, const CVariant &data);
+    /*!
+     \brief Take the next announcement which is due from the queue.
+     \param announcement [out] the announcement
+     \param all whether to ignore the delay of library announcements
+     \param wait [out] how long to wait for the next announcement to become due (in ms)
+     */
+    bool GetNext(CAnnounceData &announcement, bool all, unsigned int &wait);
+    bool IsDeliveringOnOtherThread() const;
+    static void MergeData(CVariant &data, const CVariant &update);
+    void Dispatch(const CAnnounceData &announcement);
+    void DoAnnounce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+    void DoAnnounce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, const CVariant &data);
+    static std::string GetItemKey(const CFileItemPtr &item, const CVariant &data);
+
+    CCriticalSection m_critSection;        ///< protects the announcers
     std::vector<IAnnouncer *> m_announcers;
+    std::vector<ThreadIdentifier> m_delivering; ///< threads calling the announcers
+    XbmcThreads::ConditionVariable m_delivered;
+
+    CCriticalSection m_queueSection;
+    AnnounceQueue m_queue;                 ///< announcements other than the library ones
+    AnnounceQueue m_libraryQueue;          ///< library announcements, updates may be held back
+    uint64_t m_sequence;
+    std::map<std::string, AnnounceQueue::iterator> m_lastQueued; ///< last queued announcement for each item
+    CEvent m_queueEvent;
+    bool m_deinitialized;
   };
 }
@@ -79,5 +79,12 @@ namespace ANNOUNCEMENT
     IAnnouncer() { };
     virtual ~IAnnouncer() { };
     virtual void Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data) = 0;
+
+    /*!
+      \brief Returns the announcements the announcer is currently
+      interested in, others aren't prepared for and passed to it
+      \return Combination of AnnouncementFlags
+      */
+    virtual int GetAnnouncementFlags() { return ANNOUNCE_ALL; }
   };
 }
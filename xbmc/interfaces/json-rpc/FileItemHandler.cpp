@@ -210,6 +210,16 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
 }
 
 void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit /* = true */)
+{
+  HandleFileItemList(ID, allowFile, resultname, items, parameterObject, result, size, sortLimit, false);
+}
+
+void CFileItemHandler::StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit /* = true */)
+{
+  HandleFileItemList(ID, allowFile, resultname, items, parameterObject, result, size, sortLimit, CJSONRPC::CanDeferResult());
+}
+
+void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit, bool stream)
 {
   int start, end;
   HandleLimits(parameterObject, result, size, start, end);
@@ -241,6 +251,15 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
       fields.insert(field->asString());
   }
 
+  if (stream && end - start > 0)
+  {
+    // the generator takes over the thumbloader and serializes one item at a time
+    // while the response is written, so the whole list is never held as CVariant
+    result[resultname] = CVariant(CVariant::VariantTypeArray);
+    CJSONRPC::DeferResult(resultname, new CFileItemGenerator(ID, allowFile, resultname, items, start, end, parameterObject, fields, thumbLoader));
+    return;
+  }
+
   for (int i = start; i < end; i++)
   {
     CFileItemPtr item = items.Get(i);
@@ -250,6 +269,38 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
   delete thumbLoader;
 }
 
+CFileItemHandler::CFileItemGenerator::CFileItemGenerator(const char *ID, bool allowFile, const char *resultname, const CFileItemList &items, int start, int end,
+                                                         const CVariant &parameterObject, const std::set<std::string> &fields, CThumbLoader *thumbLoader)
+  : m_ID(ID != NULL ? ID : ""),
+    m_hasID(ID != NULL),
+    m_allowFile(allowFile),
+    m_resultname(resultname),
+    m_current(start),
+    m_end(end),
+    m_parameterObject(parameterObject),
+    m_fields(fields),
+    m_thumbLoader(thumbLoader)
+{
+  m_items.Assign(items);
+}
+
+CFileItemHandler::CFileItemGenerator::~CFileItemGenerator()
+{
+  delete m_thumbLoader;
+}
+
+bool CFileItemHandler::CFileItemGenerator::Next(CVariant &element)
+{
+  if (m_current >= m_end)
+    return false;
+
+  CVariant object;
+  HandleFileItem(m_hasID ? m_ID.c_str() : NULL, m_allowFile, m_resultname.c_str(), m_items.Get(m_current++), m_parameterObject, m_fields, object, false, m_thumbLoader);
+  element.swap(object[m_resultname]);
+
+  return true;
+}
+
 void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append /* = true */, CThumbLoader *thumbLoader /* = NULL */)
 {
   std::set<std::string> fields;
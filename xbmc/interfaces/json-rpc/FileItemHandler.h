@@ -36,11 +36,40 @@ namespace JSONRPC
     static void FillDetails(const ISerializable *info, const CFileItemPtr &item, std::set<std::string> &fields, CVariant &result, CThumbLoader *thumbLoader = NULL);
     static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, bool sortLimit = true);
     static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit = true);
+    /*!
+     \brief Same as HandleFileItemList() but the items are only serialized while
+     the response is written, if the current method call allows it.
+     Must only be used if the result isn't modified afterwards.
+     */
+    static void StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit = true);
     static void HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append = true, CThumbLoader *thumbLoader = NULL);
     static void HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const std::set<std::string> &validFields, CVariant &result, bool append = true, CThumbLoader *thumbLoader = NULL);
 
     static bool FillFileItemList(const CVariant &parameterObject, CFileItemList &list);
   private:
+    class CFileItemGenerator : public CJSONVariantWriter::IArrayGenerator
+    {
+    public:
+      CFileItemGenerator(const char *ID, bool allowFile, const char *resultname, const CFileItemList &items, int start, int end,
+                         const CVariant &parameterObject, const std::set<std::string> &fields, CThumbLoader *thumbLoader);
+      virtual ~CFileItemGenerator();
+
+      virtual bool Next(CVariant &element);
+
+    private:
+      std::string m_ID;
+      bool m_hasID;
+      bool m_allowFile;
+      std::string m_resultname;
+      CFileItemList m_items;
+      int m_current;
+      int m_end;
+      CVariant m_parameterObject;
+      std::set<std::string> m_fields;
+      CThumbLoader *m_thumbLoader;
+    };
+
+    static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit, bool stream);
     static void Sort(CFileItemList &items, const CVariant& parameterObject);
     static bool GetField(const std::string &field, const CVariant &info, const CFileItemPtr &item, CVariant &result, bool &fetchedArt, CThumbLoader *thumbLoader = NULL);
   };
@@ -18,6 +18,7 @@
  *
  */
 
+#include <memory>
 #include <string.h>
 
 #include "JSONRPC.h"
@@ -29,6 +30,7 @@
 #include "interfaces/AnnouncementManager.h"
 #include "playlists/SmartPlayList.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/ThreadLocal.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -39,6 +41,18 @@ using namespace JSONRPC;
 
 bool CJSONRPC::m_initialized = false;
 
+namespace
+{
+  struct DeferredResult
+  {
+    std::string member;
+    std::unique_ptr<CJSONVariantWriter::IArrayGenerator> generator;
+  };
+
+  // the deferred result of the (single) method call being handled on this thread
+  XbmcThreads::ThreadLocal<DeferredResult> tlDeferredResult;
+}
+
 void CJSONRPC::Initialize()
 {
   if (m_initialized)
@@ -237,6 +251,7 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
 {
   CVariant inputroot, outputroot, result;
   bool hasResponse = false;
+  DeferredResult deferred;
 
   if(g_advancedSettings.CanLogComponent(LOGJSONRPC))
     CLog::Log(LOGDEBUG, "JSONRPC: Incoming request: %s", inputString.c_str());
@@ -266,7 +281,14 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
       }
     }
     else
+    {
+      // only a single call may write its result while the response is generated,
+      // the responses of a batch call are all kept until the batch is complete
+      DeferredResult *previous = tlDeferredResult.get();
+      tlDeferredResult.set(&deferred);
       hasResponse = HandleMethodCall(inputroot, outputroot, transport, client);
+      tlDeferredResult.set(previous);
+    }
   }
   else
   {
@@ -275,10 +297,43 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
     hasResponse = true;
   }
 
+  if (hasResponse && deferred.generator && outputroot.isMember("result") &&
+      outputroot["result"].isObject() && outputroot["result"].isMember(deferred.member))
+  {
+    std::vector<std::string> path;
+    path.push_back("result");
+    path.push_back(deferred.member);
+
+    std::string str;
+    if (CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact, path, *deferred.generator, str))
+      return str;
+
+    CLog::Log(LOGERROR, "JSONRPC: Failed to write the result of '%s'", inputString.c_str());
+    return "";
+  }
+
   std::string str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
   return str;
 }
 
+bool CJSONRPC::CanDeferResult()
+{
+  return tlDeferredResult.get() != NULL;
+}
+
+void CJSONRPC::DeferResult(const std::string &member, CJSONVariantWriter::IArrayGenerator *generator)
+{
+  DeferredResult *deferred = tlDeferredResult.get();
+  if (deferred == NULL)
+  {
+    delete generator;
+    return;
+  }
+
+  deferred->member = member;
+  deferred->generator.reset(generator);
+}
+
 bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
 {
   JSONRPC_STATUS errorCode = OK;
@@ -296,7 +351,13 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     CVariant params;
 
     if ((errorCode = CJSONServiceDescription::CheckCall(methodName.c_str(), request["params"], transport, client, isNotification, method, params)) == OK)
+    {
       errorCode = method(methodName, transport, client, params, result);
+
+      DeferredResult *deferred = tlDeferredResult.get();
+      if (deferred != NULL && errorCode != OK)
+        deferred->generator.reset();
+    }
     else
       result = params;
   }
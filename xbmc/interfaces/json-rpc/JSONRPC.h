@@ -26,6 +26,7 @@
 
 #include "JSONRPCUtils.h"
 #include "JSONServiceDescription.h"
+#include "utils/JSONVariantWriter.h"
 
 class CVariant;
 
@@ -64,6 +65,25 @@ namespace JSONRPC
      */
     static std::string MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client);
 
+    /*!
+     \brief Whether the result of the method currently being called may be
+     written to the response while it is produced (see DeferResult()).
+     */
+    static bool CanDeferResult();
+
+    /*!
+     \brief Produce the elements of an array member of the result while the
+     response is written instead of holding them all in the result.
+     \param member name of the member of the result holding the array
+     \param generator produces the elements of the array, ownership is transferred
+     \sa CanDeferResult()
+
+     The result has to hold an empty array for the given member which marks
+     where the produced elements are written. The generator is discarded if the
+     method call fails.
+     */
+    static void DeferResult(const std::string &member, CJSONVariantWriter::IArrayGenerator *generator);
+
     static JSONRPC_STATUS Introspect(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
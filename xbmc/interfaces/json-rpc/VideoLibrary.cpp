@@ -139,7 +139,9 @@ JSONRPC_STATUS CVideoLibrary::GetMovieSetDetails(const std::string &method, ITra
   if (!videodatabase.GetMoviesNav("videodb://movies/titles/", items, -1, -1, -1, -1, -1, -1, id, -1, SortDescription(), RequiresAdditionalDetails(MediaTypeMovie, parameterObject["movies"])))
     return InternalError;
 
-  return HandleItems("movieid", "movies", items, parameterObject["movies"], result["setdetails"], true);
+  // the movies are nested in the set details so they can't be streamed
+  HandleFileItemList("movieid", true, "movies", items, parameterObject["movies"], result["setdetails"]);
+  return OK;
 }
 
 JSONRPC_STATUS CVideoLibrary::GetTVShows(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
@@ -968,7 +970,7 @@ JSONRPC_STATUS CVideoLibrary::HandleItems(const char *idProperty, const char *re
   int size = items.Size();
   if (!limit && items.HasProperty("total") && items.GetProperty("total").asInteger() > size)
     size = (int)items.GetProperty("total").asInteger();
-  HandleFileItemList(idProperty, true, resultName, items, parameterObject, result, size, limit);
+  StreamFileItemList(idProperty, true, resultName, items, parameterObject, result, size, limit);
 
   return OK;
 }
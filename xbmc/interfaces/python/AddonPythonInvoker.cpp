@@ -130,3 +130,9 @@ const char* CAddonPythonInvoker::getInitializationScript() const
 {
   return RUNSCRIPT_COMPLIANT;
 }
+
+bool CAddonPythonInvoker::reuseInterpreter() const
+{
+  // only the entry point of plugins, which are run for every directory they list
+  return m_addon && m_addon->Type() == ADDON::ADDON_PLUGIN && m_sourceFile == m_addon->LibPath();
+}
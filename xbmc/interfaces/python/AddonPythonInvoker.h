@@ -31,4 +31,5 @@ protected:
   // overrides of CPythonInvoker
   virtual std::map<std::string, PythonModuleInitialization> getModules() const;
   virtual const char* getInitializationScript() const;
+  virtual bool reuseInterpreter() const;
 };
@@ -0,0 +1,214 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if (defined HAVE_CONFIG_H) && (!defined TARGET_WINDOWS)
+  #include "config.h"
+#endif
+
+// python.h should always be included first before any other includes
+#include <Python.h>
+
+#include "system.h"
+#include "PythonInterpreterPool.h"
+#include "addons/AddonManager.h"
+#include "interfaces/python/LanguageHook.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#ifdef TARGET_POSIX
+#include "linux/XMemUtils.h"
+#endif
+
+// how often idle interpreters and the available memory are checked
+#define POOL_CHECK_INTERVAL 1000 // ms
+
+CPythonInterpreterPool::CPythonInterpreterPool()
+  : m_generation(0),
+    m_lastCheck(0),
+    m_observing(false)
+{ }
+
+CPythonInterpreterPool::~CPythonInterpreterPool()
+{
+  // python is gone by now, the interpreters went with it
+}
+
+bool CPythonInterpreterPool::IsEnabled() const
+{
+  return g_advancedSettings.m_pythonInterpreterPoolSize > 0;
+}
+
+bool CPythonInterpreterPool::Acquire(const std::string &addonId, void *&interpreter, std::string &pythonPath, unsigned int &generation)
+{
+  CSingleLock lock(m_critical);
+  generation = m_generation;
+  for (std::list<Interpreter>::iterator it = m_interpreters.begin(); it != m_interpreters.end(); ++it)
+  {
+    if (it->addonId == addonId)
+    {
+      interpreter = it->interpreter;
+      pythonPath = it->pythonPath;
+      m_interpreters.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CPythonInterpreterPool::Release(const std::string &addonId, void *interpreter, const std::string &pythonPath, unsigned int generation)
+{
+  bool observe = false;
+  std::vector<void*> ended;
+  {
+    CSingleLock lock(m_critical);
+    observe = !m_observing;
+    m_observing = true;
+
+    // an interpreter that was in use while add-ons changed may hold outdated modules
+    const unsigned int size = g_advancedSettings.m_pythonInterpreterPoolSize;
+    if (size > 0 && generation == m_generation && !IsMemoryLow())
+    {
+      Interpreter entry;
+      entry.addonId = addonId;
+      entry.interpreter = interpreter;
+      entry.pythonPath = pythonPath;
+      entry.idleSince = XbmcThreads::SystemClockMillis();
+      m_interpreters.push_front(entry);
+      interpreter = NULL;
+
+      // make room by ending the interpreters that were idle the longest
+      while (m_interpreters.size() > size)
+      {
+        ended.push_back(m_interpreters.back().interpreter);
+        m_interpreters.pop_back();
+      }
+    }
+  }
+
+  // changed add-ons invalidate the interpreters. Registering while holding our
+  // lock could deadlock with a notification that is being sent.
+  if (observe)
+    ADDON::CAddonMgr::GetInstance().RegisterObserver(this);
+
+  if (interpreter != NULL)
+    ended.push_back(interpreter);
+  for (std::vector<void*>::const_iterator it = ended.begin(); it != ended.end(); ++it)
+    End(*it);
+}
+
+void CPythonInterpreterPool::Process()
+{
+  std::vector<void*> ended;
+  {
+    CSingleLock lock(m_critical);
+    ended.swap(m_expired);
+
+    const unsigned int now = XbmcThreads::SystemClockMillis();
+    if (!m_interpreters.empty() && now - m_lastCheck >= POOL_CHECK_INTERVAL)
+    {
+      m_lastCheck = now;
+      const bool memoryLow = IsMemoryLow();
+      const unsigned int idleTime = g_advancedSettings.m_pythonInterpreterIdleTime * 1000;
+      for (std::list<Interpreter>::iterator it = m_interpreters.begin(); it != m_interpreters.end();)
+      {
+        if (memoryLow || now - it->idleSince >= idleTime)
+        {
+          ended.push_back(it->interpreter);
+          it = m_interpreters.erase(it);
+        }
+        else
+          ++it;
+      }
+    }
+  }
+
+  if (!ended.empty())
+    CLog::Log(LOGDEBUG, "CPythonInterpreterPool: ending %u idle interpreters", static_cast<unsigned int>(ended.size()));
+  for (std::vector<void*>::const_iterator it = ended.begin(); it != ended.end(); ++it)
+    End(*it);
+}
+
+void CPythonInterpreterPool::Clear()
+{
+  std::vector<void*> ended;
+  {
+    CSingleLock lock(m_critical);
+    ended.swap(m_expired);
+    for (std::list<Interpreter>::const_iterator it = m_interpreters.begin(); it != m_interpreters.end(); ++it)
+      ended.push_back(it->interpreter);
+    m_interpreters.clear();
+  }
+
+  for (std::vector<void*>::const_iterator it = ended.begin(); it != ended.end(); ++it)
+    End(*it);
+}
+
+bool CPythonInterpreterPool::IsEmpty() const
+{
+  CSingleLock lock(m_critical);
+  return m_interpreters.empty() && m_expired.empty();
+}
+
+void CPythonInterpreterPool::Notify(const Observable &obs, const ObservableMessage msg)
+{
+  if (msg != ObservableMessageAddons)
+    return;
+
+  // the modules an interpreter holds on to may have been updated. Notifications can
+  // be sent from python threads, the interpreters are ended by the next Process.
+  // Interpreters that are in use are ended when they are released.
+  CSingleLock lock(m_critical);
+  m_generation++;
+  for (std::list<Interpreter>::const_iterator it = m_interpreters.begin(); it != m_interpreters.end(); ++it)
+    m_expired.push_back(it->interpreter);
+  m_interpreters.clear();
+}
+
+void CPythonInterpreterPool::End(void *interpreter)
+{
+  PyInterpreterState *interp = static_cast<PyInterpreterState*>(interpreter);
+
+  PyEval_AcquireLock();
+  PyThreadState *state = PyThreadState_New(interp);
+  PyThreadState_Swap(state);
+
+  // the language hook of the interpreter was kept registered along with it
+  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook =
+    XBMCAddon::Python::PythonLanguageHook::GetIfExists(interp);
+
+  Py_EndInterpreter(state);
+
+  // unregister before releasing the GIL, a new interpreter may be created at the same address
+  languageHook->UnregisterMe();
+  PyEval_ReleaseLock();
+}
+
+bool CPythonInterpreterPool::IsMemoryLow()
+{
+  const unsigned int minFree = g_advancedSettings.m_pythonInterpreterPoolMinFreeMemory;
+  if (minFree == 0)
+    return false;
+
+  MEMORYSTATUSEX stat;
+  stat.dwLength = sizeof(MEMORYSTATUSEX);
+  GlobalMemoryStatusEx(&stat);
+  return stat.ullAvailPhys / (1024 * 1024) < minFree;
+}
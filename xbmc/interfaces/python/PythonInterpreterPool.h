@@ -0,0 +1,109 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "utils/Observer.h"
+
+/*!
+ \brief Keeps the interpreters of finished plugin invocations warm for the next
+ invocation of the same add-on.
+
+ Creating a sub-interpreter and importing the modules of an add-on takes most of
+ the time of a plugin directory listing. Instead of being ended, the interpreter
+ of a plugin that ran successfully is kept along with the modules it imported,
+ except for the modules of the add-on itself, and is handed to the next
+ invocation of that add-on.
+
+ Interpreters are ended once they were idle for too long, to make room for more
+ recently used ones, when memory runs low and whenever add-ons change. The pool
+ is disabled unless its size is set in the advanced settings.
+
+ Interpreters are passed around as PyInterpreterState pointers, to keep Python.h
+ out of the header.
+ */
+class CPythonInterpreterPool : public Observer
+{
+public:
+  CPythonInterpreterPool();
+  virtual ~CPythonInterpreterPool();
+
+  /*!
+   \brief Whether interpreters are kept at all.
+   */
+  bool IsEnabled() const;
+
+  /*!
+   \brief Take a warm interpreter of an add-on out of the pool.
+   \param addonId id of the add-on
+   \param interpreter [out] the interpreter
+   \param pythonPath [out] the python path the interpreter was set up with
+   \param generation [out] the state of the add-ons the interpreter belongs to, to be
+   passed to Release. Also set if there's no warm interpreter, for a new interpreter.
+   \return true if there was a warm interpreter, false otherwise.
+   */
+  bool Acquire(const std::string &addonId, void *&interpreter, std::string &pythonPath, unsigned int &generation);
+
+  /*!
+   \brief Hand the interpreter of a finished invocation to the pool.
+   The interpreter must not have any thread state left and the GIL must not be held.
+   The interpreter is ended if the pool doesn't keep it, or if add-ons changed since
+   it was acquired as its modules may be outdated.
+   */
+  void Release(const std::string &addonId, void *interpreter, const std::string &pythonPath, unsigned int generation);
+
+  /*!
+   \brief End the interpreters that were idle for too long or got invalidated.
+   Must be called without holding the GIL.
+   */
+  void Process();
+
+  /*!
+   \brief End all interpreters. Must be called without holding the GIL.
+   */
+  void Clear();
+
+  bool IsEmpty() const;
+
+  virtual void Notify(const Observable &obs, const ObservableMessage msg) override;
+
+private:
+  struct Interpreter
+  {
+    std::string addonId;
+    void *interpreter;
+    std::string pythonPath;
+    unsigned int idleSince;
+  };
+
+  static void End(void *interpreter);
+  static bool IsMemoryLow();
+
+  mutable CCriticalSection m_critical;
+  std::list<Interpreter> m_interpreters; ///< most recently released first
+  std::vector<void*> m_expired;          ///< interpreters to end on the next Process
+  unsigned int m_generation;             ///< incremented whenever add-ons change
+  unsigned int m_lastCheck;
+  bool m_observing;
+};
@@ -160,9 +160,16 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
 
   CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): start processing", GetId(), m_sourceFile.c_str());
 
+  // an interpreter kept from an earlier run of the add-on has its modules imported already
+  CPythonInterpreterPool& pool = g_pythonParser.GetInterpreterPool();
+  const bool reusable = reuseInterpreter() && pool.IsEnabled();
+  void* interpreter = NULL;
+  unsigned int generation = 0;
+  const bool warm = reusable && pool.Acquire(m_addon->ID(), interpreter, m_pythonPath, generation);
+
   // get the global lock
   PyEval_AcquireLock();
-  PyThreadState* state = Py_NewInterpreter();
+  PyThreadState* state = warm ? PyThreadState_New(static_cast<PyInterpreterState*>(interpreter)) : Py_NewInterpreter();
   if (state == NULL)
   {
     PyEval_ReleaseLock();
@@ -172,10 +179,25 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   // swap in my thread state
   PyThreadState_Swap(state);
 
-  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook(new XBMCAddon::Python::PythonLanguageHook(state->interp));
-  languageHook->RegisterMe();
+  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook;
+  if (warm)
+  {
+    CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): reusing the interpreter of an earlier run", GetId(), m_sourceFile.c_str());
+
+    // the language hook stays registered with a kept interpreter
+    languageHook = XBMCAddon::Python::PythonLanguageHook::GetIfExists(state->interp);
+
+    PyObject *m = PyImport_AddModule((char*)"xbmc");
+    if (m == NULL || PyObject_SetAttrString(m, (char*)"abortRequested", Py_False))
+      CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): failed to reset abortRequested", GetId(), m_sourceFile.c_str());
+  }
+  else
+  {
+    languageHook = new XBMCAddon::Python::PythonLanguageHook(state->interp);
+    languageHook->RegisterMe();
 
-  onInitialization();
+    onInitialization();
+  }
   setState(InvokerStateInitialized);
 
   std::string realFilename(CSpecialProtocol::TranslatePath(m_sourceFile));
@@ -188,47 +210,8 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   // this is used for python so it will search modules from script path first
   std::string scriptDir = URIUtils::GetDirectory(realFilename);
   URIUtils::RemoveSlashAtEnd(scriptDir);
-  addPath(scriptDir);
-
-  // add all addon module dependecies to path
-  if (m_addon)
-  {
-    std::set<std::string> paths;
-    getAddonModuleDeps(m_addon, paths);
-    for (std::set<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
-      addPath(*it);
-  }
-  else
-  { // for backwards compatibility.
-    // we don't have any addon so just add all addon modules installed
-    CLog::Log(LOGWARNING, "CPythonInvoker(%d): Script invoked without an addon. Adding all addon "
-        "modules installed to python path as fallback. This behaviour will be removed in future "
-        "version.", GetId());
-    ADDON::VECADDONS addons;
-    ADDON::CAddonMgr::GetInstance().GetAddons(addons, ADDON::ADDON_SCRIPT_MODULE);
-    for (unsigned int i = 0; i < addons.size(); ++i)
-      addPath(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
-  }
-
-  // we want to use sys.path so it includes site-packages
-  // if this fails, default to using Py_GetPath
-  PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
-  PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
-  PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
-
-  if (pathObj != NULL && PyList_Check(pathObj))
-  {
-    for (int i = 0; i < PyList_Size(pathObj); i++)
-    {
-      PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
-      if (e != NULL && PyString_Check(e))
-        addNativePath(PyString_AsString(e)); // returns internal data, don't delete or modify
-    }
-  }
-  else
-    addNativePath(Py_GetPath());
-
-  Py_DECREF(sysMod); // release ref to sysMod
+  if (!warm)
+    setupPath(scriptDir);
 
   // set current directory and python's path.
   if (m_argv != NULL)
@@ -399,6 +382,23 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
 
   onDeinitialization();
 
+  // keep the interpreter of a cleanly finished run for the next run of the add-on
+  if (reusable && stateToSet == InvokerStateDone && !m_stop)
+  {
+    resetInterpreter(moduleDict);
+
+    PyInterpreterState* interp = state->interp;
+    PyThreadState_Clear(state);
+    PyThreadState_Swap(NULL);
+    PyThreadState_Delete(state);
+    PyEval_ReleaseLock();
+
+    pool.Release(m_addon->ID(), interp, m_pythonPath, generation);
+
+    setState(stateToSet);
+    return true;
+  }
+
   // run the gc before finishing
   //
   // if the script exited by throwing a SystemExit excepton then going back
@@ -428,6 +428,87 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   return true;
 }
 
+void CPythonInvoker::setupPath(const std::string& scriptDir)
+{
+  addPath(scriptDir);
+
+  // add all addon module dependecies to path
+  if (m_addon)
+  {
+    std::set<std::string> paths;
+    getAddonModuleDeps(m_addon, paths);
+    for (std::set<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+      addPath(*it);
+  }
+  else
+  { // for backwards compatibility.
+    // we don't have any addon so just add all addon modules installed
+    CLog::Log(LOGWARNING, "CPythonInvoker(%d): Script invoked without an addon. Adding all addon "
+        "modules installed to python path as fallback. This behaviour will be removed in future "
+        "version.", GetId());
+    ADDON::VECADDONS addons;
+    ADDON::CAddonMgr::GetInstance().GetAddons(addons, ADDON::ADDON_SCRIPT_MODULE);
+    for (unsigned int i = 0; i < addons.size(); ++i)
+      addPath(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
+  }
+
+  // we want to use sys.path so it includes site-packages
+  // if this fails, default to using Py_GetPath
+  PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
+  PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
+  PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
+
+  if (pathObj != NULL && PyList_Check(pathObj))
+  {
+    for (int i = 0; i < PyList_Size(pathObj); i++)
+    {
+      PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
+      if (e != NULL && PyString_Check(e))
+        addNativePath(PyString_AsString(e)); // returns internal data, don't delete or modify
+    }
+  }
+  else
+    addNativePath(Py_GetPath());
+
+  Py_DECREF(sysMod); // release ref to sysMod
+}
+
+void CPythonInvoker::resetInterpreter(void* moduleDict)
+{
+  // start the next run with a fresh __main__ module
+  PyObject *mainDict = static_cast<PyObject*>(moduleDict);
+  PyDict_Clear(mainDict);
+  PyDict_SetItemString(mainDict, "__builtins__", PyImport_AddModule((char*)"__builtin__"));
+  PyObject *name = PyString_FromString("__main__");
+  PyDict_SetItemString(mainDict, "__name__", name);
+  Py_DECREF(name);
+  PyDict_SetItemString(mainDict, "__doc__", Py_None);
+  PyDict_SetItemString(mainDict, "__package__", Py_None);
+
+  // the modules of the add-on itself tend to keep state of the run, like its handle.
+  // Only the modules it depends on are kept.
+  const std::string addonPath = CSpecialProtocol::TranslatePath(m_addon->Path());
+  std::vector<std::string> addonModules;
+  PyObject *modules = PyImport_GetModuleDict(); // borrowed ref
+  PyObject *key, *value;
+  Py_ssize_t pos = 0;
+  while (PyDict_Next(modules, &pos, &key, &value))
+  {
+    if (!PyString_Check(key) || !PyModule_Check(value))
+      continue;
+    const char *file = PyModule_GetFilename(value);
+    if (file == NULL)
+      PyErr_Clear(); // built-in module
+    else if (StringUtils::StartsWith(file, addonPath))
+      addonModules.push_back(PyString_AsString(key));
+  }
+  for (std::vector<std::string>::const_iterator it = addonModules.begin(); it != addonModules.end(); ++it)
+    PyDict_DelItemString(modules, it->c_str());
+
+  PyErr_Clear();
+  PyGC_Collect();
+}
+
 void CPythonInvoker::executeScript(void *fp, const std::string &script, void *module, void *moduleDict)
 {
   if (fp == NULL || script.empty() || module == NULL || moduleDict == NULL)
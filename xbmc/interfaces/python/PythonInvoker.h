@@ -53,6 +53,12 @@ protected:
   virtual void onPythonModuleInitialization(void* moduleDict);
   virtual void onDeinitialization();
 
+  /*!
+   \brief Whether the interpreter may be kept for the next run of the add-on
+   once the script finished, see CPythonInterpreterPool.
+   */
+  virtual bool reuseInterpreter() const { return false; }
+
   virtual void onSuccess() { }
   virtual void onAbort() { }
   virtual void onError(const std::string &exceptionType = "", const std::string &exceptionValue = "", const std::string &exceptionTraceback = "");
@@ -67,6 +73,8 @@ private:
   bool initializeModule(PythonModuleInitialization module);
   void addPath(const std::string& path); // add path in UTF-8 encoding
   void addNativePath(const std::string& path); // add path in system/Python encoding
+  void setupPath(const std::string& scriptDir);
+  void resetInterpreter(void* moduleDict); // actually a PyObject*
   void getAddonModuleDeps(const ADDON::AddonPtr& addon, std::set<std::string>& paths);
 
   std::string m_pythonPath;
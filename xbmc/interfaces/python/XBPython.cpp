@@ -500,6 +500,9 @@ void XBPython::Uninitialize()
 
   // cleanup threads that are still running
   tmpvec.clear(); // boost releases the XBPyThreads which, if deleted, calls OnScriptFinalized
+
+  if (m_bInitialized)
+    m_interpreterPool.Clear();
 }
 
 void XBPython::Process()
@@ -524,8 +527,11 @@ void XBPython::Process()
     //delete scripts which are done
     tmpvec.clear(); // boost releases the XBPyThreads which, if deleted, calls OnScriptFinalized
 
+    m_interpreterPool.Process();
+
     CSingleLock l2(m_critSection);
-    if(m_iDllScriptCounter == 0 && (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 )
+    if(m_iDllScriptCounter == 0 && m_interpreterPool.IsEmpty() &&
+       (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 )
     {
       Finalize();
     }
@@ -26,6 +26,7 @@
 #include "threads/Thread.h"
 #include "interfaces/IAnnouncer.h"
 #include "interfaces/generic/ILanguageInvocationHandler.h"
+#include "interfaces/python/PythonInterpreterPool.h"
 
 #include <memory>
 #include <vector>
@@ -107,6 +108,8 @@ public:
   void UnregisterExtensionLib(LibraryLoader *pLib);
   void UnloadExtensionLibs();
 
+  CPythonInterpreterPool& GetInterpreterPool() { return m_interpreterPool; }
+
 private:
   void Finalize();
 
@@ -128,6 +131,9 @@ private:
   // any global events that scripts should be using
   CEvent m_globalEvent;
 
+  // warm interpreters of plugins, python isn't unloaded while it holds any
+  CPythonInterpreterPool m_interpreterPool;
+
   // in order to finalize and unload the python library, need to save all the extension libraries that are
   // loaded by it and unload them first (not done by finalize)
   PythonExtensionLibraries m_extensions;
@@ -22,8 +22,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#include <sys/epoll.h>
+#define HAS_EPOLL
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
@@ -31,6 +36,7 @@
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "websocket/WebSocketManager.h"
 #include "Network.h"
 
@@ -58,6 +64,31 @@ using namespace ANNOUNCEMENT;
 
 #define RECEIVEBUFFER 1024
 
+// announcements are dropped for clients with more data than this waiting to be sent
+#define MAX_ANNOUNCEMENT_BACKLOG (512 * 1024)
+// clients which don't accept any of their queued data within this time are disconnected
+#define SEND_TIMEOUT 30000
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#ifdef TARGET_WINDOWS
+#define SOCKET_WOULDBLOCK (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+#define SOCKET_WOULDBLOCK (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+#endif
+
+static void SetNonBlocking(SOCKET socket)
+{
+#ifdef TARGET_WINDOWS
+  u_long nonblocking = 1;
+  ioctlsocket(socket, FIONBIO, &nonblocking);
+#else
+  fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+#endif
+}
+
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
 bool CTCPServer::StartServer(int port, bool nonlocal)
@@ -100,6 +131,36 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  m_epoll = -1;
+  m_wakeup[0] = m_wakeup[1] = -1;
+
+#ifdef HAS_EPOLL
+  m_epoll = epoll_create(16);
+  if (m_epoll < 0)
+    CLog::Log(LOGERROR, "JSONRPC Server: Unable to create epoll instance: %d", errno);
+#endif
+#ifdef TARGET_POSIX
+  if (pipe(m_wakeup) == 0)
+  {
+    SetNonBlocking(m_wakeup[0]);
+    SetNonBlocking(m_wakeup[1]);
+  }
+  else
+    m_wakeup[0] = m_wakeup[1] = -1;
+#endif
+}
+
+CTCPServer::~CTCPServer()
+{
+#ifdef TARGET_POSIX
+  if (m_wakeup[0] >= 0)
+  {
+    close(m_wakeup[0]);
+    close(m_wakeup[1]);
+  }
+  if (m_epoll >= 0)
+    close(m_epoll);
+#endif
 }
 
 void CTCPServer::Process()
@@ -108,105 +169,103 @@ void CTCPServer::Process()
 
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
-
-    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
-    {
-      FD_SET(*it, &rfds);
-      if ((intptr_t)*it > (intptr_t)max_fd)
-        max_fd = *it;
-    }
-
-    for (unsigned int i = 0; i < m_connections.size(); i++)
-    {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
-    }
-
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+    std::set<SOCKET> readable, writable;
+    int res = Poll(readable, writable, 1000);
     if (res < 0)
     {
       CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
       Sleep(1000);
       Initialize();
+      continue;
     }
-    else if (res > 0)
+
+    for (int i = m_connections.size() - 1; i >= 0; i--)
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
+      SOCKET socket = m_connections[i]->m_socket;
+      bool close = false;
+
+      if (writable.find(socket) != writable.end())
+        close = !m_connections[i]->Flush();
+
+      if (!close && readable.find(socket) != readable.end())
       {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
+        char buffer[RECEIVEBUFFER] = {};
+        int  nread = 0;
+        nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
+        if (nread > 0)
         {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
+          std::string response;
+          if (m_connections[i]->IsNew())
           {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (!response.empty())
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
+            CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
 
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
+            if (!response.empty())
+              m_connections[i]->Send(response.c_str(), response.size());
 
-            close = m_connections[i]->Closing();
+            if (websocket != NULL)
+            {
+              // Replace the CTCPClient with a CWebSocketClient
+              CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
+              CSingleLock lock(m_connectionsSection);
+              delete m_connections[i];
+              m_connections[i] = websocketClient;
+            }
           }
-          else
-            close = true;
 
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
+          if (response.size() <= 0)
+            m_connections[i]->PushBuffer(this, buffer, nread);
+
+          close = m_connections[i]->Closing();
         }
+        else
+          close = nread == 0 || !SOCKET_WOULDBLOCK;
       }
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+      if (!close && m_connections[i]->IsStalled())
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+        CLog::Log(LOGINFO, "JSONRPC Server: Client isn't accepting data, disconnecting");
+        close = true;
+      }
 
-          if (newconnection->m_socket == INVALID_SOCKET)
-          {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
-            {
-              Sleep(1000);
-              Initialize();
-              break;
-            }
-          }
-          else
+      if (close)
+      {
+        CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+        CSingleLock lock(m_connectionsSection);
+        m_connections[i]->Disconnect();
+        delete m_connections[i];
+        m_connections.erase(m_connections.begin() + i);
+      }
+    }
+
+    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+    {
+      if (readable.find(*it) != readable.end())
+      {
+        CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+        CTCPClient *newconnection = new CTCPClient();
+        newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+        if (newconnection->m_socket == INVALID_SOCKET)
+        {
+          CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
+          delete newconnection;
+          if (EBADF == errno)
           {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
+            Sleep(1000);
+            Initialize();
+            break;
           }
         }
+        else
+        {
+          CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+          SetNonBlocking(newconnection->m_socket);
+          // the socket may reuse the descriptor of a closed connection which
+          // was dropped from the poll set when it was closed
+          m_pollEvents.erase(newconnection->m_socket);
+          CSingleLock lock(m_connectionsSection);
+          m_connections.push_back(newconnection);
+        }
       }
     }
   }
@@ -214,6 +273,138 @@ void CTCPServer::Process()
   Deinitialize();
 }
 
+int CTCPServer::Poll(std::set<SOCKET> &readable, std::set<SOCKET> &writable, int timeout)
+{
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+  {
+    std::map<SOCKET, unsigned int> events;
+    for (std::vector<SOCKET>::const_iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+      events[*it] = EPOLLIN;
+    if (m_wakeup[0] >= 0)
+      events[m_wakeup[0]] = EPOLLIN;
+    for (std::vector<CTCPClient*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+      events[(*it)->m_socket] = EPOLLIN | ((*it)->GetPendingSize() > 0 ? EPOLLOUT : 0);
+
+    // only sockets whose interest changed need to be updated
+    for (std::map<SOCKET, unsigned int>::iterator it = m_pollEvents.begin(); it != m_pollEvents.end(); )
+    {
+      if (events.find(it->first) == events.end())
+      {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, it->first, NULL);
+        m_pollEvents.erase(it++);
+      }
+      else
+        ++it;
+    }
+    for (std::map<SOCKET, unsigned int>::const_iterator it = events.begin(); it != events.end(); ++it)
+    {
+      std::map<SOCKET, unsigned int>::iterator registered = m_pollEvents.find(it->first);
+      if (registered != m_pollEvents.end() && registered->second == it->second)
+        continue;
+
+      struct epoll_event event = {};
+      event.events = it->second;
+      event.data.fd = it->first;
+      if (epoll_ctl(m_epoll, registered == m_pollEvents.end() ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, it->first, &event) < 0)
+        CLog::Log(LOGERROR, "JSONRPC Server: Unable to watch socket %d: %d", (int)it->first, errno);
+      else
+        m_pollEvents[it->first] = it->second;
+    }
+
+    struct epoll_event ready[64];
+    int res = epoll_wait(m_epoll, ready, 64, timeout);
+    if (res < 0)
+      return errno == EINTR ? 0 : -1;
+
+    for (int i = 0; i < res; i++)
+    {
+      if (ready[i].data.fd == m_wakeup[0])
+      {
+        char buffer[64];
+        while (read(m_wakeup[0], buffer, sizeof(buffer)) > 0) ;
+        continue;
+      }
+      // errors and hangups are picked up by the following recv() or send()
+      if (ready[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        readable.insert(ready[i].data.fd);
+      if (ready[i].events & EPOLLOUT)
+        writable.insert(ready[i].data.fd);
+    }
+    return res;
+  }
+#endif
+
+  SOCKET          max_fd = 0;
+  fd_set          rfds, wfds;
+  struct timeval  to     = {timeout / 1000, (timeout % 1000) * 1000};
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+  {
+    FD_SET(*it, &rfds);
+    if ((intptr_t)*it > (intptr_t)max_fd)
+      max_fd = *it;
+  }
+
+  if (m_wakeup[0] >= 0)
+  {
+    FD_SET(m_wakeup[0], &rfds);
+    if ((intptr_t)m_wakeup[0] > (intptr_t)max_fd)
+      max_fd = m_wakeup[0];
+  }
+
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+  {
+    FD_SET(m_connections[i]->m_socket, &rfds);
+    if (m_connections[i]->GetPendingSize() > 0)
+      FD_SET(m_connections[i]->m_socket, &wfds);
+    if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
+      max_fd = m_connections[i]->m_socket;
+  }
+
+  int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
+  if (res <= 0)
+    return res;
+
+#ifdef TARGET_POSIX
+  if (m_wakeup[0] >= 0 && FD_ISSET(m_wakeup[0], &rfds))
+  {
+    char buffer[64];
+    while (read(m_wakeup[0], buffer, sizeof(buffer)) > 0) ;
+  }
+#endif
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+  {
+    if (FD_ISSET(*it, &rfds))
+      readable.insert(*it);
+  }
+
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+  {
+    if (FD_ISSET(m_connections[i]->m_socket, &rfds))
+      readable.insert(m_connections[i]->m_socket);
+    if (FD_ISSET(m_connections[i]->m_socket, &wfds))
+      writable.insert(m_connections[i]->m_socket);
+  }
+
+  return res;
+}
+
+void CTCPServer::Wake()
+{
+#ifdef TARGET_POSIX
+  if (m_wakeup[1] >= 0)
+  {
+    char c = 0;
+    if (write(m_wakeup[1], &c, 1) < 0 && errno != EAGAIN)
+      CLog::Log(LOGERROR, "JSONRPC Server: Unable to wake up server thread: %d", errno);
+  }
+#endif
+}
+
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
 {
   return false;
@@ -233,16 +424,42 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
+  // sending only queues the announcement, a slow client must not hold up the announcing thread
+  bool pending = false;
+  CSingleLock connectionsLock(m_connectionsSection);
   for (unsigned int i = 0; i < m_connections.size(); i++)
   {
+    CSingleLock lock (m_connections[i]->m_critSection);
+    if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
+      continue;
+
+    // a client which isn't keeping up misses out on announcements
+    if (m_connections[i]->GetPendingSize() > MAX_ANNOUNCEMENT_BACKLOG)
     {
-      CSingleLock lock (m_connections[i]->m_critSection);
-      if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
-        continue;
+      CLog::Log(LOGDEBUG, "JSONRPC Server: Dropping %s announcement for a slow client", message);
+      continue;
     }
 
     m_connections[i]->Send(str.c_str(), str.size());
+    pending |= m_connections[i]->GetPendingSize() > 0;
+  }
+
+  // make sure the server thread watches for the client becoming writable
+  if (pending)
+    Wake();
+}
+
+int CTCPServer::GetAnnouncementFlags()
+{
+  int flags = 0;
+  CSingleLock connectionsLock(m_connectionsSection);
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+  {
+    CSingleLock lock (m_connections[i]->m_critSection);
+    flags |= m_connections[i]->GetAnnouncementFlags();
   }
+
+  return flags;
 }
 
 bool CTCPServer::Initialize()
@@ -459,19 +676,25 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock(m_connectionsSection);
+    for (unsigned int i = 0; i < m_connections.size(); i++)
+    {
+      m_connections[i]->Disconnect();
+      delete m_connections[i];
+    }
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
 
   m_servers.clear();
 
+  // closing the sockets removed them from the epoll instance
+  m_pollEvents.clear();
+
 #ifdef HAVE_LIBBLUETOOTH
   if (m_sdpd)
     sdp_close((sdp_session_t*)m_sdpd);
@@ -490,6 +713,9 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_sendOffset = 0;
+  m_lastSend = 0;
+  m_sendFailed = false;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -523,12 +749,60 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_sendOffset == m_sendBuffer.size())
+    m_lastSend = XbmcThreads::SystemClockMillis();
+  m_sendBuffer.append(data, size);
+  Flush();
+}
+
+bool CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  size_t sent = 0;
+  while (!m_sendFailed && m_sendOffset < m_sendBuffer.size())
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    int res = send(m_socket, m_sendBuffer.c_str() + m_sendOffset, m_sendBuffer.size() - m_sendOffset, MSG_NOSIGNAL);
+    if (res > 0)
+    {
+      m_sendOffset += res;
+      sent += res;
+    }
+    else if (res < 0 && SOCKET_WOULDBLOCK)
+      break;
+    else
+      m_sendFailed = true;
+  }
+
+  if (m_sendOffset == m_sendBuffer.size())
+  {
+    m_sendBuffer.clear();
+    m_sendOffset = 0;
+  }
+  else if (m_sendOffset > m_sendBuffer.size() / 2)
+  {
+    // only drop the sent data once it makes up most of the buffer, so the
+    // pending data isn't moved on every partial send
+    m_sendBuffer.erase(0, m_sendOffset);
+    m_sendOffset = 0;
+  }
+
+  if (sent > 0)
+    m_lastSend = XbmcThreads::SystemClockMillis();
+  return !m_sendFailed;
+}
+
+size_t CTCPServer::CTCPClient::GetPendingSize()
+{
+  CSingleLock lock (m_critSection);
+  return m_sendBuffer.size() - m_sendOffset;
+}
+
+bool CTCPServer::CTCPClient::IsStalled()
+{
+  CSingleLock lock (m_critSection);
+  return m_sendFailed ||
+         (m_sendOffset < m_sendBuffer.size() && XbmcThreads::SystemClockMillis() - m_lastSend > SEND_TIMEOUT);
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -573,6 +847,8 @@ void CTCPServer::CTCPClient::Disconnect()
   if (m_socket > 0)
   {
     CSingleLock lock (m_critSection);
+    // last chance for whatever is still queued
+    Flush();
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
@@ -591,6 +867,10 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_sendBuffer        = client.m_sendBuffer;
+  m_sendOffset        = client.m_sendOffset;
+  m_lastSend          = client.m_lastSend;
+  m_sendFailed        = client.m_sendFailed;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
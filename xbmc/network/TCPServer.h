@@ -19,6 +19,8 @@
  *
  */
 
+#include <map>
+#include <set>
 #include <vector>
 #include <sys/socket.h>
 
@@ -46,15 +48,31 @@ namespace JSONRPC
     virtual int GetCapabilities();
 
     virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+    virtual int GetAnnouncementFlags();
   protected:
     void Process();
   private:
     CTCPServer(int port, bool nonlocal);
+    virtual ~CTCPServer();
     bool Initialize();
     bool InitializeBlue();
     bool InitializeTCP();
     void Deinitialize();
 
+    /*!
+     \brief Wait until a socket is readable or a client with queued data is writable.
+     \param readable [out] the sockets which can be read from
+     \param writable [out] the sockets which can be written to
+     \param timeout maximum time to wait (in ms)
+     \return the number of ready sockets, -1 on error
+     */
+    int Poll(std::set<SOCKET> &readable, std::set<SOCKET> &writable, int timeout);
+
+    /*!
+     \brief Interrupt a running Poll() so it picks up data queued by other threads.
+     */
+    void Wake();
+
     class CTCPClient : public IClient
     {
     public:
@@ -69,6 +87,9 @@ namespace JSONRPC
       virtual int  GetAnnouncementFlags();
       virtual bool SetAnnouncementFlags(int flags);
 
+      /*!
+       \brief Queue data for the client and send as much of it as possible without blocking.
+       */
       virtual void Send(const char *data, unsigned int size);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
@@ -76,6 +97,18 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*!
+       \brief Send queued data without blocking.
+       \return false if the connection failed, true otherwise.
+       */
+      bool Flush();
+      size_t GetPendingSize();
+
+      /*!
+       \brief Whether the connection failed or the client stopped reading the data queued for it.
+       */
+      bool IsStalled();
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
@@ -89,6 +122,10 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_sendBuffer;
+      size_t m_sendOffset;            ///< start of the data in m_sendBuffer that is not sent yet
+      unsigned int m_lastSend;
+      bool m_sendFailed;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -112,11 +149,16 @@ namespace JSONRPC
     };
 
     std::vector<CTCPClient*> m_connections;
+    CCriticalSection m_connectionsSection; ///< protects m_connections against announcing threads
     std::vector<SOCKET> m_servers;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
 
+    int m_epoll;
+    std::map<SOCKET, unsigned int> m_pollEvents; ///< events each socket is registered for
+    int m_wakeup[2];                             ///< pipe used to interrupt Poll()
+
     static CTCPServer *ServerInstance;
   };
 }
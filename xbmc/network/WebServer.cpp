@@ -30,7 +30,13 @@
 #include <stdexcept>
 #include <utility>
 
+#ifdef TARGET_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif // TARGET_POSIX
+
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
@@ -56,6 +62,15 @@
 
 #define MAX_POST_BUFFER_SIZE 2048
 
+// size of the blocks read from files which can't be sent by the kernel
+#define FILE_DOWNLOAD_BLOCK_SIZE  (64 * 1024)
+// remote files of at least this size are read ahead in the background
+#define FILE_READ_AHEAD_MINIMUM   (16 * 1024 * 1024)
+
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00094500)
+#define HAS_FD_RESPONSES
+#endif
+
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
 
@@ -291,6 +306,22 @@ int CWebServer::AnswerToConnection(void *cls, struct MHD_Connection *connection,
                 cacheable = false;
             }
 
+            // handle If-None-Match (but only if the response is cacheable), it takes precedence over If-Modified-Since
+            std::string ifNoneMatch = GetRequestHeaderValue(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_NONE_MATCH);
+            std::string entityTag;
+            if (cacheable && !ifNoneMatch.empty() &&
+                handler->GetEntityTag(entityTag) && MatchesEntityTag(ifNoneMatch, entityTag))
+            {
+              struct MHD_Response *response = MHD_create_response_from_data(0, nullptr, MHD_NO, MHD_NO);
+              if (response == nullptr)
+              {
+                CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP 304 response");
+                return MHD_NO;
+              }
+
+              return FinalizeRequest(handler, MHD_HTTP_NOT_MODIFIED, response);
+            }
+
             CDateTime lastModified;
             if (handler->GetLastModifiedDate(lastModified) && lastModified.IsValid())
             {
@@ -300,8 +331,8 @@ int CWebServer::AnswerToConnection(void *cls, struct MHD_Connection *connection,
 
               CDateTime ifModifiedSinceDate;
               CDateTime ifUnmodifiedSinceDate;
-              // handle If-Modified-Since (but only if the response is cacheable)
-              if (cacheable &&
+              // handle If-Modified-Since (but only if the response is cacheable and If-None-Match isn't present)
+              if (cacheable && ifNoneMatch.empty() &&
                 ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince) &&
                 lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate)
               {
@@ -544,6 +575,11 @@ int CWebServer::FinalizeRequest(const std::shared_ptr<IHTTPRequestHandler>& hand
   if (handler->GetLastModifiedDate(lastModified) && lastModified.IsValid())
     handler->AddResponseHeader(MHD_HTTP_HEADER_LAST_MODIFIED, lastModified.GetAsRFC1123DateTime());
 
+  // if the request handler has an entity tag for the response data, add it
+  std::string entityTag;
+  if (handler->CanBeCached() && handler->GetEntityTag(entityTag) && !entityTag.empty())
+    handler->AddResponseHeader(MHD_HTTP_HEADER_ETAG, entityTag);
+
   // check if the request handler has set Cache-Control and add it if not
   if (!handler->HasResponseHeader(MHD_HTTP_HEADER_CACHE_CONTROL))
   {
@@ -780,6 +816,19 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
   bool ranged = false;
   uint64_t fileLength = static_cast<uint64_t>(file->GetLength());
 
+  // stream large remote files through the file cache so the next blocks are
+  // already being fetched while the current one is sent
+  if (request.method != HEAD && fileLength >= FILE_READ_AHEAD_MINIMUM && URIUtils::IsRemote(filePath))
+  {
+    std::shared_ptr<XFILE::CFile> cachedFile = std::make_shared<XFILE::CFile>();
+    if (cachedFile->Open(filePath, READ_CACHED))
+    {
+      file->Close();
+      file = cachedFile;
+      fileLength = static_cast<uint64_t>(file->GetLength());
+    }
+  }
+
   // get the MIME type for the Content-Type header
   std::string mimeType = responseDetails.contentType;
   if (mimeType.empty())
@@ -857,17 +906,39 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
     context->ranges.GetFirstPosition(context->writePosition);
 
     // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
-    if (response == nullptr)
+    response = nullptr;
+#ifdef HAS_FD_RESPONSES
+    // local files are sent by the kernel (sendfile) unless multipart boundaries have to be added
+    if (context->rangeCountTotal == 1)
     {
-      CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
+      int fd = OpenLocalFile(filePath);
+      if (fd >= 0)
+      {
+        response = MHD_create_response_from_fd_at_offset64(totalLength, fd, context->writePosition);
+        if (response == nullptr)
+          close(fd);
+      }
     }
+#endif // HAS_FD_RESPONSES
 
-    context.release(); // ownership was passed to mhd
+    if (response == nullptr)
+    {
+      // read large blocks (at least the file's preferred chunk size) but not more than will be sent
+      uint64_t blockSize = std::max(static_cast<uint64_t>(std::max(file->GetChunkSize(), 0)), static_cast<uint64_t>(FILE_DOWNLOAD_BLOCK_SIZE));
+      blockSize = std::min(blockSize, std::max(totalLength, static_cast<uint64_t>(1)));
+
+      response = MHD_create_response_from_callback(totalLength, static_cast<size_t>(blockSize),
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == nullptr)
+      {
+        CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
+
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -1076,6 +1147,44 @@ void CWebServer::ContentReaderFreeCallback(void *cls)
 #endif
 }
 
+bool CWebServer::MatchesEntityTag(const std::string &ifNoneMatch, const std::string &entityTag)
+{
+  std::vector<std::string> entityTags = StringUtils::Split(ifNoneMatch, ",");
+  for (std::vector<std::string>::iterator it = entityTags.begin(); it != entityTags.end(); ++it)
+  {
+    std::string tag = StringUtils::Trim(*it);
+    if (tag == "*")
+      return true;
+
+    // If-None-Match uses the weak comparison
+    if (StringUtils::StartsWith(tag, "W/"))
+      tag.erase(0, 2);
+    std::string ownTag = entityTag;
+    if (StringUtils::StartsWith(ownTag, "W/"))
+      ownTag.erase(0, 2);
+
+    if (tag == ownTag)
+      return true;
+  }
+
+  return false;
+}
+
+int CWebServer::OpenLocalFile(const std::string &filePath)
+{
+#ifdef TARGET_POSIX
+  std::string localPath = CSpecialProtocol::TranslatePath(URIUtils::SubstitutePath(filePath));
+
+  // only plain local paths can be handed to the kernel, everything else has to go through the VFS
+  if (localPath.empty() || !CURL(localPath).GetProtocol().empty())
+    return -1;
+
+  return open(localPath.c_str(), O_RDONLY | O_CLOEXEC);
+#else
+  return -1;
+#endif // TARGET_POSIX
+}
+
 // local helper
 static void panicHandlerForMHD(void* unused, const char* file, unsigned int line, const char *reason)
 {
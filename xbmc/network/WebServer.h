@@ -104,6 +104,15 @@ private:
 
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
   static int CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHandler>& handler, struct MHD_Response *&response);
+  /*!
+   \brief Open a file for sending it straight from the kernel.
+   \return a file descriptor or -1 if the file isn't a plain local file
+   */
+  static int OpenLocalFile(const std::string &filePath);
+  /*!
+   \brief Whether the value of an If-None-Match header matches the given entity tag.
+   */
+  static bool MatchesEntityTag(const std::string &ifNoneMatch, const std::string &entityTag);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, const void *data, size_t size, bool free, bool copy, struct MHD_Response *&response);
 
@@ -21,6 +21,7 @@
 #include <map>
 
 #include "HTTPImageTransformationHandler.h"
+#include "ImageTransformationCache.h"
 #include "TextureCacheJob.h"
 #include "URL.h"
 #include "filesystem/ImageFile.h"
@@ -37,16 +38,20 @@ static const std::string ImageBasePath = "/image/";
 
 CHTTPImageTransformationHandler::CHTTPImageTransformationHandler()
   : m_url(),
+    m_imagePath(),
     m_lastModified(),
-    m_buffer(NULL),
+    m_cacheKey(),
+    m_buffer(),
     m_responseData()
 { }
 
 CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPRequest &request)
   : IHTTPRequestHandler(request),
     m_url(),
+    m_imagePath(),
     m_lastModified(),
-    m_buffer(NULL),
+    m_cacheKey(),
+    m_buffer(),
     m_responseData()
 {
   m_url = m_request.pathUrl.substr(ImageBasePath.size());
@@ -74,6 +79,31 @@ CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPReque
   StringUtils::ToLower(ext);
   m_response.contentType = CMime::GetMimeType(ext);
 
+  // get the transformation options
+  std::map<std::string, std::string> options;
+  CWebServer::GetRequestHeaderValues(m_request.connection, MHD_GET_ARGUMENT_KIND, options);
+
+  std::vector<std::string> urlOptions;
+  std::map<std::string, std::string>::const_iterator option = options.find(TRANSFORMATION_OPTION_WIDTH);
+  if (option != options.end())
+    urlOptions.push_back(TRANSFORMATION_OPTION_WIDTH "=" + option->second);
+
+  option = options.find(TRANSFORMATION_OPTION_HEIGHT);
+  if (option != options.end())
+    urlOptions.push_back(TRANSFORMATION_OPTION_HEIGHT "=" + option->second);
+
+  option = options.find(TRANSFORMATION_OPTION_SCALING_ALGORITHM);
+  if (option != options.end())
+    urlOptions.push_back(TRANSFORMATION_OPTION_SCALING_ALGORITHM "=" + option->second);
+
+  std::string transformation = StringUtils::Join(urlOptions, "&");
+  m_imagePath = m_url;
+  if (!transformation.empty())
+  {
+    m_imagePath += "?";
+    m_imagePath += transformation;
+  }
+
   // TODO: determine the maximum age
 
   // determine the last modified date
@@ -81,6 +111,10 @@ CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPReque
   if (imageFile.Stat(pathToUrl, &statBuffer) != 0)
     return;
 
+  // the transformed image is only cached (and can be identified by an entity tag)
+  // if we know which version of the source image it was created from
+  m_cacheKey = CImageTransformationCache::GetKey(m_url, statBuffer.st_mtime, statBuffer.st_size, transformation);
+
   struct tm *time;
 #ifdef HAVE_LOCALTIME_R
   struct tm result = {};
@@ -97,8 +131,6 @@ CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPReque
 CHTTPImageTransformationHandler::~CHTTPImageTransformationHandler()
 {
   m_responseData.clear();
-  delete m_buffer;
-  m_buffer = NULL;
 }
 
 bool CHTTPImageTransformationHandler::CanHandleRequest(const HTTPRequest &request)
@@ -129,33 +161,21 @@ int CHTTPImageTransformationHandler::HandleRequest()
     return MHD_YES;
   }
 
-  // get the transformation options
-  std::map<std::string, std::string> options;
-  CWebServer::GetRequestHeaderValues(m_request.connection, MHD_GET_ARGUMENT_KIND, options);
-
-  std::vector<std::string> urlOptions;
-  std::map<std::string, std::string>::const_iterator option = options.find(TRANSFORMATION_OPTION_WIDTH);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_WIDTH "=" + option->second);
-
-  option = options.find(TRANSFORMATION_OPTION_HEIGHT);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_HEIGHT "=" + option->second);
-
-  option = options.find(TRANSFORMATION_OPTION_SCALING_ALGORITHM);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_SCALING_ALGORITHM "=" + option->second);
-
-  std::string imagePath = m_url;
-  if (!urlOptions.empty())
+  // resize the image into the local buffer (or get it from the cache)
+  bool success = false;
+  if (!m_cacheKey.empty())
+    success = CImageTransformationCache::GetInstance().Get(m_cacheKey, m_imagePath, m_buffer);
+  else
   {
-    imagePath += "?";
-    imagePath += StringUtils::Join(urlOptions, "&");
+    uint8_t *buffer = NULL;
+    size_t bufferSize = 0;
+    success = CTextureCacheJob::ResizeTexture(m_imagePath, buffer, bufferSize);
+    if (success)
+      m_buffer.assign(reinterpret_cast<const char*>(buffer), bufferSize);
+    delete[] buffer;
   }
 
-  // resize the image into the local buffer
-  size_t bufferSize;
-  if (!CTextureCacheJob::ResizeTexture(imagePath, m_buffer, bufferSize))
+  if (!success)
   {
     m_response.status = MHD_HTTP_INTERNAL_SERVER_ERROR;
     m_response.type = HTTPError;
@@ -164,17 +184,17 @@ int CHTTPImageTransformationHandler::HandleRequest()
   }
 
   // store the size of the image
-  m_response.totalLength = bufferSize;
+  m_response.totalLength = m_buffer.size();
 
   // nothing else to do if the request is not ranged
   if (!GetRequestedRanges(m_response.totalLength))
   {
-    m_responseData.push_back(CHttpResponseRange(m_buffer, 0, m_response.totalLength - 1));
+    m_responseData.push_back(CHttpResponseRange(m_buffer.c_str(), 0, m_response.totalLength - 1));
     return MHD_YES;
   }
 
   for (HttpRanges::const_iterator range = m_request.ranges.Begin(); range != m_request.ranges.End(); ++range)
-    m_responseData.push_back(CHttpResponseRange(m_buffer + range->GetFirstPosition(), range->GetFirstPosition(), range->GetLastPosition()));
+    m_responseData.push_back(CHttpResponseRange(m_buffer.c_str() + range->GetFirstPosition(), range->GetFirstPosition(), range->GetLastPosition()));
 
   return MHD_YES;
 }
@@ -187,3 +207,12 @@ bool CHTTPImageTransformationHandler::GetLastModifiedDate(CDateTime &lastModifie
   lastModified = m_lastModified;
   return true;
 }
+
+bool CHTTPImageTransformationHandler::GetEntityTag(std::string &entityTag) const
+{
+  if (m_cacheKey.empty())
+    return false;
+
+  entityTag = "\"" + m_cacheKey + "\"";
+  return true;
+}
@@ -39,6 +39,7 @@ public:
   virtual bool CanHandleRanges() const { return true; }
   virtual bool CanBeCached() const { return true; }
   virtual bool GetLastModifiedDate(CDateTime &lastModified) const;
+  virtual bool GetEntityTag(std::string &entityTag) const;
 
   virtual HttpResponseRanges GetResponseData() const { return m_responseData; }
 
@@ -50,8 +51,10 @@ protected:
 
 private:
   std::string m_url;
+  std::string m_imagePath;
   CDateTime m_lastModified;
+  std::string m_cacheKey;
 
-  uint8_t* m_buffer;
+  std::string m_buffer;
   HttpResponseRanges m_responseData;
 };
@@ -147,6 +147,13 @@ public:
   * \details This is only used if the response can be cached.
   */
   virtual bool GetLastModifiedDate(CDateTime &lastModified) const { return false; }
+
+  /*!
+  * \brief Returns the (quoted) entity tag identifying the version of the response data.
+  *
+  * \details This is only used if the response can be cached.
+  */
+  virtual bool GetEntityTag(std::string &entityTag) const { return false; }
  
   /*!
    * \brief Returns the ranges with raw data belonging to the response.
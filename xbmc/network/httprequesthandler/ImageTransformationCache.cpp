@@ -0,0 +1,213 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ImageTransformationCache.h"
+
+#include <inttypes.h>
+
+#include "FileItem.h"
+#include "TextureCacheJob.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#define IMAGE_TRANSFORMATION_CACHE_DIRECTORY  "special://temp/imagetransformations/"
+#define IMAGE_TRANSFORMATION_CACHE_SIZE       (64 * 1024 * 1024)
+
+CImageTransformationCache::CImageTransformationCache(const std::string &directory, uint64_t maxSize)
+  : m_directory(directory),
+    m_maxSize(maxSize),
+    m_initialized(false),
+    m_size(0)
+{ }
+
+CImageTransformationCache &CImageTransformationCache::GetInstance()
+{
+  static CImageTransformationCache s_cache(IMAGE_TRANSFORMATION_CACHE_DIRECTORY, IMAGE_TRANSFORMATION_CACHE_SIZE);
+  return s_cache;
+}
+
+std::string CImageTransformationCache::GetKey(const std::string &image, int64_t modified, int64_t size, const std::string &transformation)
+{
+  return XBMC::XBMC_MD5::GetMD5(StringUtils::Format("%s|%" PRId64 "|%" PRId64 "|%s", image.c_str(), modified, size, transformation.c_str()));
+}
+
+bool CImageTransformationCache::Get(const std::string &key, const std::string &imagePath, std::string &data)
+{
+  std::shared_ptr<PendingTransformation> pending;
+  {
+    CSingleLock lock(m_section);
+    Initialize();
+
+    std::map<std::string, CacheEntry>::iterator entry = m_entries.find(key);
+    if (entry != m_entries.end())
+    {
+      m_lru.splice(m_lru.begin(), m_lru, entry->second.lru);
+
+      CSingleExit exit(m_section);
+      if (Load(key, data))
+        return true;
+    }
+
+    // someone else is already transforming the image, wait for the result
+    std::map<std::string, std::shared_ptr<PendingTransformation> >::iterator it = m_pending.find(key);
+    if (it != m_pending.end())
+    {
+      pending = it->second;
+      CSingleExit exit(m_section);
+      pending->done.Wait();
+      if (!pending->success)
+        return false;
+
+      data = pending->data;
+      return true;
+    }
+
+    // the cached image may have been deleted from disk
+    Remove(key);
+
+    pending.reset(new PendingTransformation());
+    m_pending.insert(std::make_pair(key, pending));
+  }
+
+  uint8_t *buffer = NULL;
+  size_t bufferSize = 0;
+  if (CTextureCacheJob::ResizeTexture(imagePath, buffer, bufferSize) && buffer != NULL)
+  {
+    pending->data.assign(reinterpret_cast<const char*>(buffer), bufferSize);
+    pending->success = true;
+  }
+  delete[] buffer;
+
+  bool stored = pending->success && Store(key, pending->data);
+
+  CSingleLock lock(m_section);
+  if (stored)
+    Add(key, pending->data.size());
+  m_pending.erase(key);
+  pending->done.Set();
+
+  if (!pending->success)
+    return false;
+
+  data = pending->data;
+  return true;
+}
+
+void CImageTransformationCache::Initialize()
+{
+  if (m_initialized)
+    return;
+
+  m_initialized = true;
+  if (!XFILE::CDirectory::Exists(m_directory))
+  {
+    XFILE::CDirectory::Create(m_directory);
+    return;
+  }
+
+  // pick up the images cached in an earlier session, the most recently written ones are kept the longest
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(m_directory, items, "", XFILE::DIR_FLAG_NO_FILE_DIRS | XFILE::DIR_FLAG_BYPASS_CACHE))
+    return;
+
+  items.Sort(SortByDate, SortOrderAscending);
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CFileItemPtr item = items.Get(i);
+    if (item->m_bIsFolder || !URIUtils::GetExtension(item->GetPath()).empty())
+      continue;
+
+    Add(URIUtils::GetFileName(item->GetPath()), item->m_dwSize);
+  }
+
+  CLog::Log(LOGDEBUG, "CImageTransformationCache: found %u transformed images (%" PRIu64 " bytes)", static_cast<unsigned int>(m_entries.size()), m_size);
+}
+
+bool CImageTransformationCache::Load(const std::string &key, std::string &data) const
+{
+  XFILE::CFile file;
+  XFILE::auto_buffer buffer;
+  if (file.LoadFile(GetCachePath(key), buffer) <= 0)
+    return false;
+
+  data.assign(buffer.get(), buffer.size());
+  return true;
+}
+
+bool CImageTransformationCache::Store(const std::string &key, const std::string &data) const
+{
+  // write to a temporary file first so a partially written image is never served
+  const std::string path = GetCachePath(key);
+  const std::string tempPath = path + ".tmp";
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(tempPath, true))
+    return false;
+
+  bool success = file.Write(data.c_str(), data.size()) == static_cast<ssize_t>(data.size());
+  file.Close();
+
+  if (!success || !XFILE::CFile::Rename(tempPath, path))
+  {
+    XFILE::CFile::Delete(tempPath);
+    return false;
+  }
+
+  return true;
+}
+
+void CImageTransformationCache::Add(const std::string &key, uint64_t size)
+{
+  Remove(key);
+
+  m_lru.push_front(key);
+  CacheEntry entry = { size, m_lru.begin() };
+  m_entries.insert(std::make_pair(key, entry));
+  m_size += size;
+
+  // evict the least recently used images
+  while (m_size > m_maxSize && m_lru.size() > 1)
+  {
+    std::string evicted = m_lru.back();
+    Remove(evicted);
+    XFILE::CFile::Delete(GetCachePath(evicted));
+  }
+}
+
+void CImageTransformationCache::Remove(const std::string &key)
+{
+  std::map<std::string, CacheEntry>::iterator entry = m_entries.find(key);
+  if (entry == m_entries.end())
+    return;
+
+  m_size -= entry->second.size;
+  m_lru.erase(entry->second.lru);
+  m_entries.erase(entry);
+}
+
+std::string CImageTransformationCache::GetCachePath(const std::string &key) const
+{
+  return URIUtils::AddFileToFolder(m_directory, key);
+}
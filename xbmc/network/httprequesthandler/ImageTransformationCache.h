@@ -0,0 +1,99 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+/*!
+ \brief Disk cache for images resized for the web server.
+
+ Transformed images are stored by a key identifying the source image (including
+ its version) and the transformation. The cache is limited in size and evicts the
+ least recently used images first. Concurrent requests for the same transformation
+ only transform the image once.
+ */
+class CImageTransformationCache
+{
+public:
+  static CImageTransformationCache &GetInstance();
+
+  /*!
+   \brief Create the key of a transformed image.
+   \param image the image:// URL of the source image
+   \param modified the last modification time of the source image
+   \param size the size of the source image
+   \param transformation the options describing the transformation
+   \return the key (a hex string) to be passed to Get()
+   */
+  static std::string GetKey(const std::string &image, int64_t modified, int64_t size, const std::string &transformation);
+
+  /*!
+   \brief Retrieve a transformed image, transforming it if it isn't cached yet.
+   \param key the key of the transformed image
+   \param imagePath the image:// URL including the transformation options
+   \param data [out] the transformed image
+   \return true if the transformed image was retrieved, false otherwise.
+   */
+  bool Get(const std::string &key, const std::string &imagePath, std::string &data);
+
+private:
+  CImageTransformationCache(const std::string &directory, uint64_t maxSize);
+  CImageTransformationCache(const CImageTransformationCache&);
+  CImageTransformationCache const& operator=(CImageTransformationCache const&);
+
+  struct CacheEntry
+  {
+    uint64_t size;
+    std::list<std::string>::iterator lru;
+  };
+
+  struct PendingTransformation
+  {
+    PendingTransformation() : done(true), success(false) { }
+
+    CEvent done;
+    bool success;
+    std::string data;
+  };
+
+  void Initialize();
+  bool Load(const std::string &key, std::string &data) const;
+  bool Store(const std::string &key, const std::string &data) const;
+  void Add(const std::string &key, uint64_t size);
+  void Remove(const std::string &key);
+  std::string GetCachePath(const std::string &key) const;
+
+  std::string m_directory;
+  uint64_t m_maxSize;
+
+  CCriticalSection m_section;
+  bool m_initialized;
+  uint64_t m_size;
+  std::map<std::string, CacheEntry> m_entries;
+  std::list<std::string> m_lru;         ///< keys of the cached images, most recently used first
+  std::map<std::string, std::shared_ptr<PendingTransformation> > m_pending;
+};
@@ -73,7 +73,7 @@ void CPlayList::AnnounceClear()
   ANNOUNCEMENT::CAnnouncementManager::GetInstance().Announce(ANNOUNCEMENT::Playlist, "xbmc", "OnClear", data);
 }
 
-void CPlayList::AnnounceAdd(const CFileItemPtr& item, int pos)
+void CPlayList::AnnounceAdd(const CFileItemPtr& item, int pos, int count /* = 1 */)
 {
   if (m_id < 0)
     return;
@@ -81,6 +81,9 @@ void CPlayList::AnnounceAdd(const CFileItemPtr& item, int pos)
   CVariant data;
   data["playlistid"] = m_id;
   data["position"] = pos;
+  // items added in one go are announced once, with the first of them
+  if (count > 1)
+    data["count"] = count;
   ANNOUNCEMENT::CAnnouncementManager::GetInstance().Announce(ANNOUNCEMENT::Playlist, "xbmc", "OnAdd", item, data);
 }
 
@@ -94,19 +97,7 @@ void CPlayList::Add(const CFileItemPtr &item, int iPosition, int iOrder)
   else
     item->m_iprogramCount = iOrder;
 
-  // videodb files are not supported by the filesystem as yet
-  if (item->IsVideoDb())
-    item->SetPath(item->GetVideoInfoTag()->m_strFileNameAndPath);
-
-  // increment the playable counter
-  item->ClearProperty("unplayable");
-  if (m_iPlayableItems < 0)
-    m_iPlayableItems = 1;
-  else
-    m_iPlayableItems++;
-
-  // set 'IsPlayable' property - needed for properly handling plugin:// URLs
-  item->SetProperty("IsPlayable", true);
+  PrepareItem(item);
 
   //CLog::Log(LOGDEBUG,"%s item:(%02i/%02i)[%s]", __FUNCTION__, iPosition, item->m_iprogramCount, item->GetPath().c_str());
   if (iPosition == iOldSize)
@@ -122,6 +113,53 @@ void CPlayList::Add(const CFileItemPtr &item, int iPosition, int iOrder)
   AnnounceAdd(item, iPosition);
 }
 
+void CPlayList::AddItems(const std::vector<CFileItemPtr>& items, int iPosition)
+{
+  if (items.empty())
+    return;
+
+  int iOldSize = size();
+  int iCount = (int)items.size();
+  if (iPosition < 0 || iPosition >= iOldSize)
+    iPosition = iOldSize;
+
+  // make room for the orders of the new items in a single pass over the list
+  if (iPosition < iOldSize)
+  {
+    for (ivecItems it = m_vecItems.begin(); it != m_vecItems.end(); ++it)
+    {
+      if ((*it)->m_iprogramCount >= iPosition)
+        (*it)->m_iprogramCount += iCount;
+    }
+  }
+
+  for (int i = 0; i < iCount; i++)
+  {
+    items[i]->m_iprogramCount = iPosition + i;
+    PrepareItem(items[i]);
+  }
+
+  m_vecItems.insert(m_vecItems.begin() + iPosition, items.begin(), items.end());
+  AnnounceAdd(items.front(), iPosition, iCount);
+}
+
+void CPlayList::PrepareItem(const CFileItemPtr& item)
+{
+  // videodb files are not supported by the filesystem as yet
+  if (item->IsVideoDb())
+    item->SetPath(item->GetVideoInfoTag()->m_strFileNameAndPath);
+
+  // increment the playable counter
+  item->ClearProperty("unplayable");
+  if (m_iPlayableItems < 0)
+    m_iPlayableItems = 1;
+  else
+    m_iPlayableItems++;
+
+  // set 'IsPlayable' property - needed for properly handling plugin:// URLs
+  item->SetProperty("IsPlayable", true);
+}
+
 void CPlayList::Add(const CFileItemPtr &item)
 {
   Add(item, -1, -1);
@@ -129,45 +167,38 @@ void CPlayList::Add(const CFileItemPtr &item)
 
 void CPlayList::Add(CPlayList& playlist)
 {
-  for (int i = 0; i < (int)playlist.size(); i++)
-    Add(playlist[i], -1, -1);
+  Insert(playlist, -1);
 }
 
 void CPlayList::Add(CFileItemList& items)
 {
-  for (int i = 0; i < (int)items.Size(); i++)
-    Add(items[i]);
+  Insert(items, -1);
 }
 
 void CPlayList::Insert(CPlayList& playlist, int iPosition /* = -1 */)
 {
-  // out of bounds so just add to the end
-  int iSize = size();
-  if (iPosition < 0 || iPosition >= iSize)
+  // adding a playlist to itself mustn't see the items it adds, and the added
+  // items mustn't share their play order with the ones already in the list
+  std::vector<CFileItemPtr> items;
+  items.reserve(playlist.m_vecItems.size());
+  for (ivecItems it = playlist.m_vecItems.begin(); it != playlist.m_vecItems.end(); ++it)
   {
-    Add(playlist);
-    return;
-  }
-  for (int i = 0; i < (int)playlist.size(); i++)
-  {
-    int iPos = iPosition + i;
-    Add(playlist[i], iPos, iPos);
+    if (&playlist == this)
+      items.push_back(CFileItemPtr(new CFileItem(**it)));
+    else
+      items.push_back(*it);
   }
+  AddItems(items, iPosition);
 }
 
 void CPlayList::Insert(CFileItemList& items, int iPosition /* = -1 */)
 {
-  // out of bounds so just add to the end
-  int iSize = size();
-  if (iPosition < 0 || iPosition >= iSize)
-  {
-    Add(items);
-    return;
-  }
-  for (int i = 0; i < (int)items.Size(); i++)
-  {
-    Add(items[i], iPosition + i, iPosition + i);
-  }
+  std::vector<CFileItemPtr> vecItems;
+  vecItems.reserve(items.Size());
+  for (int i = 0; i < items.Size(); i++)
+    vecItems.push_back(items[i]);
+
+  AddItems(vecItems, iPosition);
 }
 
 void CPlayList::Insert(const CFileItemPtr &item, int iPosition /* = -1 */)
@@ -309,27 +340,42 @@ const std::string& CPlayList::GetName() const
 
 void CPlayList::Remove(const std::string& strFileName)
 {
-  int iOrder = -1;
+  std::vector<bool> remove(m_vecItems.size(), false);
+  for (unsigned int i = 0; i < m_vecItems.size(); i++)
+    remove[i] = m_vecItems[i]->GetPath() == strFileName;
+
+  RemoveItems(remove);
+}
+
+void CPlayList::RemoveItems(const std::vector<bool>& remove)
+{
+  // the orders of the removed items, to close the gaps they leave in a single pass
+  std::vector<int> removedOrders;
+  std::vector<CFileItemPtr> items;
+  items.reserve(m_vecItems.size());
   int position = 0;
-  ivecItems it;
-  it = m_vecItems.begin();
-  while (it != m_vecItems.end() )
+  for (unsigned int i = 0; i < m_vecItems.size(); i++)
   {
-    CFileItemPtr item = *it;
-    if (item->GetPath() == strFileName)
+    if (remove[i])
     {
-      iOrder = item->m_iprogramCount;
-      it = m_vecItems.erase(it);
+      removedOrders.push_back(m_vecItems[i]->m_iprogramCount);
       AnnounceRemove(position);
-      //CLog::Log(LOGDEBUG,"PLAYLIST, removing item at order %i", iPos);
     }
     else
     {
+      items.push_back(m_vecItems[i]);
       ++position;
-      ++it;
     }
   }
-  DecrementOrder(iOrder);
+
+  if (removedOrders.empty())
+    return;
+
+  std::sort(removedOrders.begin(), removedOrders.end());
+  for (ivecItems it = items.begin(); it != items.end(); ++it)
+    (*it)->m_iprogramCount -= std::upper_bound(removedOrders.begin(), removedOrders.end(), (*it)->m_iprogramCount) - removedOrders.begin();
+
+  m_vecItems.swap(items);
 }
 
 int CPlayList::FindOrder(int iOrder) const
@@ -342,7 +388,7 @@ int CPlayList::FindOrder(int iOrder) const
   return -1;
 }
 
-// remove item from playlist by position
+// remove item from playlist by position, a single item still needs a pass over the list to fix the orders
 void CPlayList::Remove(int position)
 {
   int iOrder = -1;
@@ -358,35 +404,21 @@ void CPlayList::Remove(int position)
 
 int CPlayList::RemoveDVDItems()
 {
-  std::vector <std::string> vecFilenames;
-
   // Collect playlist items from DVD share
-  ivecItems it;
-  it = m_vecItems.begin();
-  while (it != m_vecItems.end() )
+  std::vector<bool> remove(m_vecItems.size(), false);
+  int nFileCount = 0;
+  for (unsigned int i = 0; i < m_vecItems.size(); i++)
   {
-    CFileItemPtr item = *it;
-    if ( item->IsCDDA() || item->IsOnDVD() )
+    if (m_vecItems[i]->IsCDDA() || m_vecItems[i]->IsOnDVD())
     {
-      vecFilenames.push_back( item->GetPath() );
+      remove[i] = true;
+      nFileCount++;
     }
-    ++it;
   }
 
   // Delete them from playlist
-  int nFileCount = vecFilenames.size();
-  if ( nFileCount )
-  {
-    std::vector <std::string>::iterator it;
-    it = vecFilenames.begin();
-    while (it != vecFilenames.end() )
-    {
-      std::string& strFilename = *it;
-      Remove( strFilename );
-      ++it;
-    }
-    vecFilenames.erase( vecFilenames.begin(), vecFilenames.end() );
-  }
+  if (nFileCount)
+    RemoveItems(remove);
   return nFileCount;
 }
 
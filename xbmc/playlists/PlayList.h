@@ -22,6 +22,7 @@
 #include "FileItem.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace PLAYLIST
 {
@@ -85,12 +86,15 @@ protected:
 
 private:
   void Add(const CFileItemPtr& item, int iPosition, int iOrderOffset);
+  void AddItems(const std::vector<CFileItemPtr>& items, int iPosition);
+  void RemoveItems(const std::vector<bool>& remove);
+  void PrepareItem(const CFileItemPtr& item);
   void DecrementOrder(int iOrder);
   void IncrementOrder(int iPosition, int iOrder);
 
   void AnnounceRemove(int pos);
   void AnnounceClear();
-  void AnnounceAdd(const CFileItemPtr& item, int pos);
+  void AnnounceAdd(const CFileItemPtr& item, int pos, int count = 1);
 };
 
 typedef std::shared_ptr<CPlayList> CPlayListPtr;
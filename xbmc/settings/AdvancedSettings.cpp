@@ -141,6 +141,7 @@ void CAdvancedSettings::Initialize()
   m_videoPPFFmpegPostProc = "ha:128:7,va,dr";
   m_videoDefaultPlayer = "VideoPlayer";
   m_videoIgnoreSecondsAtStart = 3*60;
+  m_videoTrickplayInterval = 0;
   m_videoIgnorePercentAtEnd   = 8.0f;
   m_videoPlayCountMinimumPercent = 90.0f;
   m_videoVDPAUScaling = -1;
@@ -368,10 +369,18 @@ void CAdvancedSettings::Initialize()
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_readBufferFactor = 4.0f;
+  // number of concurrent range requests used to fill the cache (0 = single stream)
+  m_cacheReadAheadConnections = 0;
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
+  // time library announcements are held back to coalesce bursts (0 = dispatch right away)
+  m_jsonLibraryAnnouncementDelay = 0;
+
+  m_pythonInterpreterPoolSize = 0;
+  m_pythonInterpreterIdleTime = 300;
+  m_pythonInterpreterPoolMinFreeMemory = 64;
 
   m_enableMultimediaKeys = false;
 
@@ -383,6 +392,7 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiPreloadWindows = true;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -520,6 +530,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetFloat(pElement, "playcountminimumpercent", m_videoPlayCountMinimumPercent, 0.0f, 101.0f);
     XMLUtils::GetInt(pElement, "ignoresecondsatstart", m_videoIgnoreSecondsAtStart, 0, 900);
     XMLUtils::GetFloat(pElement, "ignorepercentatend", m_videoIgnorePercentAtEnd, 0, 100.0f);
+    XMLUtils::GetInt(pElement, "trickplayinterval", m_videoTrickplayInterval, 0, 600);
 
     XMLUtils::GetBoolean(pElement, "usetimeseeking", m_videoUseTimeSeeking);
     XMLUtils::GetInt(pElement, "timeseekforward", m_videoTimeSeekForward, 0, 6000);
@@ -753,6 +764,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
     XMLUtils::GetUInt(pElement, "buffermode", m_networkBufferMode, 0, 3);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
+    XMLUtils::GetUInt(pElement, "readaheadconnections", m_cacheReadAheadConnections, 0, 16);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -760,6 +772,15 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   {
     XMLUtils::GetBoolean(pElement, "compactoutput", m_jsonOutputCompact);
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
+    XMLUtils::GetUInt(pElement, "libraryannouncementdelay", m_jsonLibraryAnnouncementDelay, 0, 10000);
+  }
+
+  pElement = pRootElement->FirstChildElement("python");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "interpreterpoolsize", m_pythonInterpreterPoolSize, 0, 16);
+    XMLUtils::GetUInt(pElement, "interpreteridletime", m_pythonInterpreterIdleTime, 10, 3600);
+    XMLUtils::GetUInt(pElement, "interpreterpoolminfreememory", m_pythonInterpreterPoolMinFreeMemory);
   }
 
   pElement = pRootElement->FirstChildElement("samba");
@@ -1129,6 +1150,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetBoolean(pElement, "preloadwindows",        m_guiPreloadWindows);
   }
 
   std::string seekSteps;
@@ -165,6 +165,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_musicPercentSeekForwardBig;
     int m_musicPercentSeekBackwardBig;
     int m_videoIgnoreSecondsAtStart;
+    int m_videoTrickplayInterval; ///< seconds between the previews of the trickplay index, 0 disables it
     float m_videoIgnorePercentAtEnd;
     float m_audioApplyDrc;
     bool m_useFfmpegVda;
@@ -340,14 +341,21 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    bool m_guiPreloadWindows;
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
     unsigned int m_networkBufferMode;
     float m_readBufferFactor;
+    unsigned int m_cacheReadAheadConnections;
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
+    unsigned int m_jsonLibraryAnnouncementDelay;
+
+    unsigned int m_pythonInterpreterPoolSize; ///< warm interpreters kept for plugins, 0 disables the pool
+    unsigned int m_pythonInterpreterIdleTime; ///< seconds a warm interpreter is kept unused
+    unsigned int m_pythonInterpreterPoolMinFreeMemory; ///< MB of free memory below which no interpreters are kept
 
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
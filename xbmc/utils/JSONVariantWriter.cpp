@@ -26,10 +26,27 @@
 std::string CJSONVariantWriter::Write(const CVariant &value, bool compact)
 {
   std::string output;
+  if (!Generate(value, compact, NULL, NULL, output))
+    output.clear();
 
+  return output;
+}
+
+bool CJSONVariantWriter::Write(const CVariant &value, bool compact, const std::vector<std::string> &path, IArrayGenerator &generator, std::string &output)
+{
+  if (path.empty())
+    return false;
+
+  return Generate(value, compact, &path, &generator, output);
+}
+
+bool CJSONVariantWriter::Generate(const CVariant &value, bool compact, const std::vector<std::string> *path, IArrayGenerator *generator, std::string &output)
+{
+  // write straight into the output instead of collecting everything in yajl's buffer first
   yajl_gen g = yajl_gen_alloc(NULL);
   yajl_gen_config(g, yajl_gen_beautify, compact ? 0 : 1);
   yajl_gen_config(g, yajl_gen_indent_string, "\t");
+  yajl_gen_config(g, yajl_gen_print_callback, &CJSONVariantWriter::Print, &output);
 
   // Set locale to classic ("C") to ensure valid JSON numbers
 #ifndef TARGET_WINDOWS
@@ -50,14 +67,7 @@ std::string CJSONVariantWriter::Write(const CVariant &value, bool compact)
   }
 #endif // TARGET_WINDOWS
 
-  if (InternalWrite(g, value))
-  {
-    const unsigned char * buffer;
-
-    size_t length;
-    yajl_gen_get_buf(g, &buffer, &length);
-    output = std::string((const char *)buffer, length);
-  }
+  bool success = InternalWrite(g, value, path, 0, generator);
 
   // Re-set locale to what it was before using yajl
 #ifndef TARGET_WINDOWS
@@ -68,13 +78,17 @@ std::string CJSONVariantWriter::Write(const CVariant &value, bool compact)
     _wsetlocale(LC_NUMERIC, backupLocale.c_str());
 #endif // TARGET_WINDOWS
 
-  yajl_gen_clear(g);
   yajl_gen_free(g);
 
-  return output;
+  return success;
 }
 
-bool CJSONVariantWriter::InternalWrite(yajl_gen g, const CVariant &value)
+void CJSONVariantWriter::Print(void *ctx, const char *str, size_t len)
+{
+  static_cast<std::string*>(ctx)->append(str, len);
+}
+
+bool CJSONVariantWriter::InternalWrite(yajl_gen g, const CVariant &value, const std::vector<std::string> *path /* = NULL */, size_t depth /* = 0 */, IArrayGenerator *generator /* = NULL */)
 {
   bool success = false;
 
@@ -111,8 +125,26 @@ bool CJSONVariantWriter::InternalWrite(yajl_gen g, const CVariant &value)
     for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map() && success; ++itr)
     {
       success &= yajl_gen_status_ok == yajl_gen_string(g, (const unsigned char*)itr->first.c_str(), (size_t)itr->first.length());
-      if (success)
+      if (!success)
+        break;
+
+      if (path == NULL || itr->first != (*path)[depth])
         success &= InternalWrite(g, itr->second);
+      else if (depth + 1 < path->size())
+        success &= InternalWrite(g, itr->second, path, depth + 1, generator);
+      else
+      {
+        // each element is discarded as soon as it has been written
+        success &= yajl_gen_status_ok == yajl_gen_array_open(g);
+        CVariant element;
+        while (success && generator->Next(element))
+        {
+          success &= InternalWrite(g, element);
+          element = CVariant();
+        }
+        if (success)
+          success &= yajl_gen_status_ok == yajl_gen_array_close(g);
+      }
     }
 
     if (success)
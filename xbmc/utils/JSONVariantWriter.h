@@ -21,13 +21,47 @@
 
 #include <yajl/yajl_gen.h>
 #include <string>
+#include <vector>
 
 class CVariant;
 
 class CJSONVariantWriter
 {
 public:
+  /*!
+   \brief Produces the elements of an array while it is being written, so
+   they don't all have to be held in memory at once.
+   */
+  class IArrayGenerator
+  {
+  public:
+    virtual ~IArrayGenerator() { }
+
+    /*!
+     \brief Produce the next element of the array.
+     \param element [out] the element
+     \return true if an element was produced, false once the array is complete.
+     */
+    virtual bool Next(CVariant &element) = 0;
+  };
+
   static std::string Write(const CVariant &value, bool compact);
+
+  /*!
+   \brief Write a value whose elements at the given path are produced on the fly.
+   The member at the given path is written as an array holding the elements produced
+   by the generator instead of its own value. The output is identical to writing the
+   value with all elements in place.
+   \param value the value to write
+   \param compact whether to omit whitespace
+   \param path the keys leading from the value to the generated array
+   \param generator produces the elements of the array
+   \param output [out] the string the JSON is appended to
+   \return true on success, false otherwise.
+   */
+  static bool Write(const CVariant &value, bool compact, const std::vector<std::string> &path, IArrayGenerator &generator, std::string &output);
 private:
-  static bool InternalWrite(yajl_gen g, const CVariant &value);
+  static bool Generate(const CVariant &value, bool compact, const std::vector<std::string> *path, IArrayGenerator *generator, std::string &output);
+  static bool InternalWrite(yajl_gen g, const CVariant &value, const std::vector<std::string> *path = NULL, size_t depth = 0, IArrayGenerator *generator = NULL);
+  static void Print(void *ctx, const char *str, size_t len);
 };
@@ -320,6 +320,12 @@ void CJobManager::UnPauseJobs()
   m_pauseJobs = false;
 }
 
+bool CJobManager::IsPaused() const
+{
+  CSingleLock lock(m_section);
+  return m_pauseJobs;
+}
+
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
   CSingleLock lock(m_section);
@@ -267,6 +267,13 @@ public:
    */
   void UnPauseJobs();
 
+  /*!
+   \brief Whether jobs with priority PRIORITY_LOW_PAUSABLE are currently paused.
+   Long running pausable jobs can use this to stop early.
+   \sa PauseJobs()
+   */
+  bool IsPaused() const;
+
   /*!
    \brief Checks to see if any jobs with specific priority are currently processing.
    \param priority to search for
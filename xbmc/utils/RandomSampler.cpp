@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RandomSampler.h"
+
+#include <algorithm>
+
+CRandomSampler::CRandomSampler()
+  : m_available(0),
+    m_generator(std::random_device()())
+{ }
+
+void CRandomSampler::Assign(const std::vector<int> &ids)
+{
+  Clear();
+  m_ids.reserve(ids.size());
+  m_positions.reserve(ids.size());
+  for (std::vector<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+  {
+    if (m_positions.insert(std::make_pair(*it, m_ids.size())).second)
+      m_ids.push_back(*it);
+  }
+  m_available = m_ids.size();
+}
+
+void CRandomSampler::Update(const std::vector<int> &ids)
+{
+  std::vector<int> picked(m_ids.begin() + m_available, m_ids.end());
+  Assign(ids);
+
+  for (std::vector<int>::const_iterator it = picked.begin(); it != picked.end(); ++it)
+  {
+    std::unordered_map<int, unsigned int>::const_iterator position = m_positions.find(*it);
+    if (position != m_positions.end())
+      Take(position->second);
+  }
+}
+
+bool CRandomSampler::Pick(int &id)
+{
+  if (m_available == 0)
+    return false;
+
+  std::uniform_int_distribution<unsigned int> distribution(0, m_available - 1);
+  unsigned int position = distribution(m_generator);
+  Take(position);
+  id = m_ids[m_available];
+  return true;
+}
+
+unsigned int CRandomSampler::Sample(unsigned int count, std::vector<int> &ids)
+{
+  count = std::min(count, m_available);
+  ids.reserve(ids.size() + count);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    int id;
+    Pick(id);
+    ids.push_back(id);
+  }
+  return count;
+}
+
+void CRandomSampler::Release(int id)
+{
+  std::unordered_map<int, unsigned int>::const_iterator it = m_positions.find(id);
+  if (it == m_positions.end() || it->second < m_available)
+    return;
+
+  Swap(it->second, m_available);
+  m_available++;
+}
+
+void CRandomSampler::Reset()
+{
+  m_available = m_ids.size();
+}
+
+void CRandomSampler::Add(int id)
+{
+  if (!m_positions.insert(std::make_pair(id, m_ids.size())).second)
+    return;
+
+  // append the id and move it to the end of the available ones
+  m_ids.push_back(id);
+  Swap(m_ids.size() - 1, m_available);
+  m_available++;
+}
+
+void CRandomSampler::Remove(int id)
+{
+  std::unordered_map<int, unsigned int>::iterator it = m_positions.find(id);
+  if (it == m_positions.end())
+    return;
+
+  if (it->second < m_available)
+    Take(it->second);
+
+  // the id is among the picked ones now, move the last one into its place
+  Swap(m_positions[id], m_ids.size() - 1);
+  m_ids.pop_back();
+  m_positions.erase(id);
+}
+
+void CRandomSampler::Clear()
+{
+  m_ids.clear();
+  m_positions.clear();
+  m_available = 0;
+}
+
+void CRandomSampler::Swap(unsigned int a, unsigned int b)
+{
+  if (a == b)
+    return;
+
+  std::swap(m_ids[a], m_ids[b]);
+  m_positions[m_ids[a]] = a;
+  m_positions[m_ids[b]] = b;
+}
+
+void CRandomSampler::Take(unsigned int position)
+{
+  // move the id to the front of the picked ones
+  m_available--;
+  Swap(position, m_available);
+}
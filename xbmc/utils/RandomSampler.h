@@ -0,0 +1,100 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ \brief Picks random ids from a set of candidates without replacement.
+
+ The candidates are kept in an array of which the first part holds the ids that
+ are still available and the rest the ones that have been picked. Picking an id
+ swaps a random available id to the end of the available part (one step of a
+ Fisher-Yates shuffle), so picking k ids takes O(k) no matter how many
+ candidates there are. Picked ids can be made available again individually,
+ e.g. once they dropped out of a history.
+ */
+class CRandomSampler
+{
+public:
+  CRandomSampler();
+
+  /*!
+   \brief Replace the candidates, all of them are available.
+   */
+  void Assign(const std::vector<int> &ids);
+
+  /*!
+   \brief Replace the candidates, keeping ids that were picked before picked.
+   Used to refresh the candidates after the library changed.
+   */
+  void Update(const std::vector<int> &ids);
+
+  /*!
+   \brief Pick a random available id.
+   \param id [out] the picked id
+   \return true if an id was picked, false if no id is available.
+   */
+  bool Pick(int &id);
+
+  /*!
+   \brief Pick up to count distinct random available ids.
+   \param count the number of ids to pick
+   \param ids [out] the picked ids are appended to this
+   \return the number of picked ids.
+   */
+  unsigned int Sample(unsigned int count, std::vector<int> &ids);
+
+  /*!
+   \brief Make a picked id available again.
+   */
+  void Release(int id);
+
+  /*!
+   \brief Make all ids available again.
+   */
+  void Reset();
+
+  /*!
+   \brief Add an available id to the candidates, ids that are candidates already are kept as they are.
+   */
+  void Add(int id);
+
+  /*!
+   \brief Remove an id from the candidates.
+   */
+  void Remove(int id);
+  void Clear();
+
+  bool Contains(int id) const { return m_positions.find(id) != m_positions.end(); }
+  unsigned int Size() const { return m_ids.size(); }
+  unsigned int Available() const { return m_available; }
+
+private:
+  void Swap(unsigned int a, unsigned int b);
+  void Take(unsigned int position);
+
+  std::vector<int> m_ids;                             ///< available ids first, picked ones after them
+  std::unordered_map<int, unsigned int> m_positions;  ///< position of each id in m_ids
+  unsigned int m_available;
+  std::mt19937 m_generator;
+};
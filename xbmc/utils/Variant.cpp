@@ -134,6 +134,7 @@ CVariant CVariant::ConstNullVariant = CVariant::VariantTypeConstNull;
 CVariant::CVariant(VariantType type)
 {
   m_type = type;
+  m_shortStringLength = 0;
 
   switch (type)
   {
@@ -150,7 +151,7 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new std::string();
+      m_data.shortString[0] = '\0';
       break;
     case VariantTypeWideString:
       m_data.wstring = new std::wstring();
@@ -169,96 +170,104 @@ CVariant::CVariant(VariantType type)
 
 CVariant::CVariant(int integer)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeInteger;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(int64_t integer)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeInteger;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(unsigned int unsignedinteger)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeUnsignedInteger;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(uint64_t unsignedinteger)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeUnsignedInteger;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(double value)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeDouble;
   m_data.dvalue = value;
 }
 
 CVariant::CVariant(float value)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeDouble;
   m_data.dvalue = (double)value;
 }
 
 CVariant::CVariant(bool boolean)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeBoolean;
   m_data.boolean = boolean;
 }
 
 CVariant::CVariant(const char *str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  setString(str, strlen(str));
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
-  m_type = VariantTypeString;
-  m_data.string = new std::string(str, length);
+  setString(str, length);
 }
 
 CVariant::CVariant(const std::string &str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  setString(str.c_str(), str.size());
 }
 
 CVariant::CVariant(std::string &&str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new std::string(std::move(str));
+  setString(std::move(str));
 }
 
 CVariant::CVariant(const wchar_t *str)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeWideString;
   m_data.wstring = new std::wstring(str);
 }
 
 CVariant::CVariant(const wchar_t *str, unsigned int length)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeWideString;
   m_data.wstring = new std::wstring(str, length);
 }
 
 CVariant::CVariant(const std::wstring &str)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeWideString;
   m_data.wstring = new std::wstring(str);
 }
 
 CVariant::CVariant(std::wstring &&str)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeWideString;
   m_data.wstring = new std::wstring(std::move(str));
 }
 
 CVariant::CVariant(const std::vector<std::string> &strArray)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeArray;
   m_data.array = new VariantArray;
   m_data.array->reserve(strArray.size());
@@ -268,6 +277,7 @@ CVariant::CVariant(const std::vector<std::string> &strArray)
 
 CVariant::CVariant(const std::map<std::string, std::string> &strMap)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeObject;
   m_data.map = new VariantMap;
   for (std::map<std::string, std::string>::const_iterator it = strMap.begin(); it != strMap.end(); ++it)
@@ -276,6 +286,7 @@ CVariant::CVariant(const std::map<std::string, std::string> &strMap)
 
 CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 {
+  m_shortStringLength = 0;
   m_type = VariantTypeObject;
   m_data.map = new VariantMap(variantMap.begin(), variantMap.end());
 }
@@ -283,14 +294,16 @@ CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 CVariant::CVariant(const CVariant &variant)
 {
   m_type = VariantTypeNull;
+  m_shortStringLength = 0;
   *this = variant;
 }
 
-CVariant::CVariant(CVariant&& rhs)
+CVariant::CVariant(CVariant&& rhs) throw()
 {
   //Set this so that operator= don't try and run cleanup
   //when we're not initialized.
   m_type = VariantTypeNull;
+  m_shortStringLength = 0;
 
   *this = std::move(rhs);
 }
@@ -302,7 +315,7 @@ CVariant::~CVariant()
 
 void CVariant::cleanup()
 {
-  if (m_type == VariantTypeString)
+  if (m_type == VariantTypeString && !isShortString())
     delete m_data.string;
   else if (m_type == VariantTypeWideString)
     delete m_data.wstring;
@@ -311,6 +324,55 @@ void CVariant::cleanup()
   else if (m_type == VariantTypeObject)
     delete m_data.map;
   m_type = VariantTypeNull;
+  m_shortStringLength = 0;
+}
+
+void CVariant::setString(const char *str, size_t length)
+{
+  m_type = VariantTypeString;
+  if (length <= MaxShortStringLength)
+  {
+    m_shortStringLength = static_cast<int8_t>(length);
+    memcpy(m_data.shortString, str, length);
+    m_data.shortString[length] = '\0';
+  }
+  else
+  {
+    m_shortStringLength = -1;
+    m_data.string = new std::string(str, length);
+  }
+}
+
+void CVariant::setString(std::string &&str)
+{
+  if (str.size() <= MaxShortStringLength)
+    setString(str.c_str(), str.size());
+  else
+  {
+    // keep the buffer of long strings
+    m_type = VariantTypeString;
+    m_shortStringLength = -1;
+    m_data.string = new std::string(std::move(str));
+  }
+}
+
+const char *CVariant::stringData() const
+{
+  return isShortString() ? m_data.shortString : m_data.string->c_str();
+}
+
+size_t CVariant::stringLength() const
+{
+  return isShortString() ? m_shortStringLength : m_data.string->size();
+}
+
+const std::string &CVariant::getString(std::string &buffer) const
+{
+  if (!isShortString())
+    return *m_data.string;
+
+  buffer.assign(m_data.shortString, m_shortStringLength);
+  return buffer;
 }
 
 bool CVariant::isInteger() const
@@ -374,7 +436,10 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+    {
+      std::string buffer;
+      return str2int64(getString(buffer), fallback);
+    }
     case VariantTypeWideString:
       return str2int64(*m_data.wstring, fallback);
     default:
@@ -395,7 +460,10 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+    {
+      std::string buffer;
+      return str2uint64(getString(buffer), fallback);
+    }
     case VariantTypeWideString:
       return str2uint64(*m_data.wstring, fallback);
     default:
@@ -416,7 +484,10 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+    {
+      std::string buffer;
+      return str2double(getString(buffer), fallback);
+    }
     case VariantTypeWideString:
       return str2double(*m_data.wstring, fallback);
     default:
@@ -437,7 +508,10 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+    {
+      std::string buffer;
+      return (float)str2double(getString(buffer), fallback);
+    }
     case VariantTypeWideString:
       return (float)str2double(*m_data.wstring, fallback);
     default:
@@ -460,9 +534,13 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+    {
+      const char *str = stringData();
+      size_t length = stringLength();
+      if (length == 0 || (length == 1 && str[0] == '0') || (length == 5 && memcmp(str, "false", 5) == 0))
         return false;
       return true;
+    }
     case VariantTypeWideString:
       if (m_data.wstring->empty() || m_data.wstring->compare(L"0") == 0 || m_data.wstring->compare(L"false") == 0)
         return false;
@@ -479,7 +557,7 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
-      return *m_data.string;
+      return std::string(stringData(), stringLength());
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
     case VariantTypeInteger:
@@ -577,6 +655,7 @@ CVariant &CVariant::operator=(const CVariant &rhs)
   cleanup();
 
   m_type = rhs.m_type;
+  m_shortStringLength = rhs.m_shortStringLength;
 
   switch (m_type)
   {
@@ -593,7 +672,10 @@ CVariant &CVariant::operator=(const CVariant &rhs)
     m_data.dvalue = rhs.m_data.dvalue;
     break;
   case VariantTypeString:
-    m_data.string = new std::string(*rhs.m_data.string);
+    if (rhs.isShortString())
+      memcpy(m_data.shortString, rhs.m_data.shortString, sizeof(m_data.shortString));
+    else
+      m_data.string = new std::string(*rhs.m_data.string);
     break;
   case VariantTypeWideString:
     m_data.wstring = new std::wstring(*rhs.m_data.wstring);
@@ -611,7 +693,7 @@ CVariant &CVariant::operator=(const CVariant &rhs)
   return *this;
 }
 
-CVariant& CVariant::operator=(CVariant&& rhs)
+CVariant& CVariant::operator=(CVariant&& rhs) throw()
 {
   if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
@@ -621,11 +703,12 @@ CVariant& CVariant::operator=(CVariant&& rhs)
     cleanup();
 
   m_type = rhs.m_type;
+  m_shortStringLength = rhs.m_shortStringLength;
   m_data = std::move(rhs.m_data);
 
   //Should be enough to just set m_type here
   //but better safe than sorry, could probably lead to coverity warnings
-  if (rhs.m_type == VariantTypeString)
+  if (rhs.m_type == VariantTypeString && !rhs.isShortString())
     rhs.m_data.string = nullptr;
   else if (rhs.m_type == VariantTypeWideString)
     rhs.m_data.wstring = nullptr;
@@ -635,6 +718,7 @@ CVariant& CVariant::operator=(CVariant&& rhs)
     rhs.m_data.map = nullptr;
 
   rhs.m_type = VariantTypeNull;
+  rhs.m_shortStringLength = 0;
 
   return *this;
 }
@@ -654,7 +738,7 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return stringLength() == rhs.stringLength() && memcmp(stringData(), rhs.stringData(), stringLength()) == 0;
     case VariantTypeWideString:
       return *m_data.wstring == *rhs.m_data.wstring;
     case VariantTypeArray:
@@ -706,20 +790,23 @@ void CVariant::append(CVariant&& variant)
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return stringData();
   else
     return NULL;
 }
 
-void CVariant::swap(CVariant &rhs)
+void CVariant::swap(CVariant &rhs) throw()
 {
   VariantType  temp_type = m_type;
+  int8_t       temp_length = m_shortStringLength;
   VariantUnion temp_data = m_data;
 
   m_type = rhs.m_type;
+  m_shortStringLength = rhs.m_shortStringLength;
   m_data = rhs.m_data;
 
   rhs.m_type = temp_type;
+  rhs.m_shortStringLength = temp_length;
   rhs.m_data = temp_data;
 }
 
@@ -794,7 +881,7 @@ unsigned int CVariant::size() const
   else if (m_type == VariantTypeArray)
     return m_data.array->size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return stringLength();
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->size();
   else
@@ -808,7 +895,7 @@ bool CVariant::empty() const
   else if (m_type == VariantTypeArray)
     return m_data.array->empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return stringLength() == 0;
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->empty();
   else if (m_type == VariantTypeNull)
@@ -824,7 +911,10 @@ void CVariant::clear()
   else if (m_type == VariantTypeArray)
     m_data.array->clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+  {
+    cleanup();
+    setString("", 0);
+  }
   else if (m_type == VariantTypeWideString)
     m_data.wstring->clear();
 }
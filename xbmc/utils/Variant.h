@@ -68,7 +68,8 @@ public:
   CVariant(const std::map<std::string, std::string> &strMap);
   CVariant(const std::map<std::string, CVariant> &variantMap);
   CVariant(const CVariant &variant);
-  CVariant(CVariant &&rhs);
+  // moving never throws, so containers move their elements instead of copying them
+  CVariant(CVariant &&rhs) throw();
   ~CVariant();
 
 
@@ -99,7 +100,7 @@ public:
   const CVariant &operator[](unsigned int position) const;
 
   CVariant &operator=(const CVariant &rhs);
-  CVariant &operator=(CVariant &&rhs);
+  CVariant &operator=(CVariant &&rhs) throw();
   bool operator==(const CVariant &rhs) const;
   bool operator!=(const CVariant &rhs) const { return !(*this == rhs); }
 
@@ -110,7 +111,7 @@ public:
 
   const char *c_str() const;
 
-  void swap(CVariant &rhs);
+  void swap(CVariant &rhs) throw();
 
 private:
   typedef std::vector<CVariant> VariantArray;
@@ -145,6 +146,17 @@ public:
 
 private:
   void cleanup();
+  void setString(const char *str, size_t length);
+  void setString(std::string &&str);
+  bool isShortString() const { return m_shortStringLength >= 0; }
+  const char *stringData() const;
+  size_t stringLength() const;
+  const std::string &getString(std::string &buffer) const;
+
+  // strings up to this length are stored in the variant itself instead of the heap,
+  // in the space of the other members of the union so the variant doesn't grow
+  static const size_t MaxShortStringLength = sizeof(int64_t) - 1;
+
   union VariantUnion
   {
     int64_t integer;
@@ -152,11 +164,13 @@ private:
     bool boolean;
     double dvalue;
     std::string *string;
+    char shortString[MaxShortStringLength + 1];
     std::wstring *wstring;
     VariantArray *array;
     VariantMap *map;
   };
 
   VariantType m_type;
+  int8_t m_shortStringLength;   ///< length of a string held in m_data.shortString, -1 if it's held in m_data.string
   VariantUnion m_data;
 };
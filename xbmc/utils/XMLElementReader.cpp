@@ -0,0 +1,156 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "XMLElementReader.h"
+
+CXMLElementReader::CXMLElementReader(const std::string &xml)
+  : m_xml(xml),
+    m_pos(0),
+    m_depth(0),
+    m_hasRoot(false),
+    m_failed(false),
+    m_elementStart(std::string::npos)
+{ }
+
+bool CXMLElementReader::Fail()
+{
+  m_failed = true;
+  return false;
+}
+
+size_t CXMLElementReader::Skip(size_t pos, const char *end) const
+{
+  size_t found = m_xml.find(end, pos);
+  return found == std::string::npos ? found : found + std::char_traits<char>::length(end);
+}
+
+bool CXMLElementReader::Next(std::string &name, const char *&element, size_t &length)
+{
+  while (!m_failed)
+  {
+    // markup is the only place a '<' may appear in, text has it escaped
+    size_t start = m_xml.find('<', m_pos);
+    if (start == std::string::npos)
+    {
+      if (m_depth != 0 || !m_hasRoot)
+        return Fail();
+      return false;
+    }
+
+    if (m_xml.compare(start, 2, "<?") == 0)
+    {
+      m_pos = Skip(start + 2, "?>");
+      if (m_pos == std::string::npos)
+        return Fail();
+      if (!m_hasRoot && m_declaration.empty() && m_xml.compare(start, 6, "<?xml ") == 0)
+        m_declaration = m_xml.substr(start, m_pos - start);
+      continue;
+    }
+    if (m_xml.compare(start, 4, "<!--") == 0)
+    {
+      m_pos = Skip(start + 4, "-->");
+      if (m_pos == std::string::npos)
+        return Fail();
+      continue;
+    }
+    if (m_xml.compare(start, 9, "<![CDATA[") == 0)
+    {
+      m_pos = Skip(start + 9, "]]>");
+      if (m_pos == std::string::npos)
+        return Fail();
+      continue;
+    }
+    if (m_xml.compare(start, 2, "<!") == 0)
+    {
+      // document type declaration, possibly with an internal subset
+      size_t end = m_xml.find_first_of("[>", start);
+      if (end != std::string::npos && m_xml[end] == '[')
+        end = m_xml.find(']', end);
+      m_pos = end == std::string::npos ? end : Skip(end, ">");
+      if (m_pos == std::string::npos)
+        return Fail();
+      continue;
+    }
+
+    if (m_xml.compare(start, 2, "</") == 0)
+    {
+      m_pos = Skip(start + 2, ">");
+      if (m_pos == std::string::npos || --m_depth < 0)
+        return Fail();
+
+      if (m_depth == 1)
+      {
+        name = m_elementName;
+        element = m_xml.c_str() + m_elementStart;
+        length = m_pos - m_elementStart;
+        return true;
+      }
+      continue;
+    }
+
+    // start tag, attribute values may contain a '>'
+    size_t end = start + 1;
+    char quote = 0;
+    for (; end < m_xml.size(); ++end)
+    {
+      const char c = m_xml[end];
+      if (quote)
+      {
+        if (c == quote)
+          quote = 0;
+      }
+      else if (c == '"' || c == '\'')
+        quote = c;
+      else if (c == '>')
+        break;
+    }
+    if (end == m_xml.size())
+      return Fail();
+
+    m_pos = end + 1;
+    const bool empty = m_xml[end - 1] == '/';
+
+    if (m_depth == 0)
+    {
+      // a document has a single root element
+      if (m_hasRoot)
+        return Fail();
+      m_hasRoot = true;
+    }
+    else if (m_depth == 1)
+    {
+      size_t nameEnd = m_xml.find_first_of(" \t\r\n/>", start + 1);
+      m_elementStart = start;
+      m_elementName = m_xml.substr(start + 1, nameEnd - start - 1);
+
+      if (empty)
+      {
+        name = m_elementName;
+        element = m_xml.c_str() + m_elementStart;
+        length = m_pos - m_elementStart;
+        return true;
+      }
+    }
+
+    if (!empty)
+      m_depth++;
+  }
+  return false;
+}
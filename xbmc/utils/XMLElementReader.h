@@ -0,0 +1,74 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+/*!
+ \brief Reads the children of the root element of an XML document one by one.
+
+ Documents that are mere lists of self-contained elements (like the addons.xml
+ of a repository) don't need to be parsed into a DOM as a whole. The reader only
+ scans the markup to find where each child of the root element starts and ends,
+ so the elements can be handed to a parser of their own one at a time.
+
+ The document has to outlive the reader. Elements are returned as they appear
+ in the document, entities aren't resolved and the markup isn't validated.
+ */
+class CXMLElementReader
+{
+public:
+  explicit CXMLElementReader(const std::string &xml);
+
+  /*!
+   \brief Find the next child element of the root element.
+   \param name [out] the name of the element
+   \param element [out] the start of the element in the document
+   \param length [out] the length of the element, including its start and end tags
+   \return true if an element was found, false at the end of the document or on errors.
+   \sa Failed
+   */
+  bool Next(std::string &name, const char *&element, size_t &length);
+
+  /*!
+   \brief Whether the document is incomplete or its markup is malformed.
+   */
+  bool Failed() const { return m_failed; }
+
+  /*!
+   \brief Retrieve the XML declaration of the document, empty if it has none.
+   Elements have to be prefixed with it to be parsed with the encoding of the document.
+   */
+  const std::string& GetDeclaration() const { return m_declaration; }
+
+private:
+  bool Fail();
+  size_t Skip(size_t pos, const char *end) const;
+
+  const std::string &m_xml;
+  std::string m_declaration;
+  size_t m_pos;
+  int m_depth;
+  bool m_hasRoot;
+  bool m_failed;
+
+  size_t m_elementStart;
+  std::string m_elementName;
+};
@@ -31,3 +31,59 @@ TEST(TestJSONVariantWriter, Write)
   str = CJSONVariantWriter::Write(variant, false);
   EXPECT_STREQ("null\n", str.c_str());
 }
+
+namespace
+{
+  class CCountingGenerator : public CJSONVariantWriter::IArrayGenerator
+  {
+  public:
+    CCountingGenerator(int count) : m_current(0), m_count(count) { }
+
+    virtual bool Next(CVariant &element)
+    {
+      if (m_current >= m_count)
+        return false;
+
+      element["id"] = m_current++;
+      element["label"] = "item";
+      return true;
+    }
+
+  private:
+    int m_current;
+    int m_count;
+  };
+}
+
+TEST(TestJSONVariantWriter, WriteGenerated)
+{
+  CVariant expected;
+  expected["id"] = 1;
+  expected["result"]["limits"]["total"] = 3;
+  expected["result"]["items"] = CVariant(CVariant::VariantTypeArray);
+  CVariant variant(expected);
+  CCountingGenerator elements(3);
+  CVariant element;
+  while (elements.Next(element))
+  {
+    expected["result"]["items"].push_back(element);
+    element = CVariant();
+  }
+
+  std::vector<std::string> path;
+  path.push_back("result");
+  path.push_back("items");
+
+  for (int compact = 0; compact < 2; compact++)
+  {
+    CCountingGenerator generator(3);
+    std::string str;
+    EXPECT_TRUE(CJSONVariantWriter::Write(variant, compact != 0, path, generator, str));
+    EXPECT_EQ(CJSONVariantWriter::Write(expected, compact != 0), str);
+  }
+
+  CCountingGenerator empty(0);
+  std::string str;
+  EXPECT_TRUE(CJSONVariantWriter::Write(variant, true, path, empty, str));
+  EXPECT_EQ(CJSONVariantWriter::Write(variant, true), str);
+}
@@ -0,0 +1,163 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <set>
+
+#include "utils/RandomSampler.h"
+
+#include "gtest/gtest.h"
+
+static std::vector<int> GetIds(int count)
+{
+  std::vector<int> ids;
+  for (int i = 0; i < count; i++)
+    ids.push_back(i * 10);
+  return ids;
+}
+
+TEST(TestRandomSampler, Pick)
+{
+  CRandomSampler sampler;
+  sampler.Assign(GetIds(100));
+  EXPECT_EQ(100U, sampler.Size());
+  EXPECT_EQ(100U, sampler.Available());
+
+  std::set<int> picked;
+  int id;
+  for (int i = 0; i < 100; i++)
+  {
+    EXPECT_TRUE(sampler.Pick(id));
+    EXPECT_EQ(0, id % 10);
+    EXPECT_TRUE(picked.insert(id).second);
+  }
+  EXPECT_FALSE(sampler.Pick(id));
+  EXPECT_EQ(0U, sampler.Available());
+
+  sampler.Reset();
+  EXPECT_EQ(100U, sampler.Available());
+}
+
+TEST(TestRandomSampler, Duplicates)
+{
+  std::vector<int> ids(10, 42);
+  CRandomSampler sampler;
+  sampler.Assign(ids);
+  EXPECT_EQ(1U, sampler.Size());
+}
+
+TEST(TestRandomSampler, Sample)
+{
+  CRandomSampler sampler;
+  sampler.Assign(GetIds(20));
+
+  std::vector<int> ids;
+  EXPECT_EQ(15U, sampler.Sample(15, ids));
+  EXPECT_EQ(5U, sampler.Sample(15, ids));
+  EXPECT_EQ(0U, sampler.Sample(15, ids));
+  EXPECT_EQ(20U, ids.size());
+
+  std::sort(ids.begin(), ids.end());
+  EXPECT_EQ(GetIds(20), ids);
+}
+
+TEST(TestRandomSampler, Release)
+{
+  CRandomSampler sampler;
+  sampler.Assign(GetIds(3));
+
+  int first, id;
+  EXPECT_TRUE(sampler.Pick(first));
+  EXPECT_TRUE(sampler.Pick(id));
+  EXPECT_TRUE(sampler.Pick(id));
+  EXPECT_FALSE(sampler.Pick(id));
+
+  sampler.Release(first);
+  sampler.Release(first);
+  EXPECT_EQ(1U, sampler.Available());
+  EXPECT_TRUE(sampler.Pick(id));
+  EXPECT_EQ(first, id);
+}
+
+TEST(TestRandomSampler, Update)
+{
+  CRandomSampler sampler;
+  sampler.Assign(GetIds(10));
+
+  std::vector<int> picked;
+  sampler.Sample(5, picked);
+
+  // drop one of the picked ids and add a new one
+  std::vector<int> ids = GetIds(10);
+  ids.erase(std::find(ids.begin(), ids.end(), picked[0]));
+  ids.push_back(1000);
+  sampler.Update(ids);
+
+  EXPECT_EQ(10U, sampler.Size());
+  EXPECT_EQ(6U, sampler.Available());
+  EXPECT_FALSE(sampler.Contains(picked[0]));
+  EXPECT_TRUE(sampler.Contains(1000));
+
+  std::vector<int> remaining;
+  sampler.Sample(10, remaining);
+  for (std::vector<int>::const_iterator it = picked.begin(); it != picked.end(); ++it)
+    EXPECT_TRUE(std::find(remaining.begin(), remaining.end(), *it) == remaining.end());
+}
+
+TEST(TestRandomSampler, Remove)
+{
+  CRandomSampler sampler;
+  sampler.Assign(GetIds(10));
+
+  int id;
+  EXPECT_TRUE(sampler.Pick(id));
+  sampler.Remove(id);
+  sampler.Remove(0 == id ? 10 : 0);
+  EXPECT_EQ(8U, sampler.Size());
+  EXPECT_EQ(8U, sampler.Available());
+
+  std::vector<int> ids;
+  sampler.Sample(10, ids);
+  EXPECT_EQ(8U, ids.size());
+  EXPECT_TRUE(std::find(ids.begin(), ids.end(), id) == ids.end());
+}
+
+TEST(TestRandomSampler, Add)
+{
+  CRandomSampler sampler;
+  sampler.Assign(GetIds(10));
+
+  std::vector<int> picked;
+  sampler.Sample(10, picked);
+
+  // adding a picked id keeps it picked
+  sampler.Add(picked[0]);
+  EXPECT_EQ(10U, sampler.Size());
+  EXPECT_EQ(0U, sampler.Available());
+
+  sampler.Add(1000);
+  EXPECT_EQ(11U, sampler.Size());
+  EXPECT_EQ(1U, sampler.Available());
+
+  int id;
+  EXPECT_TRUE(sampler.Pick(id));
+  EXPECT_EQ(1000, id);
+  EXPECT_FALSE(sampler.Pick(id));
+}
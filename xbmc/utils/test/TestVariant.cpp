@@ -18,6 +18,8 @@
  *
  */
 
+#include <string.h>
+
 #include "utils/Variant.h"
 
 #include "gtest/gtest.h"
@@ -75,6 +77,52 @@ TEST(TestVariant, VariantTypeString)
   EXPECT_STREQ("VariantTypeString3", c.asString().c_str());
 }
 
+TEST(TestVariant, VariantTypeShortAndLongString)
+{
+  // strings of all lengths around the size kept inside the variant
+  for (size_t length = 0; length < 40; length++)
+  {
+    std::string str(length, 'x');
+    if (length > 2)
+      str[1] = '\0';
+
+    std::string temp(str);
+    CVariant a(str), b(str.c_str(), str.size()), c(std::move(temp));
+    EXPECT_EQ(str, a.asString());
+    EXPECT_EQ(str, b.asString());
+    EXPECT_EQ(str, c.asString());
+    EXPECT_EQ(length, a.size());
+    EXPECT_EQ(length == 0, a.empty());
+    EXPECT_TRUE(a == b);
+
+    CVariant copy(a);
+    CVariant moved(std::move(c));
+    EXPECT_EQ(str, copy.asString());
+    EXPECT_EQ(str, moved.asString());
+    EXPECT_TRUE(c.isNull());
+    EXPECT_EQ(0, memcmp(str.c_str(), copy.c_str(), length + 1));
+
+    copy.clear();
+    EXPECT_TRUE(copy.isString());
+    EXPECT_TRUE(copy.empty());
+    EXPECT_STREQ("", copy.c_str());
+  }
+
+  CVariant shortString("short"), longString("a string too long to be kept in place");
+  shortString.swap(longString);
+  EXPECT_STREQ("a string too long to be kept in place", shortString.c_str());
+  EXPECT_STREQ("short", longString.c_str());
+  EXPECT_FALSE(shortString == longString);
+
+  EXPECT_EQ(12, CVariant("12").asInteger());
+  EXPECT_FALSE(CVariant("false").asBoolean(true));
+  EXPECT_FALSE(CVariant("0").asBoolean(true));
+  EXPECT_TRUE(CVariant("falsey").asBoolean(false));
+
+  // strings are kept in the space of the other values, the variant doesn't grow
+  EXPECT_LE(sizeof(CVariant), 2 * sizeof(int64_t));
+}
+
 TEST(TestVariant, VariantTypeWideString)
 {
   CVariant a(L"VariantTypeWideString");
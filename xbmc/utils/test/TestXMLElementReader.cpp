@@ -0,0 +1,97 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/XMLElementReader.h"
+
+#include "gtest/gtest.h"
+
+static std::string NextElement(CXMLElementReader &reader, std::string &name)
+{
+  const char *element;
+  size_t length;
+  if (!reader.Next(name, element, length))
+    return "";
+  return std::string(element, length);
+}
+
+TEST(TestXMLElementReader, Elements)
+{
+  std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                    "<!-- <addon id=\"commented\"/> -->\n"
+                    "<addons>\n"
+                    "  <addon id=\"a\" name=\"a > b\"><summary>x<![CDATA[</addon>]]></summary></addon>\n"
+                    "  <addon id='b'/>\n"
+                    "  <other><addon id=\"c\"></addon></other>\n"
+                    "</addons>\n";
+  CXMLElementReader reader(xml);
+  std::string name;
+
+  EXPECT_EQ("<addon id=\"a\" name=\"a > b\"><summary>x<![CDATA[</addon>]]></summary></addon>", NextElement(reader, name));
+  EXPECT_EQ("addon", name);
+  EXPECT_EQ("<addon id='b'/>", NextElement(reader, name));
+  EXPECT_EQ("addon", name);
+  EXPECT_EQ("<other><addon id=\"c\"></addon></other>", NextElement(reader, name));
+  EXPECT_EQ("other", name);
+  EXPECT_EQ("", NextElement(reader, name));
+  EXPECT_FALSE(reader.Failed());
+  EXPECT_EQ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>", reader.GetDeclaration());
+}
+
+TEST(TestXMLElementReader, DocumentType)
+{
+  std::string xml = "<!DOCTYPE addons [ <!ENTITY x \"y\"> ]><addons><addon/></addons>";
+  CXMLElementReader reader(xml);
+  std::string name;
+
+  EXPECT_EQ("<addon/>", NextElement(reader, name));
+  EXPECT_EQ("", NextElement(reader, name));
+  EXPECT_FALSE(reader.Failed());
+  EXPECT_TRUE(reader.GetDeclaration().empty());
+}
+
+TEST(TestXMLElementReader, Truncated)
+{
+  std::string xml = "<addons><addon id=\"a\"></addon><addon id=\"b\">";
+  CXMLElementReader reader(xml);
+  std::string name;
+
+  EXPECT_EQ("<addon id=\"a\"></addon>", NextElement(reader, name));
+  EXPECT_EQ("", NextElement(reader, name));
+  EXPECT_TRUE(reader.Failed());
+}
+
+TEST(TestXMLElementReader, Malformed)
+{
+  std::string empty;
+  CXMLElementReader emptyReader(empty);
+  std::string name;
+  EXPECT_EQ("", NextElement(emptyReader, name));
+  EXPECT_TRUE(emptyReader.Failed());
+
+  std::string roots = "<addons/><addons/>";
+  CXMLElementReader rootsReader(roots);
+  EXPECT_EQ("", NextElement(rootsReader, name));
+  EXPECT_TRUE(rootsReader.Failed());
+
+  std::string unbalanced = "<addons></addon></addons></addons>";
+  CXMLElementReader unbalancedReader(unbalanced);
+  EXPECT_EQ("", NextElement(unbalancedReader, name));
+  EXPECT_TRUE(unbalancedReader.Failed());
+}
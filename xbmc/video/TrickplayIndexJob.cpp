@@ -0,0 +1,332 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TrickplayIndexJob.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Application.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "cores/VideoPlayer/DVDThumbnailExtractor.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/StackDirectory.h"
+#include "pictures/Picture.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SystemClock.h"
+#include "utils/Crc32.h"
+#include "utils/JobManager.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "utils/Variant.h"
+#include "video/VideoDatabase.h"
+#include "video/VideoInfoTag.h"
+
+#ifdef TARGET_POSIX
+#include "linux/XTimeUtils.h"
+#endif
+
+#define TRICKPLAY_DIRECTORY     "special://thumbnails/trickplay/"
+#define TRICKPLAY_VERSION       1
+#define TRICKPLAY_TILE_WIDTH    160
+#define TRICKPLAY_COLUMNS       10
+#define TRICKPLAY_ROWS          10
+// previews beyond this number increase the interval instead
+#define TRICKPLAY_MAX_PREVIEWS  2000
+// pause between two previews so the job doesn't saturate the disk/network
+#define TRICKPLAY_THROTTLE_MS   50
+
+namespace
+{
+  // generates one index (or rather one sheet of it) at a time
+  class CTrickplayJobQueue : public CJobQueue
+  {
+  public:
+    CTrickplayJobQueue() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE) { }
+
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+    {
+      CJob *continuation = success ? static_cast<CTrickplayIndexJob*>(job)->GetContinuation() : NULL;
+      CJobQueue::OnJobComplete(jobID, success, job);
+
+      // the next sheet is queued behind the other jobs now that this one is done
+      if (continuation != NULL)
+        AddJob(continuation);
+    }
+  };
+
+  CJobQueue& GetJobQueue()
+  {
+    static CTrickplayJobQueue s_queue;
+    return s_queue;
+  }
+
+  std::string GetSheetPath(const std::string &indexPath, unsigned int sheet)
+  {
+    return StringUtils::Format("%s-%u.jpg", URIUtils::ReplaceExtension(indexPath, "").c_str(), sheet);
+  }
+}
+
+CTrickplayIndexJob::CTrickplayIndexJob(const std::string &path, int idFile, unsigned int interval, unsigned int sheet)
+  : m_path(path),
+    m_idFile(idFile),
+    m_interval(interval),
+    m_sheet(sheet),
+    m_nextSheet(0)
+{ }
+
+bool CTrickplayIndexJob::operator==(const CJob* job) const
+{
+  if (strcmp(job->GetType(), GetType()) != 0)
+    return false;
+
+  const CTrickplayIndexJob* indexJob = dynamic_cast<const CTrickplayIndexJob*>(job);
+  return indexJob != NULL && indexJob->m_path == m_path;
+}
+
+bool CTrickplayIndexJob::Queue(const CFileItem &item, CVideoDatabase &db)
+{
+  if (g_advancedSettings.m_videoTrickplayInterval <= 0)
+    return false;
+
+  if (item.m_bIsFolder || !item.IsVideo()
+  ||  item.IsLiveTV()
+  ||  item.IsInternetStream()
+  ||  item.IsPlayList()
+  ||  item.IsDiscStub()
+  ||  item.IsDiscImage()
+  ||  item.IsDVD()
+  ||  item.IsBDFile()
+  ||  item.IsDVDFile(false, true)
+  ||  URIUtils::IsUPnP(item.GetPath())
+  ||  URIUtils::IsBluray(item.GetPath()))
+    return false;
+
+  // only files in the library get an index, their ids don't change while files are merely browsed
+  int idFile = db.GetFileId(item);
+  if (idFile < 0)
+    return false;
+
+  std::string path = item.GetPath();
+  if (item.IsVideoDb() && item.HasVideoInfoTag())
+    path = item.GetVideoInfoTag()->m_strFileNameAndPath;
+  if (URIUtils::IsStack(path))
+    path = XFILE::CStackDirectory::GetFirstStackedFile(path);
+
+  // an empty index means the file was tried before, the index itself may have been cleaned up though
+  std::string index;
+  if (db.GetTrickplayIndex(idFile, index) && (index.empty() || XFILE::CFile::Exists(index)))
+    return false;
+
+  return GetJobQueue().AddJob(new CTrickplayIndexJob(path, idFile, g_advancedSettings.m_videoTrickplayInterval, 0));
+}
+
+std::string CTrickplayIndexJob::GetIndexPath(const std::string &path)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(path);
+  return StringUtils::Format(TRICKPLAY_DIRECTORY "%08x.json", (unsigned int)crc);
+}
+
+void CTrickplayIndexJob::DeleteIndex(const std::string &indexPath)
+{
+  // the sheets of a complete index are numbered without gaps
+  unsigned int sheet = 0;
+  while (XFILE::CFile::Delete(GetSheetPath(indexPath, sheet)))
+    sheet++;
+  XFILE::CFile::Delete(indexPath);
+}
+
+unsigned int CTrickplayIndexJob::GetPreviewInterval(unsigned int interval, unsigned int length)
+{
+  return std::max(interval * 1000, length / TRICKPLAY_MAX_PREVIEWS + 1);
+}
+
+bool CTrickplayIndexJob::DoWork()
+{
+  std::string redactedPath = CURL::GetRedacted(m_path);
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
+  CDVDThumbnailExtractor extractor(TRICKPLAY_TILE_WIDTH);
+  if (!extractor.Open(m_path))
+    return false;
+
+  int length = extractor.GetStreamLength();
+  if (!extractor.HasVideo() || length <= 0)
+  {
+    CLog::Log(LOGDEBUG, "%s - no video to generate a trickplay index for in %s", __FUNCTION__, redactedPath.c_str());
+    SetIndex("");
+    return false;
+  }
+
+  unsigned int interval = GetPreviewInterval(m_interval, static_cast<unsigned int>(length));
+  unsigned int count = static_cast<unsigned int>(length) / interval + 1;
+  const unsigned int perSheet = TRICKPLAY_COLUMNS * TRICKPLAY_ROWS;
+  unsigned int sheets = (count + perSheet - 1) / perSheet;
+
+  const std::string indexPath = GetIndexPath(m_path);
+  if (!XFILE::CDirectory::Exists(TRICKPLAY_DIRECTORY))
+    XFILE::CDirectory::Create(TRICKPLAY_DIRECTORY);
+
+  std::vector<uint8_t> pixels;
+  unsigned int tileHeight = 0;
+  int orientation;
+  for (unsigned int sheet = m_sheet; sheet < sheets; sheet++)
+  {
+    // the sheet may be left over from an earlier, interrupted run
+    const std::string sheetPath = GetSheetPath(indexPath, sheet);
+    if (XFILE::CFile::Exists(sheetPath))
+      continue;
+
+    unsigned int first = sheet * perSheet;
+    unsigned int tiles = std::min(perSheet, count - first);
+    unsigned int rows = (tiles + TRICKPLAY_COLUMNS - 1) / TRICKPLAY_COLUMNS;
+    const unsigned int sheetWidth = TRICKPLAY_COLUMNS * TRICKPLAY_TILE_WIDTH;
+    std::vector<uint8_t> sheetPixels;
+
+    for (unsigned int i = 0; i < tiles; i++)
+    {
+      if (ShouldStop() || ShouldCancel(first + i, count))
+        return false;
+
+      unsigned int height;
+      if (!extractor.Extract((first + i) * interval, pixels, height, orientation))
+      {
+        // keep the tile black, the positions of the other previews are fixed
+        if (first + i == 0)
+        {
+          CLog::Log(LOGDEBUG, "%s - failed to decode the first preview of %s", __FUNCTION__, redactedPath.c_str());
+          SetIndex("");
+          return false;
+        }
+        continue;
+      }
+
+      if (tileHeight == 0)
+        tileHeight = height;
+      if (sheetPixels.empty())
+        sheetPixels.resize(sheetWidth * tileHeight * rows * 4);
+
+      // copy the preview into its tile
+      unsigned int x = (i % TRICKPLAY_COLUMNS) * TRICKPLAY_TILE_WIDTH;
+      unsigned int y = (i / TRICKPLAY_COLUMNS) * tileHeight;
+      for (unsigned int line = 0; line < std::min(height, tileHeight); line++)
+        memcpy(&sheetPixels[((y + line) * sheetWidth + x) * 4], &pixels[line * TRICKPLAY_TILE_WIDTH * 4], TRICKPLAY_TILE_WIDTH * 4);
+
+      Sleep(TRICKPLAY_THROTTLE_MS);
+    }
+
+    if (sheetPixels.empty() || !WriteSheet(sheetPixels, sheetWidth, tileHeight * rows, sheetPath))
+      return false;
+
+    // give other pausable jobs (like thumb extraction) a chance before continuing with the next sheet
+    if (sheet + 1 < sheets)
+    {
+      m_nextSheet = sheet + 1;
+      return true;
+    }
+  }
+
+  // all sheets were generated by earlier jobs, we still need the size of the tiles
+  if (tileHeight == 0 && !extractor.Extract(0, pixels, tileHeight, orientation))
+    return false;
+
+  CVariant index(CVariant::VariantTypeObject);
+  index["version"] = TRICKPLAY_VERSION;
+  index["interval"] = interval;
+  index["count"] = count;
+  index["tilewidth"] = TRICKPLAY_TILE_WIDTH;
+  index["tileheight"] = tileHeight;
+  index["columns"] = TRICKPLAY_COLUMNS;
+  index["rows"] = TRICKPLAY_ROWS;
+  index["sheets"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int sheet = 0; sheet < sheets; sheet++)
+    index["sheets"].push_back(GetSheetPath(indexPath, sheet));
+
+  if (!WriteIndex(index, indexPath))
+    return false;
+
+  SetIndex(indexPath);
+
+  CLog::Log(LOGDEBUG, "%s - generated trickplay index with %u previews for %s (last part took %u ms)",
+            __FUNCTION__, count, redactedPath.c_str(), XbmcThreads::SystemClockMillis() - start);
+  return true;
+}
+
+CJob* CTrickplayIndexJob::GetContinuation() const
+{
+  if (m_nextSheet == 0)
+    return NULL;
+
+  return new CTrickplayIndexJob(m_path, m_idFile, m_interval, m_nextSheet);
+}
+
+bool CTrickplayIndexJob::ShouldStop() const
+{
+  // never compete with playback, the index is simply continued the next time the item is seen
+  return g_application.m_bStop || CJobManager::GetInstance().IsPaused();
+}
+
+void CTrickplayIndexJob::SetIndex(const std::string &indexPath) const
+{
+  CVideoDatabase db;
+  if (db.Open())
+  {
+    db.SetTrickplayIndex(m_idFile, indexPath);
+    db.Close();
+  }
+}
+
+bool CTrickplayIndexJob::WriteSheet(const std::vector<uint8_t> &pixels, unsigned int width, unsigned int height, const std::string &path) const
+{
+  // write to a temporary file first so an interrupted job doesn't leave a partial sheet behind
+  const std::string tempPath = path + ".tmp.jpg";
+  if (!CPicture::CreateThumbnailFromSurface(pixels.data(), width, height, width * 4, tempPath))
+    return false;
+
+  if (!XFILE::CFile::Rename(tempPath, path))
+  {
+    XFILE::CFile::Delete(tempPath);
+    return false;
+  }
+
+  return true;
+}
+
+bool CTrickplayIndexJob::WriteIndex(const CVariant &index, const std::string &path) const
+{
+  std::string data = CJSONVariantWriter::Write(index, false);
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+    return false;
+
+  bool success = file.Write(data.c_str(), data.size()) == static_cast<ssize_t>(data.size());
+  file.Close();
+
+  if (!success)
+    XFILE::CFile::Delete(path);
+
+  return success;
+}
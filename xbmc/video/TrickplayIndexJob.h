@@ -0,0 +1,117 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "utils/Job.h"
+
+class CFileItem;
+class CVariant;
+class CVideoDatabase;
+
+#define kJobTypeTrickplayIndex "trickplayindex"
+
+/*!
+ \brief Generates the trickplay index of a video file.
+
+ The index consists of sprite sheets holding a grid of small previews taken
+ every few seconds and a JSON file describing them:
+
+ \code
+ { "version": 1, "interval": <ms between previews>, "count": <number of previews>,
+   "tilewidth": <px>, "tileheight": <px>, "columns": <tiles per row>, "rows": <rows per sheet>,
+   "sheets": [ <paths of the sprite sheets> ] }
+ \endcode
+
+ Preview i is on sheet i / (columns * rows) and shows the video at i * interval.
+ Indexes are only generated for files in the video library. The index is stored
+ in the thumbnail folder and its location in the video database. Files without
+ an index (e.g. because they have no video stream) are remembered as well, so
+ they aren't tried again.
+
+ Each job generates one sheet and queues the job for the next one, so other
+ pausable jobs aren't held up for long. Jobs give up as soon as pausable jobs
+ are paused (i.e. during playback), sheets that were already written are reused
+ when the index is queued again.
+ */
+class CTrickplayIndexJob : public CJob
+{
+public:
+  /*!
+   \param path the video file
+   \param idFile the id of the video file in the video database
+   \param interval the time between two previews in seconds
+   \param sheet the first sheet to generate
+   */
+  CTrickplayIndexJob(const std::string &path, int idFile, unsigned int interval, unsigned int sheet);
+  virtual ~CTrickplayIndexJob() { }
+
+  virtual const char* GetType() const { return kJobTypeTrickplayIndex; }
+  virtual bool operator==(const CJob* job) const;
+  virtual bool DoWork();
+
+  /*!
+   \brief Queue the generation of the trickplay index of the given library item unless it already has one.
+   \param item the video item
+   \param db the open video database the item is looked up in
+   \return true if a job was queued, false otherwise.
+   */
+  static bool Queue(const CFileItem &item, CVideoDatabase &db);
+
+  /*!
+   \brief Retrieve the path of the trickplay index of the given video file.
+   */
+  static std::string GetIndexPath(const std::string &path);
+
+  /*!
+   \brief Delete a trickplay index and its sprite sheets, e.g. because its file was removed from the library.
+   \param indexPath the path of the index as stored in the video database
+   */
+  static void DeleteIndex(const std::string &indexPath);
+
+  /*!
+   \brief Retrieve the time between two previews, which grows for long videos to limit the number of previews.
+   \param interval the requested time between two previews in seconds
+   \param length the length of the video in ms
+   \return the time between two previews in ms
+   */
+  static unsigned int GetPreviewInterval(unsigned int interval, unsigned int length);
+
+  /*!
+   \brief Create the job generating the remaining sheets after this job has finished.
+   \return the new job or NULL if the index is complete.
+   */
+  CJob* GetContinuation() const;
+
+private:
+  bool ShouldStop() const;
+  void SetIndex(const std::string &indexPath) const;
+  bool WriteSheet(const std::vector<uint8_t> &pixels, unsigned int width, unsigned int height, const std::string &path) const;
+  bool WriteIndex(const CVariant &index, const std::string &path) const;
+
+  std::string m_path;
+  int m_idFile;
+  unsigned int m_interval;
+  unsigned int m_sheet;
+  unsigned int m_nextSheet;
+};
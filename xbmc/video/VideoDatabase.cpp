@@ -70,6 +70,7 @@
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include "utils/XMLUtils.h"
+#include "video/TrickplayIndexJob.h"
 #include "video/VideoDbUrl.h"
 #include "video/windows/GUIWindowVideoBase.h"
 #include "VideoInfoScanner.h"
@@ -138,9 +139,15 @@ void CVideoDatabase::CreateTables()
   CLog::Log(LOGINFO, "create path table");
   m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, noUpdate bool, exclude bool, dateAdded text, idParentPath integer)");
 
+  CLog::Log(LOGINFO, "create pathlisting table");
+  m_pDS->exec("CREATE TABLE pathlisting ( idPath integer primary key, modified integer, strHash text, strFolders text)");
+
   CLog::Log(LOGINFO, "create files table");
   m_pDS->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
 
+  CLog::Log(LOGINFO, "create trickplay table");
+  m_pDS->exec("CREATE TABLE trickplay ( idFile integer primary key, strIndex text)");
+
   CLog::Log(LOGINFO, "create tvshow table");
   columns = "CREATE TABLE tvshow ( idShow integer primary key";
 
@@ -335,6 +342,10 @@ void CVideoDatabase::CreateAnalytics()
               "DELETE FROM settings WHERE idFile=old.idFile; "
               "DELETE FROM stacktimes WHERE idFile=old.idFile; "
               "DELETE FROM streamdetails WHERE idFile=old.idFile; "
+              "DELETE FROM trickplay WHERE idFile=old.idFile; "
+              "END");
+  m_pDS->exec("CREATE TRIGGER delete_path AFTER DELETE ON path FOR EACH ROW BEGIN "
+              "DELETE FROM pathlisting WHERE idPath=old.idPath; "
               "END");
 
   CreateViews();
@@ -943,6 +954,109 @@ bool CVideoDatabase::SetPathHash(const std::string &path, const std::string &has
   return false;
 }
 
+bool CVideoDatabase::SetPathListingHash(const std::string &path, int64_t modified, const std::string &hash, const std::vector<std::string> &folders)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    int idPath = AddPath(path);
+    if (idPath < 0) return false;
+
+    // folders are separated by newlines which can't be part of a path
+    std::string strSQL = PrepareSQL("REPLACE INTO pathlisting (idPath, modified, strHash, strFolders) VALUES (%i, %s, '%s', '%s')",
+                                    idPath, StringUtils::Format("%" PRId64, modified).c_str(), hash.c_str(), StringUtils::Join(folders, "\n").c_str());
+    m_pDS->exec(strSQL);
+
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s, %s) failed", __FUNCTION__, path.c_str(), hash.c_str());
+  }
+
+  return false;
+}
+
+bool CVideoDatabase::GetPathListingHash(const std::string &path, int64_t modified, std::string &hash, std::vector<std::string> &folders)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    // without a modification time we can't tell whether the listing is still valid
+    if (modified == 0)
+      return false;
+
+    std::string strSQL = PrepareSQL("SELECT pathlisting.modified, pathlisting.strHash, pathlisting.strFolders FROM pathlisting "
+                                    "JOIN path ON path.idPath = pathlisting.idPath WHERE path.strPath='%s'", path.c_str());
+    m_pDS->query(strSQL);
+    if (m_pDS->num_rows() == 0 || m_pDS->fv(0).get_asInt64() != modified)
+    {
+      m_pDS->close();
+      return false;
+    }
+
+    hash = m_pDS->fv(1).get_asString();
+    folders.clear();
+    std::string strFolders = m_pDS->fv(2).get_asString();
+    if (!strFolders.empty())
+      folders = StringUtils::Split(strFolders, "\n");
+    m_pDS->close();
+
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+
+  return false;
+}
+
+bool CVideoDatabase::SetTrickplayIndex(int idFile, const std::string &index)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->exec(PrepareSQL("REPLACE INTO trickplay (idFile, strIndex) VALUES (%i, '%s')", idFile, index.c_str()));
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%i, %s) failed", __FUNCTION__, idFile, index.c_str());
+  }
+
+  return false;
+}
+
+bool CVideoDatabase::GetTrickplayIndex(int idFile, std::string &index)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->query(PrepareSQL("SELECT strIndex FROM trickplay WHERE idFile=%i", idFile));
+    bool found = m_pDS->num_rows() > 0;
+    if (found)
+      index = m_pDS->fv(0).get_asString();
+    m_pDS->close();
+
+    return found;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%i) failed", __FUNCTION__, idFile);
+  }
+
+  return false;
+}
+
 bool CVideoDatabase::LinkMovieToTvshow(int idMovie, int idShow, bool bRemove)
 {
    try
@@ -4874,11 +4988,17 @@ void CVideoDatabase::UpdateTables(int iVersion)
     m_pDS->exec("ALTER TABLE settings ADD VideoStream integer");
     m_pDS->exec("ALTER TABLE streamdetails ADD strVideoLanguage text");
   }
+
+  if (iVersion < 104)
+    m_pDS->exec("CREATE TABLE pathlisting ( idPath integer primary key, modified integer, strHash text, strFolders text)");
+
+  if (iVersion < 105)
+    m_pDS->exec("CREATE TABLE trickplay ( idFile integer primary key, strIndex text)");
 }
 
 int CVideoDatabase::GetSchemaVersion() const
 {
-  return 103;
+  return 105;
 }
 
 bool CVideoDatabase::LookupByFolders(const std::string &path, bool shows)
@@ -7535,44 +7655,6 @@ unsigned int CVideoDatabase::GetMusicVideoIDs(const std::string& strWhere, std::
   return 0;
 }
 
-bool CVideoDatabase::GetRandomMusicVideo(CFileItem* item, int& idSong, const std::string& strWhere)
-{
-  try
-  {
-    idSong = -1;
-
-    if (NULL == m_pDB.get()) return false;
-    if (NULL == m_pDS.get()) return false;
-
-    std::string strSQL = "select * from musicvideo_view";
-    if (!strWhere.empty())
-      strSQL += " where " + strWhere;
-    strSQL += PrepareSQL(" order by RANDOM() limit 1");
-    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL))
-      return false;
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound != 1)
-    {
-      m_pDS->close();
-      return false;
-    }
-    *item->GetVideoInfoTag() = GetDetailsForMusicVideo(m_pDS);
-    std::string path = StringUtils::Format("videodb://musicvideos/titles/%i",item->GetVideoInfoTag()->m_iDbId);
-    item->SetPath(path);
-    idSong = m_pDS->fv("idMVideo").get_asInt();
-    item->SetLabel(item->GetVideoInfoTag()->m_strTitle);
-    m_pDS->close();
-    return true;
-  }
-  catch(...)
-  {
-    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strWhere.c_str());
-  }
-  return false;
-}
-
 int CVideoDatabase::GetMatchingMusicVideo(const std::string& strArtist, const std::string& strAlbum, const std::string& strTitle)
 {
   try
@@ -8132,10 +8214,20 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const st
       progress->Progress();
     }
 
+    std::vector<std::string> trickplayIndexes;
     if (!filesToDelete.empty())
     {
       filesToDelete = "(" + StringUtils::TrimRight(filesToDelete, ",") + ")";
 
+      // the trigger only removes the trickplay rows, the indexes themselves are deleted once the cleanup is committed
+      m_pDS->query("SELECT strIndex FROM trickplay WHERE strIndex != '' AND idFile IN " + filesToDelete);
+      while (!m_pDS->eof())
+      {
+        trickplayIndexes.push_back(m_pDS->fv(0).get_asString());
+        m_pDS->next();
+      }
+      m_pDS->close();
+
       CLog::Log(LOGDEBUG, "%s: Cleaning files table", __FUNCTION__);
       sql = "DELETE FROM files WHERE idFile IN " + filesToDelete;
       m_pDS->exec(sql);
@@ -8268,6 +8360,9 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const st
 
     CommitTransaction();
 
+    for (std::vector<std::string>::const_iterator it = trickplayIndexes.begin(); it != trickplayIndexes.end(); ++it)
+      CTrickplayIndexJob::DeleteIndex(*it);
+
     if (handle)
       handle->SetTitle(g_localizeStrings.Get(331));
 
@@ -628,6 +628,38 @@ public:
   // scanning hashes and paths scanned
   bool SetPathHash(const std::string &path, const std::string &hash);
   bool GetPathHash(const std::string &path, std::string &hash);
+
+  /*! \brief Store the hash of a directory listing that was retrieved while scanning or browsing.
+   \param path the directory
+   \param modified the modification time of the directory when it was listed
+   \param hash the hash of the listing as computed by CVideoInfoScanner::GetPathHash()
+   \param folders the sub folders within the listing
+   \return true if the listing hash was stored, false otherwise.
+   */
+  bool SetPathListingHash(const std::string &path, int64_t modified, const std::string &hash, const std::vector<std::string> &folders);
+
+  /*! \brief Retrieve the hash of a directory listing if the directory hasn't been modified since.
+   \param path the directory
+   \param modified the current modification time of the directory
+   \param hash [out] the hash of the listing
+   \param folders [out] the sub folders within the listing
+   \return true if a listing hash for the given modification time was found, false otherwise.
+   */
+  bool GetPathListingHash(const std::string &path, int64_t modified, std::string &hash, std::vector<std::string> &folders);
+
+  /*! \brief Store the location of the trickplay index of a video file.
+   \param idFile the id of the video file
+   \param index the path of the trickplay index, empty if no index can be generated for the file
+   \return true if the location was stored, false otherwise.
+   */
+  bool SetTrickplayIndex(int idFile, const std::string &index);
+
+  /*! \brief Retrieve the location of the trickplay index of a video file.
+   \param idFile the id of the video file
+   \param index [out] the path of the trickplay index, empty if no index can be generated for the file
+   \return true if the file was processed before, false otherwise.
+   */
+  bool GetTrickplayIndex(int idFile, std::string &index);
   bool GetPaths(std::set<std::string> &paths);
   bool GetPathsForTvShow(int idShow, std::set<int>& paths);
 
@@ -730,6 +762,19 @@ public:
    */
   int AddFile(const CFileItem& item);
 
+  /*! \brief Get the id of this fileitem
+   Works for both videodb:// items and normal fileitems
+   \param item CFileItem to grab the fileid of
+   \return id of the file, -1 if it is not in the db.
+   */
+  int GetFileId(const CFileItem &item);
+
+  /*! \brief Get the id of a file from path
+   \param url full path to the file
+   \return id of the file, -1 if it is not in the db.
+   */
+  int GetFileId(const std::string& url);
+
   /*! \brief Add a path to the database, if necessary
    If the path is already in the database, we simply return its id.
    \param strPath the path to add
@@ -771,7 +816,6 @@ public:
 
   // partymode
   unsigned int GetMusicVideoIDs(const std::string& strWhere, std::vector<std::pair<int, int> > &songIDs);
-  bool GetRandomMusicVideo(CFileItem* item, int& idSong, const std::string& strWhere);
 
   static void VideoContentTypeToString(VIDEODB_CONTENT_TYPE type, std::string& out)
   {
@@ -826,19 +870,6 @@ protected:
   int GetMovieId(const std::string& strFilenameAndPath);
   int GetMusicVideoId(const std::string& strFilenameAndPath);
 
-  /*! \brief Get the id of this fileitem
-   Works for both videodb:// items and normal fileitems
-   \param item CFileItem to grab the fileid of
-   \return id of the file, -1 if it is not in the db.
-   */
-  int GetFileId(const CFileItem &item);
-
-  /*! \brief Get the id of a file from path
-   \param url full path to the file
-   \return id of the file, -1 if it is not in the db.
-   */
-  int GetFileId(const std::string& url);
-
   int AddToTable(const std::string& table, const std::string& firstField, const std::string& secondField, const std::string& value);
   int UpdateRatings(int mediaId, const char *mediaType, const RatingMap& values, const std::string& defaultRating);
   int AddRatings(int mediaId, const char *mediaType, const RatingMap& values, const std::string& defaultRating);
@@ -29,6 +29,7 @@
 #include "events/MediaLibraryEvent.h"
 #include "FileItem.h"
 #include "filesystem/DirectoryCache.h"
+#include "filesystem/DirectoryWalker.h"
 #include "filesystem/File.h"
 #include "filesystem/MultiPathDirectory.h"
 #include "filesystem/StackDirectory.h"
@@ -47,6 +48,8 @@
 #include "URL.h"
 #include "Util.h"
 #include "utils/log.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
 #include "utils/md5.h"
 #include "utils/RegExp.h"
 #include "utils/StringUtils.h"
@@ -294,15 +297,31 @@ namespace VIDEO
         hash = fastHash;
       }
       else
-      { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
-        items.Stack();
-
-        // check whether to re-use previously computed fast hash
-        if (!CanFastHash(items, regexps) || fastHash.empty())
-          GetPathHash(items, hash);
+      {
+        // stat before listing so changes made while listing invalidate the stored listing hash
+        int64_t modified = GetModificationTime(strDirectory);
+        std::vector<std::string> folders;
+        if (g_advancedSettings.m_bVideoLibraryUseFastHash && !dbHash.empty() &&
+            m_database.GetPathListingHash(strDirectory, modified, hash, folders) && hash == dbHash)
+        { // listing is unchanged since it was last hashed - only the subfolders need to be visited
+          for (std::vector<std::string>::const_iterator folder = folders.begin(); folder != folders.end(); ++folder)
+            items.Add(CFileItemPtr(new CFileItem(*folder, true)));
+        }
         else
-          hash = fastHash;
+        { // need to fetch the folder
+          hash.clear();
+          CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+          items.Stack();
+
+          // check whether to re-use previously computed fast hash
+          if (!CanFastHash(items, regexps) || fastHash.empty())
+          {
+            GetPathHash(items, hash);
+            SetPathListingHash(m_database, strDirectory, modified, items, hash);
+          }
+          else
+            hash = fastHash;
+        }
       }
 
       if (hash == dbHash)
@@ -1802,6 +1821,89 @@ namespace VIDEO
     return count;
   }
 
+  void CVideoInfoScanner::SetPathListingHash(CVideoDatabase &database, const std::string &directory, int64_t modified,
+      const CFileItemList &items, const std::string &hash)
+  {
+    if (!modified || hash.empty())
+      return;
+
+    std::vector<std::string> folders;
+    for (int i = 0; i < items.Size(); ++i)
+    {
+      const CFileItemPtr pItem = items[i];
+      if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
+        folders.push_back(pItem->GetPath());
+    }
+    database.SetPathListingHash(directory, modified, hash, folders);
+  }
+
+  class CPathListingHashJob : public CJob
+  {
+  public:
+    CPathListingHashJob(const CFileItemList &items, time_t listed)
+      : m_listed(listed)
+    {
+      m_items.Copy(items);
+    }
+
+    virtual const char *GetType() const { return "pathlistinghash"; }
+
+    virtual bool DoWork()
+    {
+      const std::string directory = m_items.GetPath();
+
+      // only directories the scanner has hashed before are of interest
+      CVideoDatabase database;
+      std::string dbHash;
+      if (!database.Open() || !database.GetPathHash(directory, dbHash) || dbHash.empty())
+        return false;
+
+      // hash the listing the same way the scanner does
+      for (int i = 0; i < m_items.Size(); )
+      {
+        if (m_items[i]->IsParentFolder())
+          m_items.Remove(i);
+        else
+          i++;
+      }
+      m_items.Stack();
+
+      std::string hash;
+      CVideoInfoScanner::GetPathHash(m_items, hash);
+
+      // the listing is only valid for the directory's current state if it wasn't
+      // modified while being listed (allowing for 2 second timestamp resolution)
+      int64_t modified = CVideoInfoScanner::GetModificationTime(directory);
+      if (modified && modified + 2 < m_listed)
+        CVideoInfoScanner::SetPathListingHash(database, directory, modified, m_items, hash);
+      return true;
+    }
+
+  private:
+    CFileItemList m_items;
+    time_t m_listed;
+  };
+
+  void CVideoInfoScanner::QueuePathListingHash(const CFileItemList &items, time_t listed)
+  {
+    // stored listings are only trusted if the mtime based fast hashing is enabled
+    if (!g_advancedSettings.m_bVideoLibraryUseFastHash)
+      return;
+
+    if (items.IsEmpty() || items.IsVideoDb() || items.IsPlugin() || items.IsInternetStream())
+      return;
+
+    CJobManager::GetInstance().AddJob(new CPathListingHashJob(items, listed), NULL, CJob::PRIORITY_LOW_PAUSABLE);
+  }
+
+  int64_t CVideoInfoScanner::GetModificationTime(const std::string &directory)
+  {
+    struct __stat64 buffer;
+    if (XFILE::CFile::Stat(directory, &buffer) == 0)
+      return buffer.st_mtime ? buffer.st_mtime : buffer.st_ctime;
+    return 0;
+  }
+
   bool CVideoInfoScanner::CanFastHash(const CFileItemList &items, const std::vector<std::string> &excludes) const
   {
     if (!g_advancedSettings.m_bVideoLibraryUseFastHash)
@@ -1823,17 +1925,11 @@ namespace VIDEO
     if (excludes.size())
       md5state.append(StringUtils::Join(excludes, "|"));
 
-    struct __stat64 buffer;
-    if (XFILE::CFile::Stat(directory, &buffer) == 0)
+    int64_t time = GetModificationTime(directory);
+    if (time)
     {
-      int64_t time = buffer.st_mtime;
-      if (!time)
-        time = buffer.st_ctime;
-      if (time)
-      {
-        md5state.append((unsigned char *)&time, sizeof(time));
-        return md5state.getDigest();
-      }
+      md5state.append((unsigned char *)&time, sizeof(time));
+      return md5state.getDigest();
     }
     return "";
   }
@@ -1841,38 +1937,40 @@ namespace VIDEO
   std::string CVideoInfoScanner::GetRecursiveFastHash(const std::string &directory,
       const std::vector<std::string> &excludes) const
   {
-    CFileItemList items;
-    items.Add(CFileItemPtr(new CFileItem(directory, true)));
-    CUtil::GetRecursiveDirsListing(directory, items, DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_NO_FILE_INFO);
-
     XBMC::XBMC_MD5 md5state;
 
     if (excludes.size())
       md5state.append(StringUtils::Join(excludes, "|"));
 
-    int64_t time = 0;
-    for (int i=0; i < items.Size(); ++i)
+    // stat the subfolders of each listing while the folders below them are still being listed
+    CDirectoryWalker walker("", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_NO_FILE_INFO);
+    walker.Start(directory);
+
+    // TODO: some filesystems may return the mtime/ctime inline, in which case this is
+    // unnecessarily expensive. Consider supporting Stat() in our directory cache?
+    int64_t time = GetModificationTime(directory);
+    if (!time)
+      return "";
+
+    std::string listed;
+    CFileItemList items;
+    while (walker.GetNext(listed, items))
     {
-      int64_t stat_time = 0;
-      struct __stat64 buffer;
-      if (XFILE::CFile::Stat(items[i]->GetPath(), &buffer) == 0)
+      for (int i = 0; i < items.Size(); ++i)
       {
-        // TODO: some filesystems may return the mtime/ctime inline, in which case this is
-        // unnecessarily expensive. Consider supporting Stat() in our directory cache?
-        stat_time = buffer.st_mtime ? buffer.st_mtime : buffer.st_ctime;
+        if (!items[i]->m_bIsFolder || items[i]->IsPath(".."))
+          continue;
+
+        int64_t stat_time = GetModificationTime(items[i]->GetPath());
+        if (!stat_time)
+          return "";
         time += stat_time;
       }
-
-      if (!stat_time)
-        return "";
+      items.Clear();
     }
 
-    if (time)
-    {
-      md5state.append((unsigned char *)&time, sizeof(time));
-      return md5state.getDigest();
-    }
-    return "";
+    md5state.append((unsigned char *)&time, sizeof(time));
+    return md5state.getDigest();
   }
 
   void CVideoInfoScanner::GetSeasonThumbs(const CVideoInfoTag &show,
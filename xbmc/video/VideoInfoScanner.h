@@ -121,6 +121,36 @@ namespace VIDEO
 
     bool EnumerateEpisodeItem(const CFileItem *item, EPISODELIST& episodeList);
 
+    static int GetPathHash(const CFileItemList &items, std::string &hash);
+
+    /*! \brief Remember the hash of a directory listing for the directory's current modification time
+     Subsequent scans can then skip listing the directory for as long as its modification time
+     is unchanged, visiting only the remembered subfolders.
+     \param database an open video database
+     \param directory the directory that was listed
+     \param modified modification time of the directory, taken before it was listed
+     \param items the stacked directory listing
+     \param hash the hash of the listing as computed by GetPathHash()
+     \sa GetModificationTime
+     */
+    static void SetPathListingHash(CVideoDatabase &database, const std::string &directory, int64_t modified,
+                                   const CFileItemList &items, const std::string &hash);
+
+    /*! \brief Retrieve the modification time of a directory, falling back to its create time
+     \param directory the directory to stat()
+     \return the modification time, or 0 if neither time is available
+     */
+    static int64_t GetModificationTime(const std::string &directory);
+
+    /*! \brief Remember the hash of a listing that was fetched while browsing the library sources
+     The hash is computed and stored in the background, so that the next scan of an unchanged
+     directory doesn't need to list it again. Directories that are not part of a source with
+     content set are ignored.
+     \param items the unstacked directory listing
+     \param listed the time just before the directory was listed
+     */
+    static void QueuePathListingHash(const CFileItemList &items, time_t listed);
+
   protected:
     virtual void Process();
     bool DoScan(const std::string& strDirectory) override;
@@ -180,7 +210,6 @@ namespace VIDEO
      */
     void FetchActorThumbs(std::vector<SActorInfo>& actors, const std::string& strPath);
 
-    static int GetPathHash(const CFileItemList &items, std::string &hash);
 
     /*! \brief Retrieve a "fast" hash of the given directory (if available)
      Performs a stat() on the directory, and uses modified time to create a "fast"
@@ -40,6 +40,7 @@
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
+#include "video/TrickplayIndexJob.h"
 #include "video/VideoDatabase.h"
 #include "video/VideoInfoTag.h"
 
@@ -378,6 +379,9 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
     if (StringUtils::StartsWith(url, "image://video@") && !CTextureCache::GetInstance().HasCachedImage(url))
       pItem->SetArt("thumb", "");
 
+    // seek previews are generated in the background (if enabled)
+    CTrickplayIndexJob::Queue(*pItem, *m_videoDatabase);
+
     if (!pItem->HasArt("thumb"))
     {
       // create unique thumb for auto generated thumbs
@@ -0,0 +1,112 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/TrickplayIndexJob.h"
+#include "FileItem.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "video/VideoDatabase.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestTrickplayIndexJob, SameFileIsSameJob)
+{
+  CTrickplayIndexJob job("/movies/foo.mkv", 1, 10, 0);
+  CTrickplayIndexJob continuation("/movies/foo.mkv", 1, 10, 3);
+  CTrickplayIndexJob other("/movies/bar.mkv", 2, 10, 0);
+
+  EXPECT_TRUE(job == &continuation);
+  EXPECT_FALSE(job == &other);
+}
+
+TEST(TestTrickplayIndexJob, IndexPath)
+{
+  std::string path = CTrickplayIndexJob::GetIndexPath("/movies/foo.mkv");
+  EXPECT_TRUE(StringUtils::StartsWith(path, "special://thumbnails/trickplay/"));
+  EXPECT_TRUE(StringUtils::EndsWith(path, ".json"));
+
+  EXPECT_EQ(path, CTrickplayIndexJob::GetIndexPath("/movies/FOO.mkv"));
+  EXPECT_NE(path, CTrickplayIndexJob::GetIndexPath("/movies/bar.mkv"));
+}
+
+TEST(TestTrickplayIndexJob, PreviewInterval)
+{
+  // two hours at the requested interval
+  EXPECT_EQ(10000U, CTrickplayIndexJob::GetPreviewInterval(10, 2 * 3600 * 1000));
+
+  // ten hours would need too many previews
+  unsigned int length = 10 * 3600 * 1000;
+  unsigned int interval = CTrickplayIndexJob::GetPreviewInterval(10, length);
+  EXPECT_GT(interval, 10000U);
+  EXPECT_LE(length / interval + 1, 2000U);
+}
+
+TEST(TestTrickplayIndexJob, NoContinuationBeforeWork)
+{
+  CTrickplayIndexJob job("/movies/foo.mkv", 1, 10, 0);
+  EXPECT_EQ(NULL, job.GetContinuation());
+}
+
+TEST(TestTrickplayIndexJob, QueueDisabled)
+{
+  int interval = g_advancedSettings.m_videoTrickplayInterval;
+  g_advancedSettings.m_videoTrickplayInterval = 0;
+
+  CFileItem item("/movies/foo.mkv", false);
+  CVideoDatabase db;
+  EXPECT_FALSE(CTrickplayIndexJob::Queue(item, db));
+
+  g_advancedSettings.m_videoTrickplayInterval = interval;
+}
+
+TEST(TestTrickplayIndexJob, QueueSkipsFolders)
+{
+  int interval = g_advancedSettings.m_videoTrickplayInterval;
+  g_advancedSettings.m_videoTrickplayInterval = 10;
+
+  CFileItem item("/movies/", true);
+  CVideoDatabase db;
+  EXPECT_FALSE(CTrickplayIndexJob::Queue(item, db));
+
+  g_advancedSettings.m_videoTrickplayInterval = interval;
+}
+
+TEST(TestTrickplayIndexJob, DeleteIndex)
+{
+  std::string temp = CSpecialProtocol::TranslatePath("special://temp/");
+  std::string index = URIUtils::AddFileToFolder(temp, "TestTrickplayIndexJob.json");
+  std::vector<std::string> files;
+  files.push_back(index);
+  files.push_back(URIUtils::AddFileToFolder(temp, "TestTrickplayIndexJob-0.jpg"));
+  files.push_back(URIUtils::AddFileToFolder(temp, "TestTrickplayIndexJob-1.jpg"));
+  for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+  {
+    XFILE::CFile file;
+    ASSERT_TRUE(file.OpenForWrite(*it, true));
+    file.Close();
+  }
+
+  CTrickplayIndexJob::DeleteIndex(index);
+  for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+    EXPECT_FALSE(XFILE::CFile::Exists(*it));
+}
@@ -42,6 +42,7 @@
 #include "dialogs/GUIDialogSelect.h"
 #include "guilib/GUIKeyboardFactory.h"
 #include "filesystem/Directory.h"
+#include "filesystem/DirectoryCache.h"
 #include "playlists/PlayList.h"
 #include "profiles/ProfilesManager.h"
 #include "settings/Settings.h"
@@ -1340,8 +1341,18 @@ bool CGUIWindowVideoBase::Update(const std::string &strDirectory, bool updateFil
 
 bool CGUIWindowVideoBase::GetDirectory(const std::string &strDirectory, CFileItemList &items)
 {
+  // a fresh listing of a source folder lets the scanner skip listing it again,
+  // but a cached one may predate changes to the folder
+  time_t listed = time(NULL);
+  bool freshListing = !strDirectory.empty() &&
+                      !g_directoryCache.HasDirectory(strDirectory) &&
+                      !CFileItemList(strDirectory).HasDiscCache(GetID());
+
   bool bResult = CGUIMediaWindow::GetDirectory(strDirectory, items);
 
+  if (bResult && freshListing && !items.IsVirtualDirectoryRoot())
+    CVideoInfoScanner::QueuePathListingHash(items, listed);
+
   // add in the "New Playlist" item if we're in the playlists folder
   if ((items.GetPath() == "special://videoplaylists/") && !items.Contains("newplaylist://"))
   {